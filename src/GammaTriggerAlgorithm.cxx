@@ -17,15 +17,17 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
  ********************************************************************************/
 #include <algorithm>
+#include <cfloat>
 #include "GammaTriggerAlgorithm.h"
 #include "TriggerChannelMap.h"
+#include "TriggerPatchMask.h"
 #include "TriggerSetup.h"
 
 /**
  * Constructor
  */
 GammaTriggerAlgorithm::GammaTriggerAlgorithm() :
-TriggerAlgorithm()
+TriggerAlgorithm(2, 1)
 {
 }
 
@@ -74,3 +76,87 @@ std::vector<RawPatch> GammaTriggerAlgorithm::FindPatches(const TriggerChannelMap
 	std::sort(rawpatches.begin(), rawpatches.end());
 	return rawpatches;
 }
+
+/**
+ * Gamma trigger algorithm, producing patches in the compact representation.
+ * Same algorithm as FindPatches, however the output container is reused and
+ * thresholds and trigger bits are evaluated once before the loop. For non-negative
+ * thresholds only windows overlapping occupied subregions of the channel map are
+ * visited, with identical results.
+ * @param channels Input channel map
+ * @param patches Output container, cleared before filling
+ * @param ptype Type assigned to the patches (EMCAL or DCAL-PHOS)
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void GammaTriggerAlgorithm::FindPatches(const TriggerChannelMap *channels, std::vector<PackedRawPatch> &patches, RawPatch::Patchtype ptype, const TriggerPatchMask *mask) const {
+	patches.clear();
+	const bool isDCALPHOS = ptype == RawPatch::kDCALPHOSpatch;
+	const TriggerThresholdTable &thresholds = fTriggerSetup->GetThresholdTable(isDCALPHOS ? RawPatch::kDCALpatchGA : RawPatch::kEMCALpatchGA);
+	// Windows only covering untouched channels have amplitude 0 and can only fire negative thresholds
+	const bool sparse = thresholds.GetMinThreshold() >= 0;
+
+	double adcsum(0);
+	for(unsigned char irow = 0; irow < channels->GetNumberOfRows() - 1; ++irow){
+		unsigned long long occupancy = sparse ? channels->GetOccupancyMask(irow, irow + 1) : ~0ULL;
+		if(!occupancy) continue;
+		for(unsigned char icol = 0; icol < channels->GetNumberOfCols() - 1; ++icol){
+			if(!TriggerChannelMap::IsOccupied(occupancy, icol, icol + 1)) continue;
+			if(mask && !mask->IsAccepted(icol, irow)) continue;
+			// 2x2 window
+			adcsum = 0;
+			for(unsigned char jrow = 0; jrow < 2; jrow++)
+				for(unsigned char jcol = 0; jcol < 2; jcol++)
+					adcsum += channels->GetADC(icol + jcol, irow + jrow);
+
+			// make decision for all thresholds of the category
+			int triggerBits = thresholds.GetTriggerBits(adcsum);
+			if(triggerBits) patches.push_back(PackedRawPatch(icol, irow, adcsum, triggerBits, 2, ptype));
+		}
+	}
+
+	// sort patches so that the main patch appears last
+	std::sort(patches.begin(), patches.end());
+}
+
+/**
+ * Gamma trigger algorithm on the detector of the algorithm, used by the TriggerMaker.
+ * @param channels Input channel map
+ * @param subregions Not used
+ * @param patches Output container, cleared before filling
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void GammaTriggerAlgorithm::FindPatches(const TriggerChannelMap *channels, const TriggerSubregionMap *, std::vector<PackedRawPatch> &patches, const TriggerPatchMask *mask) const {
+	FindPatches(channels, patches, fDetector, mask);
+}
+
+/**
+ * Get the patch category of the gamma patches
+ * @return Gamma category of the detector of the algorithm
+ */
+int GammaTriggerAlgorithm::GetCategory() const {
+	return IsDCALPHOS() ? RawPatch::kDCALpatchGA : RawPatch::kEMCALpatchGA;
+}
+
+/**
+ * Find the highest 2x2 window amplitude in the channel map, independent of
+ * the trigger thresholds. Windows are built with the same loop boundaries
+ * and summation order as in FindPatches, so an event fires a threshold
+ * if and only if the returned amplitude is above it.
+ * @param channels Input channel map
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ * @return Max. 2x2 window amplitude (-DBL_MAX if the map has no accepted window)
+ */
+double GammaTriggerAlgorithm::FindMaxPatchADC(const TriggerChannelMap *channels, const TriggerPatchMask *mask) const {
+	double maxadc(-DBL_MAX), adcsum(0);
+	for(unsigned char irow = 0; irow < channels->GetNumberOfRows() - 1; ++irow){
+		for(unsigned char icol = 0; icol < channels->GetNumberOfCols() - 1; ++icol){
+			if(mask && !mask->IsAccepted(icol, irow)) continue;
+			adcsum = 0;
+			for(unsigned char jrow = 0; jrow < 2; jrow++)
+				for(unsigned char jcol = 0; jcol < 2; jcol++)
+					adcsum += channels->GetADC(icol + jcol, irow + jrow);
+			if(adcsum > maxadc) maxadc = adcsum;
+		}
+	}
+	return maxadc;
+}
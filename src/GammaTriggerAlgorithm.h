@@ -11,6 +11,8 @@
 
 class PatchContainer;
 class TriggerChannelMap;
+class TriggerPatchMask;
+class TriggerSubregionMap;
 
 /**
  * @class GammaTriggerAlgorithm
@@ -25,6 +27,10 @@ public:
 	virtual ~GammaTriggerAlgorithm();
 
 	std::vector<RawPatch> FindPatches(const TriggerChannelMap * channels) const;
+	void FindPatches(const TriggerChannelMap * channels, std::vector<PackedRawPatch> &patches, RawPatch::Patchtype ptype = RawPatch::kUndefPatch, const TriggerPatchMask *mask = NULL) const;
+	virtual void FindPatches(const TriggerChannelMap *channels, const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, const TriggerPatchMask *mask) const;
+	virtual int GetCategory() const;
+	double FindMaxPatchADC(const TriggerChannelMap * channels, const TriggerPatchMask *mask = NULL) const;
 
 };
 #endif /* GammaTriggerAlgorithm_H */
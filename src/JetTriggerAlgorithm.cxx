@@ -17,15 +17,19 @@
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
  ********************************************************************************/
 #include <algorithm>
+#include <cfloat>
 #include "TriggerChannelMap.h"
+#include "TriggerPatchMask.h"
+#include "TriggerSubregionMap.h"
 #include "JetTriggerAlgorithm.h"
 #include "TriggerSetup.h"
 
 /**
- * Constructor
+ * Constructor. Windows are placed on the 4x4 subregion grid.
+ * @param patchsize Size of the patches found via the category interface (16 or 8)
  */
-JetTriggerAlgorithm::JetTriggerAlgorithm():
-  TriggerAlgorithm()
+JetTriggerAlgorithm::JetTriggerAlgorithm(unsigned char patchsize):
+  TriggerAlgorithm(patchsize, TriggerSubregionMap::kSubregionSize)
 {
 }
 
@@ -105,3 +109,150 @@ std::vector<RawPatch> JetTriggerAlgorithm::FindPatches8x8(const TriggerChannelMa
 	std::sort(rawpatches.begin(), rawpatches.end());
 	return rawpatches;
 }
+
+/**
+ * Jet trigger algorithm (16x16 windows) on the subregion map, producing patches in the compact
+ * representation. Windows start at each subregion (step of 4 FastORs) like in FindPatches,
+ * and the window amplitude is the sum of the 4x4 subregions covered by the window. Thresholds
+ * and trigger bits are evaluated once before the loop, and the output container is reused.
+ *
+ * Note: the amplitudes are summed per subregion first, so they are identical to the ones from
+ * FindPatches for integer amplitudes and agree within rounding otherwise.
+ * @param subregions Subregion map filled from the input channel map
+ * @param patches Output container, cleared before filling
+ * @param ptype Type assigned to the patches (EMCAL or DCAL-PHOS)
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void JetTriggerAlgorithm::FindPatches(const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, RawPatch::Patchtype ptype, const TriggerPatchMask *mask) const {
+	FindSubregionPatches(subregions, 4, patches, ptype, mask);
+}
+
+/**
+ * Jet trigger algorithm (8x8 windows) on the subregion map, producing patches in the compact
+ * representation. Same window positions as FindPatches8x8, the window amplitude is the sum of
+ * the 2x2 subregions covered by the window.
+ * @param subregions Subregion map filled from the input channel map
+ * @param patches Output container, cleared before filling
+ * @param ptype Type assigned to the patches (EMCAL or DCAL-PHOS)
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void JetTriggerAlgorithm::FindPatches8x8(const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, RawPatch::Patchtype ptype, const TriggerPatchMask *mask) const {
+	FindSubregionPatches(subregions, 2, patches, ptype, mask);
+}
+
+/**
+ * Jet trigger algorithm with the patch size and the detector of the algorithm, used by the TriggerMaker.
+ * @param channels Not used, the windows are built from the subregions
+ * @param subregions Subregion map filled from the input channel map
+ * @param patches Output container, cleared before filling
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void JetTriggerAlgorithm::FindPatches(const TriggerChannelMap *, const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, const TriggerPatchMask *mask) const {
+	FindSubregionPatches(subregions, fPatchSize / TriggerSubregionMap::kSubregionSize, patches, fDetector, mask);
+}
+
+/**
+ * Get the patch category of the jet patches
+ * @return Jet category for the patch size and the detector of the algorithm (RawPatch::kUndefPatch for unsupported sizes)
+ */
+int JetTriggerAlgorithm::GetCategory() const {
+	switch(fPatchSize){
+	case 16: return IsDCALPHOS() ? RawPatch::kDCALpatchJE : RawPatch::kEMCALpatchJE;
+	case 8: return IsDCALPHOS() ? RawPatch::kDCALpatchJE8x8 : RawPatch::kEMCALpatchJE8x8;
+	};
+	return RawPatch::kUndefPatch;
+}
+
+/**
+ * Find jet patches as square windows of subregions
+ * @param subregions Subregion map filled from the input channel map
+ * @param size Window size in subregions
+ * @param patches Output container, cleared before filling
+ * @param ptype Type assigned to the patches (EMCAL or DCAL-PHOS)
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void JetTriggerAlgorithm::FindSubregionPatches(const TriggerSubregionMap *subregions, int size, std::vector<PackedRawPatch> &patches, RawPatch::Patchtype ptype, const TriggerPatchMask *mask) const {
+	patches.clear();
+	const bool isDCALPHOS = ptype == RawPatch::kDCALPHOSpatch;
+	const TriggerThresholdTable &thresholds = fTriggerSetup->GetThresholdTable(size == 2 ?
+			(isDCALPHOS ? RawPatch::kDCALpatchJE8x8 : RawPatch::kEMCALpatchJE8x8) :
+			(isDCALPHOS ? RawPatch::kDCALpatchJE : RawPatch::kEMCALpatchJE));
+	const int patchsize = size * TriggerSubregionMap::kSubregionSize;
+
+	double adcsum(0);
+	for(int srow = 0; srow < GetNumberOfSubregionWindows(subregions->GetNumberOfRows(), size); srow++){
+		for(int scol = 0; scol < GetNumberOfSubregionWindows(subregions->GetNumberOfCols(), size); scol++){
+			if(mask && !mask->IsAccepted(scol * TriggerSubregionMap::kSubregionSize, srow * TriggerSubregionMap::kSubregionSize)) continue;
+			adcsum = subregions->GetWindowADC(scol, srow, size);
+
+			// make decision for all thresholds of the category
+			int triggerBits = thresholds.GetTriggerBits(adcsum);
+			if(triggerBits)
+				patches.push_back(PackedRawPatch(scol * TriggerSubregionMap::kSubregionSize, srow * TriggerSubregionMap::kSubregionSize,
+						adcsum, triggerBits, patchsize, ptype));
+		}
+	}
+
+	// sort patches so that the main patch appears last
+	std::sort(patches.begin(), patches.end());
+}
+
+/**
+ * Get the number of window positions along one axis of the subregion map. Positions are
+ * the same as in FindPatches (16x16) and FindPatches8x8 (8x8, excluding the last window
+ * touching the border).
+ * @param nsubregions Number of subregions along the axis
+ * @param size Window size in subregions
+ * @return Number of window positions
+ */
+int JetTriggerAlgorithm::GetNumberOfSubregionWindows(int nsubregions, int size) {
+	// FindPatches8x8 requires one FastOR beyond the window, i.e. the window can't touch the border
+	int nwindows = size == 2 ? nsubregions - size : nsubregions - size + 1;
+	return nwindows > 0 ? nwindows : 0;
+}
+
+/**
+ * Find the highest 16x16 window amplitude in the channel map, independent of
+ * the trigger thresholds. Uses the same window positions and summation order
+ * as FindPatches.
+ * @param channels Input channel map
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ * @return Max. 16x16 window amplitude (-DBL_MAX if the map has no accepted window)
+ */
+double JetTriggerAlgorithm::FindMaxPatchADC(const TriggerChannelMap *channels, const TriggerPatchMask *mask) const {
+	double maxadc(-DBL_MAX), adcsum(0);
+	for(unsigned char irow = 0; irow < channels->GetNumberOfRows() - 15; irow+=4){
+		for(unsigned char icol = 0; icol < channels->GetNumberOfCols() - 15; icol+=4){
+			if(mask && !mask->IsAccepted(icol, irow)) continue;
+			adcsum = 0;
+			for(unsigned char jrow = 0; jrow < 16; jrow++)
+				for(unsigned char jcol = 0; jcol < 16; jcol++)
+					adcsum += channels->GetADC(icol + jcol, irow + jrow);
+			if(adcsum > maxadc) maxadc = adcsum;
+		}
+	}
+	return maxadc;
+}
+
+/**
+ * Find the highest 8x8 window amplitude in the channel map, independent of
+ * the trigger thresholds. Uses the same window positions and summation order
+ * as FindPatches8x8.
+ * @param channels Input channel map
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ * @return Max. 8x8 window amplitude (-DBL_MAX if the map has no accepted window)
+ */
+double JetTriggerAlgorithm::FindMaxPatchADC8x8(const TriggerChannelMap *channels, const TriggerPatchMask *mask) const {
+	double maxadc(-DBL_MAX), adcsum(0);
+	for(unsigned char irow = 0; irow < channels->GetNumberOfRows() - 8-1; irow+=4){
+		for(unsigned char icol = 0; icol < channels->GetNumberOfCols() - 8-1; icol+=4){
+			if(mask && !mask->IsAccepted(icol, irow)) continue;
+			adcsum = 0;
+			for(unsigned char jrow = 0; jrow < 8; jrow++)
+				for(unsigned char jcol = 0; jcol < 8; jcol++)
+					adcsum += channels->GetADC(icol + jcol, irow + jrow);
+			if(adcsum > maxadc) maxadc = adcsum;
+		}
+	}
+	return maxadc;
+}
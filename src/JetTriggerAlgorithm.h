@@ -10,14 +10,28 @@
 #include "TriggerAlgorithm.h"
 
 class PatchContainer;
+class TriggerPatchMask;
+class TriggerSubregionMap;
 
 class JetTriggerAlgorithm: public TriggerAlgorithm {
 public:
-	JetTriggerAlgorithm();
+	JetTriggerAlgorithm(unsigned char patchsize = 16);
 	virtual ~JetTriggerAlgorithm();
 
 	std::vector<RawPatch> FindPatches(const TriggerChannelMap * channels) const;
 	std::vector<RawPatch> FindPatches8x8(const TriggerChannelMap *channels) const;
+	void FindPatches(const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, RawPatch::Patchtype ptype = RawPatch::kUndefPatch, const TriggerPatchMask *mask = NULL) const;
+	void FindPatches8x8(const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, RawPatch::Patchtype ptype = RawPatch::kUndefPatch, const TriggerPatchMask *mask = NULL) const;
+	virtual void FindPatches(const TriggerChannelMap *channels, const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, const TriggerPatchMask *mask) const;
+	virtual int GetCategory() const;
+	virtual bool UsesSubregions() const { return true; }
+	double FindMaxPatchADC(const TriggerChannelMap *channels, const TriggerPatchMask *mask = NULL) const;
+	double FindMaxPatchADC8x8(const TriggerChannelMap *channels, const TriggerPatchMask *mask = NULL) const;
+
+	static int GetNumberOfSubregionWindows(int nsubregions, int size);
+
+private:
+	void FindSubregionPatches(const TriggerSubregionMap *subregions, int size, std::vector<PackedRawPatch> &patches, RawPatch::Patchtype ptype, const TriggerPatchMask *mask) const;
 
 };
 
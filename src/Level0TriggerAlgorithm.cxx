@@ -0,0 +1,143 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+#include <cfloat>
+#include "Level0TriggerAlgorithm.h"
+#include "TriggerChannelMap.h"
+#include "TriggerPatchMask.h"
+#include "TriggerRegionMap.h"
+#include "TriggerSetup.h"
+
+/**
+ * Constructor
+ */
+Level0TriggerAlgorithm::Level0TriggerAlgorithm() :
+TriggerAlgorithm(2, 1)
+{
+}
+
+/**
+ * Destructor
+ */
+Level0TriggerAlgorithm::~Level0TriggerAlgorithm() {
+}
+
+/**
+ * Level0 trigger algorithm
+ * 1. Loop over all rows (- patchsize) to get the starting position of the patch
+ * 2. Skip windows crossing a TRU boundary
+ * 3. Loop over ADC values in the 2x2 window
+ * 4. Sorting of the trigger patches so that the highest energetic patch (main patch is the last)
+ * @param channes Input channel map
+ * @return vector with trigger patches
+ */
+std::vector<RawPatch> Level0TriggerAlgorithm::FindPatches(const TriggerChannelMap *channels) const {
+	std::vector<RawPatch> rawpatches;
+
+	double adcsum(0);
+	for(unsigned char irow = 0; irow < channels->GetNumberOfRows() - 1; ++irow){
+		for(unsigned char icol = 0; icol < channels->GetNumberOfCols() - 1; ++icol){
+			if(!TriggerRegionMap::IsWindow2x2WithinTRU(icol, irow, channels->GetNumberOfRows())) continue;
+			// 2x2 window
+			adcsum = 0;
+			for(unsigned char jrow = 0; jrow < 2; jrow++)
+				for(unsigned char jcol = 0; jcol < 2; jcol++)
+					adcsum += channels->GetADC(icol + jcol, irow + jrow);
+
+			if(adcsum > fTriggerSetup->GetThresholdL0()){
+				RawPatch patch(icol, irow, adcsum, 1 << fTriggerSetup->GetTriggerBitConfiguration().GetLevel0Bit());
+				patch.SetPatchSize(2);
+				rawpatches.push_back(patch);
+			}
+		}
+	}
+
+	// sort patches so that the main patch appears last
+	std::sort(rawpatches.begin(), rawpatches.end());
+	return rawpatches;
+}
+
+/**
+ * Level0 trigger algorithm on the detector of the algorithm, producing patches in the
+ * compact representation, used by the TriggerMaker. Same windows as in FindPatches,
+ * evaluated for all thresholds of the Level0 category. For non-negative thresholds only
+ * windows overlapping occupied subregions of the channel map are visited.
+ * @param channels Input channel map
+ * @param subregions Not used
+ * @param patches Output container, cleared before filling
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void Level0TriggerAlgorithm::FindPatches(const TriggerChannelMap *channels, const TriggerSubregionMap *, std::vector<PackedRawPatch> &patches, const TriggerPatchMask *mask) const {
+	patches.clear();
+	const TriggerThresholdTable &thresholds = fTriggerSetup->GetThresholdTable(GetCategory());
+	const int nrows = channels->GetNumberOfRows();
+	const bool sparse = thresholds.GetMinThreshold() >= 0;
+
+	double adcsum(0);
+	for(unsigned char irow = 0; irow < channels->GetNumberOfRows() - 1; ++irow){
+		unsigned long long occupancy = sparse ? channels->GetOccupancyMask(irow, irow + 1) : ~0ULL;
+		if(!occupancy) continue;
+		for(unsigned char icol = 0; icol < channels->GetNumberOfCols() - 1; ++icol){
+			if(!TriggerChannelMap::IsOccupied(occupancy, icol, icol + 1)) continue;
+			if(!TriggerRegionMap::IsWindow2x2WithinTRU(icol, irow, nrows)) continue;
+			if(mask && !mask->IsAccepted(icol, irow)) continue;
+			adcsum = 0;
+			for(unsigned char jrow = 0; jrow < 2; jrow++)
+				for(unsigned char jcol = 0; jcol < 2; jcol++)
+					adcsum += channels->GetADC(icol + jcol, irow + jrow);
+
+			int triggerBits = thresholds.GetTriggerBits(adcsum);
+			if(triggerBits) patches.push_back(PackedRawPatch(icol, irow, adcsum, triggerBits, 2, fDetector));
+		}
+	}
+
+	// sort patches so that the main patch appears last
+	std::sort(patches.begin(), patches.end());
+}
+
+/**
+ * Get the patch category of the Level0 patches
+ * @return Level0 category of the detector of the algorithm
+ */
+int Level0TriggerAlgorithm::GetCategory() const {
+	return IsDCALPHOS() ? RawPatch::kDCALpatchL0 : RawPatch::kEMCALpatchL0;
+}
+
+/**
+ * Find the highest 2x2 window amplitude within a TRU, independent of the
+ * Level0 threshold.
+ * @param channels Input channel map
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ * @return Max. 2x2 window amplitude (-DBL_MAX if the map has no accepted window)
+ */
+double Level0TriggerAlgorithm::FindMaxPatchADC(const TriggerChannelMap *channels, const TriggerPatchMask *mask) const {
+	double maxadc(-DBL_MAX), adcsum(0);
+	for(unsigned char irow = 0; irow < channels->GetNumberOfRows() - 1; ++irow){
+		for(unsigned char icol = 0; icol < channels->GetNumberOfCols() - 1; ++icol){
+			if(!TriggerRegionMap::IsWindow2x2WithinTRU(icol, irow, channels->GetNumberOfRows())) continue;
+			if(mask && !mask->IsAccepted(icol, irow)) continue;
+			adcsum = 0;
+			for(unsigned char jrow = 0; jrow < 2; jrow++)
+				for(unsigned char jcol = 0; jcol < 2; jcol++)
+					adcsum += channels->GetADC(icol + jcol, irow + jrow);
+			if(adcsum > maxadc) maxadc = adcsum;
+		}
+	}
+	return maxadc;
+}
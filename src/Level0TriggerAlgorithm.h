@@ -0,0 +1,41 @@
+#ifndef LEVEL0TRIGGERALGORITHM_H
+#define LEVEL0TRIGGERALGORITHM_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include "TriggerAlgorithm.h"
+
+class TriggerChannelMap;
+class TriggerPatchMask;
+class TriggerSubregionMap;
+
+/**
+ * @class Level0TriggerAlgorithm
+ * @brief Implementation of the EMCAL Level0 trigger algorithm using ADC values
+ *
+ * The Level0 trigger is evaluated inside each trigger region unit (TRU) on 2x2
+ * FastOR sums, with the Level0 threshold of the trigger setup. In contrast to the
+ * Level1 gamma trigger, 2x2 windows are not allowed to cross TRU boundaries.
+ *
+ * The TRU layout is defined in TriggerRegionMap.
+ *
+ * In the TriggerMaker the Level0 decision is made in the same scan as the gamma
+ * trigger (see TriggerFusedScan).
+ */
+class Level0TriggerAlgorithm: public TriggerAlgorithm {
+public:
+	Level0TriggerAlgorithm();
+	virtual ~Level0TriggerAlgorithm();
+
+	std::vector<RawPatch> FindPatches(const TriggerChannelMap * channels) const;
+	virtual void FindPatches(const TriggerChannelMap *channels, const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, const TriggerPatchMask *mask) const;
+	virtual int GetCategory() const;
+	double FindMaxPatchADC(const TriggerChannelMap * channels, const TriggerPatchMask *mask = NULL) const;
+
+};
+
+#endif /* LEVEL0TRIGGERALGORITHM_H */
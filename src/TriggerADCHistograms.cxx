@@ -0,0 +1,219 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+
+#include "JetTriggerAlgorithm.h"
+#include "TriggerADCHistograms.h"
+#include "TriggerChannelMap.h"
+#include "TriggerMaker.h"
+
+/**
+ * Constructor, initializing empty histograms for EMCAL (48x64 channels) and DCAL-PHOS (48x40 channels)
+ * @param nbins Number of bins in the range
+ * @param min Lower limit of the range
+ * @param max Upper limit of the range
+ * @throw InvalidBinningException in case the number of bins is not positive or the range is empty
+ */
+TriggerADCHistograms::TriggerADCHistograms(int nbins, double min, double max):
+	fNBins(nbins),
+	fMin(min),
+	fMax(max),
+	fScale(nbins / (max - min)),
+	fKernels(&TriggerKernels::GetKernels(TriggerKernels::SelectISA())),
+	fSubregions(),
+	fValues(),
+	fBins(),
+	fNEvents(0)
+{
+	if(nbins <= 0 || !(max > min)) throw InvalidBinningException(nbins, min, max);
+	const int ncols = 48, nrows[2] = {64, 40};
+	for(int idet = 0; idet < 2; idet++){
+		const int nscols = ncols / TriggerSubregionMap::kSubregionSize, nsrows = nrows[idet] / TriggerSubregionMap::kSubregionSize;
+		fGrids[kChannels][idet].Init(ncols, nrows[idet], nbins);
+		fGrids[kWindows2x2][idet].Init(ncols - 1, nrows[idet] - 1, nbins);
+		fGrids[kSubregions][idet].Init(nscols, nsrows, nbins);
+		fGrids[kWindows8x8][idet].Init(JetTriggerAlgorithm::GetNumberOfSubregionWindows(nscols, 2), JetTriggerAlgorithm::GetNumberOfSubregionWindows(nsrows, 2), nbins);
+		fGrids[kWindows16x16][idet].Init(JetTriggerAlgorithm::GetNumberOfSubregionWindows(nscols, 4), JetTriggerAlgorithm::GetNumberOfSubregionWindows(nsrows, 4), nbins);
+		fSubregions.push_back(TriggerSubregionMap(ncols, nrows[idet]));
+		fRows[idet].resize(ncols);
+	}
+	fValues.resize(ncols);
+	fBins.resize(ncols);
+}
+
+/**
+ * Add the amplitudes of an event
+ * @param emcal EMCAL channel map of the event
+ * @param dcalphos DCAL-PHOS channel map of the event
+ * @throw GridSizeMismatchException in case a channel map has not the size of the detector
+ */
+void TriggerADCHistograms::AddEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos) {
+	CheckDimensions(emcal, 0);
+	CheckDimensions(dcalphos, 1);
+	AddDetector(emcal, 0);
+	AddDetector(dcalphos, 1);
+	fNEvents++;
+}
+
+/**
+ * Add the amplitudes of the event currently stored in the channel maps of the trigger maker
+ * @param maker Trigger maker with filled channel maps
+ */
+void TriggerADCHistograms::AddEvent(const TriggerMaker &maker) {
+	AddEvent(maker.GetEMCALChannels(), maker.GetDCALPHOSChannels());
+}
+
+/**
+ * Add the counts of histograms filled in parallel
+ * @param other Histograms with the same binning
+ * @throw BinningMismatchException in case the binning differs
+ */
+void TriggerADCHistograms::Merge(const TriggerADCHistograms &other) {
+	if(other.fNBins != fNBins || other.fMin != fMin || other.fMax != fMax) throw BinningMismatchException();
+	for(int itype = 0; itype < kNGridTypes; itype++){
+		for(int idet = 0; idet < 2; idet++){
+			std::vector<uint32_t> &counts = fGrids[itype][idet].fCounts;
+			const std::vector<uint32_t> &othercounts = other.fGrids[itype][idet].fCounts;
+			for(size_t icounter = 0; icounter < counts.size(); icounter++) counts[icounter] += othercounts[icounter];
+		}
+	}
+	fNEvents += other.fNEvents;
+}
+
+/**
+ * Set all counts to 0
+ */
+void TriggerADCHistograms::Reset() {
+	for(int itype = 0; itype < kNGridTypes; itype++)
+		for(int idet = 0; idet < 2; idet++)
+			std::fill(fGrids[itype][idet].fCounts.begin(), fGrids[itype][idet].fCounts.end(), 0);
+	fNEvents = 0;
+}
+
+/**
+ * Get the lower edge of a bin
+ * @param bin Bin (1 to nbins, nbins + 1 gives the upper limit of the range)
+ * @return Lower edge of the bin
+ */
+double TriggerADCHistograms::GetBinLowEdge(int bin) const {
+	return fMin + (bin - 1) * (fMax - fMin) / fNBins;
+}
+
+/**
+ * Get the number of positions in column direction of a grid
+ * @param type Grid type
+ * @param isDCALPHOS If true the DCAL-PHOS grid, otherwise the EMCAL grid
+ * @return Number of positions
+ */
+int TriggerADCHistograms::GetNumberOfCols(GridType type, bool isDCALPHOS) const {
+	return fGrids[type][isDCALPHOS ? 1 : 0].fNCols;
+}
+
+/**
+ * Get the number of positions in row direction of a grid
+ * @param type Grid type
+ * @param isDCALPHOS If true the DCAL-PHOS grid, otherwise the EMCAL grid
+ * @return Number of positions
+ */
+int TriggerADCHistograms::GetNumberOfRows(GridType type, bool isDCALPHOS) const {
+	return fGrids[type][isDCALPHOS ? 1 : 0].fNRows;
+}
+
+/**
+ * Get the histogram of a position (no boundary check)
+ * @param type Grid type
+ * @param isDCALPHOS If true the DCAL-PHOS grid, otherwise the EMCAL grid
+ * @param col Column of the position (channel, start of the 2x2 window, subregion, or start subregion of the jet window)
+ * @param row Row of the position
+ * @return Pointer to the nbins + 2 counters of the histogram (underflow first)
+ */
+const uint32_t *TriggerADCHistograms::GetHistogram(GridType type, bool isDCALPHOS, int col, int row) const {
+	const HistogramGrid &grid = fGrids[type][isDCALPHOS ? 1 : 0];
+	return &grid.fCounts[(row * grid.fNCols + col) * (fNBins + 2)];
+}
+
+/**
+ * Get the count in a bin of the histogram of a position (no boundary check)
+ * @param type Grid type
+ * @param isDCALPHOS If true the DCAL-PHOS grid, otherwise the EMCAL grid
+ * @param col Column of the position
+ * @param row Row of the position
+ * @param bin Bin (0: underflow, 1 to nbins, nbins + 1: overflow)
+ * @return Number of entries
+ */
+uint32_t TriggerADCHistograms::GetCount(GridType type, bool isDCALPHOS, int col, int row, int bin) const {
+	return GetHistogram(type, isDCALPHOS, col, row)[bin];
+}
+
+/**
+ * Check that a channel map has the size of the histogram grid of the detector
+ * @param channels Channel map of the detector
+ * @param detector 0 for EMCAL, 1 for DCAL-PHOS
+ * @throw GridSizeMismatchException in case the size differs
+ */
+void TriggerADCHistograms::CheckDimensions(const TriggerChannelMap &channels, int detector) const {
+	const HistogramGrid &channelgrid = fGrids[kChannels][detector];
+	if(channels.GetNumberOfCols() != channelgrid.fNCols || channels.GetNumberOfRows() != channelgrid.fNRows)
+		throw GridSizeMismatchException(channels.GetNumberOfCols(), channels.GetNumberOfRows(), channelgrid.fNCols, channelgrid.fNRows);
+}
+
+/**
+ * Add the channel, 2x2 window, subregion and jet window amplitudes of a detector, row by row
+ * @param channels Channel map of the detector
+ * @param detector 0 for EMCAL, 1 for DCAL-PHOS
+ */
+void TriggerADCHistograms::AddDetector(const TriggerChannelMap &channels, int detector) {
+	HistogramGrid &channelgrid = fGrids[kChannels][detector], &windowgrid = fGrids[kWindows2x2][detector], &subregiongrid = fGrids[kSubregions][detector];
+	for(int irow = 0; irow < channelgrid.fNRows; irow++){
+		std::vector<double> &row = fRows[irow % 2], &previous = fRows[(irow + 1) % 2];
+		channels.GetRow(irow, &row[0]);
+		FillRow(channelgrid, irow, &row[0]);
+		if(!irow) continue;
+		fKernels->fSumWindows2x2(&previous[0], &row[0], windowgrid.fNCols, &fValues[0]);
+		FillRow(windowgrid, irow - 1, &fValues[0]);
+	}
+	TriggerSubregionMap &subregions = fSubregions[detector];
+	subregions.Fill(channels);
+	for(int srow = 0; srow < subregiongrid.fNRows; srow++){
+		for(int scol = 0; scol < subregiongrid.fNCols; scol++) fValues[scol] = subregions.GetADC(scol, srow);
+		FillRow(subregiongrid, srow, &fValues[0]);
+	}
+	const GridType jettypes[2] = {kWindows8x8, kWindows16x16};
+	const int windowsizes[2] = {2, 4};
+	for(int ijet = 0; ijet < 2; ijet++){
+		HistogramGrid &jetgrid = fGrids[jettypes[ijet]][detector];
+		for(int srow = 0; srow < jetgrid.fNRows; srow++){
+			for(int scol = 0; scol < jetgrid.fNCols; scol++) fValues[scol] = subregions.GetWindowADC(scol, srow, windowsizes[ijet]);
+			FillRow(jetgrid, srow, &fValues[0]);
+		}
+	}
+}
+
+/**
+ * Add the amplitudes of one row of positions to their histograms
+ * @param grid Histograms of the grid
+ * @param row Row of the positions
+ * @param values Amplitudes of the positions in the row
+ */
+void TriggerADCHistograms::FillRow(HistogramGrid &grid, int row, const double *values) {
+	fKernels->fComputeBins(values, grid.fNCols, fMin, fScale, fNBins, &fBins[0]);
+	const int stride = fNBins + 2;
+	uint32_t *counts = &grid.fCounts[row * grid.fNCols * stride];
+	for(int icol = 0; icol < grid.fNCols; icol++, counts += stride) counts[fBins[icol]]++;
+}
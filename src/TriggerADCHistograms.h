@@ -0,0 +1,174 @@
+#ifndef TRIGGERADCHISTOGRAMS_H
+#define TRIGGERADCHISTOGRAMS_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <exception>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TriggerKernels.h"
+#include "TriggerSubregionMap.h"
+
+class TriggerChannelMap;
+class TriggerMaker;
+
+/**
+ * @class TriggerADCHistograms
+ * @brief Amplitude distributions per trigger channel and per patch position over many events
+ *
+ * For each event the amplitudes of the FastORs (kChannels), of the 2x2 windows at all
+ * positions (kWindows2x2), of the 4x4 subregions (kSubregions) and of the 8x8 and 16x16
+ * jet windows at all subregion positions evaluated by the jet trigger (kWindows8x8,
+ * kWindows16x16, position in subregion units, see JetTriggerAlgorithm) of the EMCAL
+ * (48x64 channels) and the DCAL-PHOS (48x40 channels) are added to one histogram per
+ * position, all with the same fixed binning.
+ * The bins of a full row are computed at once with the vector kernels (TriggerKernels),
+ * and the counts of all histograms are stored in one contiguous array per grid.
+ *
+ * Bin 0 is the underflow bin (also amplitudes which are NaN), bins 1 to nbins cover the
+ * range [min, max), bin nbins + 1 is the overflow bin. Histograms filled in parallel
+ * (e.g. one per thread or worker) are combined with Merge.
+ */
+class TriggerADCHistograms {
+public:
+	enum GridType {
+		kChannels = 0,
+		kWindows2x2,
+		kSubregions,
+		kWindows8x8,
+		kWindows16x16,
+		kNGridTypes
+	};
+
+	class InvalidBinningException : public std::exception{
+	public:
+		InvalidBinningException(int nbins, double min, double max):
+			exception(),
+			fMessage("")
+		{
+			std::stringstream msgstream;
+			msgstream << "Invalid binning: " << nbins << " bins in [" << min << ", " << max << ")";
+			fMessage = msgstream.str();
+		}
+		virtual ~InvalidBinningException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string 			fMessage;			///< Error message
+	};
+
+	class GridSizeMismatchException : public std::exception{
+	public:
+		GridSizeMismatchException(int ncols, int nrows, int expectedcols, int expectedrows):
+			exception(),
+			fMessage("")
+		{
+			std::stringstream msgstream;
+			msgstream << "Channel map of " << ncols << "x" << nrows << " channels, histograms booked for " << expectedcols << "x" << expectedrows << " channels";
+			fMessage = msgstream.str();
+		}
+		virtual ~GridSizeMismatchException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string 			fMessage;			///< Error message
+	};
+
+	class BinningMismatchException : public std::exception{
+	public:
+		BinningMismatchException() {}
+		virtual ~BinningMismatchException() throw() {}
+		const char *what() const throw() {
+			return "Histograms with different binning cannot be merged";
+		}
+	};
+
+	TriggerADCHistograms(int nbins, double min, double max);
+	virtual ~TriggerADCHistograms() {}
+
+	void AddEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos);
+	void AddEvent(const TriggerMaker &maker);
+	void Merge(const TriggerADCHistograms &other);
+	void Reset();
+
+	/**
+	 * Use the vector kernels of an instruction set for the bin computation (unsupported
+	 * instruction sets are replaced by the widest supported one)
+	 * @param isa Instruction set
+	 */
+	void SetKernelISA(TriggerKernels::ISA isa) { fKernels = &TriggerKernels::GetKernels(isa); }
+
+	/**
+	 * Get the number of events added
+	 * @return Number of events
+	 */
+	unsigned long GetNumberOfEvents() const { return fNEvents; }
+	/**
+	 * Get the number of bins in the range (without underflow and overflow bin)
+	 * @return Number of bins
+	 */
+	int GetNumberOfBins() const { return fNBins; }
+	/**
+	 * Get the lower limit of the histogram range
+	 * @return Lower limit
+	 */
+	double GetMin() const { return fMin; }
+	/**
+	 * Get the upper limit of the histogram range
+	 * @return Upper limit
+	 */
+	double GetMax() const { return fMax; }
+	double GetBinLowEdge(int bin) const;
+
+	int GetNumberOfCols(GridType type, bool isDCALPHOS) const;
+	int GetNumberOfRows(GridType type, bool isDCALPHOS) const;
+	const uint32_t *GetHistogram(GridType type, bool isDCALPHOS, int col, int row) const;
+	uint32_t GetCount(GridType type, bool isDCALPHOS, int col, int row, int bin) const;
+
+private:
+	/**
+	 * @struct HistogramGrid
+	 * @brief Histograms of all positions of a grid, nbins + 2 counters per position
+	 */
+	struct HistogramGrid {
+		HistogramGrid(): fNCols(0), fNRows(0), fCounts() {}
+		void Init(int ncols, int nrows, int nbins) {
+			fNCols = ncols;
+			fNRows = nrows;
+			fCounts.assign(ncols * nrows * (nbins + 2), 0);
+		}
+
+		int						fNCols;				///< Number of positions in column direction
+		int						fNRows;				///< Number of positions in row direction
+		std::vector<uint32_t>	fCounts;			///< Counts, position-major (row, col, bin)
+	};
+
+	void CheckDimensions(const TriggerChannelMap &channels, int detector) const;
+	void AddDetector(const TriggerChannelMap &channels, int detector);
+	void FillRow(HistogramGrid &grid, int row, const double *values);
+
+	int									fNBins;								///< Number of bins in the range
+	double								fMin;								///< Lower limit of the range
+	double								fMax;								///< Upper limit of the range
+	double								fScale;								///< Bins per amplitude unit
+	const TriggerKernels::KernelTable	*fKernels;							///< Vector kernels for the bin computation
+	HistogramGrid						fGrids[kNGridTypes][2];				///< Histograms per grid type and detector (EMCAL, DCAL-PHOS)
+	std::vector<TriggerSubregionMap>	fSubregions;						///< Subregion amplitudes of the current event, per detector
+	std::vector<double>					fRows[2];							///< Buffers for two rows of the channel map
+	std::vector<double>					fValues;							///< Amplitudes of the current row of a grid
+	std::vector<int32_t>				fBins;								///< Bins of the current row of a grid
+	unsigned long						fNEvents;							///< Number of events added
+};
+
+#endif /* TRIGGERADCHISTOGRAMS_H */
@@ -20,11 +20,18 @@
 #include "TriggerAlgorithm.h"
 
 /**
- * Constructor
+ * Constructor. The algorithm runs on the EMCAL unless configured otherwise (see SetDetector).
+ * @param patchsize Size of the patches in FastORs
+ * @param stride Distance between window positions in FastORs
+ * @throw PackedRawPatch::InvalidPatchSizeException in case the patch size cannot be stored in the packed patches
  */
-TriggerAlgorithm::TriggerAlgorithm() :
-fTriggerSetup(NULL)
+TriggerAlgorithm::TriggerAlgorithm(unsigned char patchsize, unsigned char stride) :
+fTriggerSetup(NULL),
+fDetector(RawPatch::kEMCALpatch),
+fPatchSize(patchsize),
+fStride(stride)
 {
+	if(!PackedRawPatch::IsPatchSizeSupported(patchsize)) throw PackedRawPatch::InvalidPatchSizeException(patchsize);
 }
 
 int RawPatch::GetUniqueID() const {
@@ -32,3 +39,50 @@ int RawPatch::GetUniqueID() const {
 	int subregionSize  = ((fPatchSize == 16) || (fPatchSize == 8)) ? 4 : 1, neta = 48/subregionSize;
 	return int(fCol)/subregionSize + int(fRow)/subregionSize * neta;
 }
+
+/**
+ * Constructor, converting a raw patch into the compact representation
+ * @param patch Raw patch to be converted
+ * @throw InvalidPatchSizeException in case the patch size is not supported (see IsPatchSizeSupported)
+ */
+PackedRawPatch::PackedRawPatch(const RawPatch &patch):
+	fWord(PackCol(patch.GetColStart()) | PackRow(patch.GetRowStart()) | PackType(patch.GetPatchType()) | PackSize(patch.GetPatchSize()) | PackTriggerBits(patch.GetTriggerBits())),
+	fADC(static_cast<float>(patch.GetADC()))
+{
+	if(!IsPatchSizeSupported(patch.GetPatchSize())) throw InvalidPatchSizeException(patch.GetPatchSize());
+}
+
+/**
+ * Convert the compact patch back into a raw patch
+ * @return Raw patch with the same content
+ */
+RawPatch PackedRawPatch::ToRawPatch() const {
+	RawPatch result(GetColStart(), GetRowStart(), GetADC(), GetTriggerBits());
+	result.SetPatchSize(GetPatchSize());
+	result.SetPatchType(GetPatchType());
+	return result;
+}
+
+/**
+ * Get the max. patch of a patch list sorted by amplitude. Among the patches with the
+ * highest amplitude the patch at the preferred position is taken (see IsPreferredPosition),
+ * independent of the order of equal amplitudes after sorting.
+ * @param patches Patch list sorted by amplitude, not empty
+ * @return Patch with the highest amplitude
+ */
+const PackedRawPatch &PackedRawPatch::GetMaxPatch(const std::vector<PackedRawPatch> &patches) {
+	const PackedRawPatch *result = &patches.back();
+	for(std::vector<PackedRawPatch>::const_reverse_iterator patchiter = patches.rbegin() + 1; patchiter != patches.rend() && patchiter->fADC == result->fADC; ++patchiter)
+		if(IsPreferredPosition(patchiter->GetColStart(), patchiter->GetRowStart(), result->GetColStart(), result->GetRowStart())) result = &(*patchiter);
+	return *result;
+}
+
+/**
+ * Get unique ID of the patch, calculated, from col, row and subregion size
+ * @return Unique ID of the patch;
+ */
+int PackedRawPatch::GetUniqueID() const {
+	unsigned char patchsize = GetPatchSize();
+	int subregionSize  = ((patchsize == 16) || (patchsize == 8)) ? 4 : 1, neta = 48/subregionSize;
+	return int(GetColStart())/subregionSize + int(GetRowStart())/subregionSize * neta;
+}
@@ -7,11 +7,18 @@
  *  (at your option) any later version. (See cxx source for full Copyright notice)
  */
 
+#include <cstddef>
+#include <exception>
+#include <sstream>
+#include <stdint.h>
+#include <string>
 #include <vector>
 
 class PatchContainer;
 class TriggerChannelMap;
+class TriggerPatchMask;
 class TriggerSetup;
+class TriggerSubregionMap;
 
 /**
  * @class RawPatch
@@ -35,6 +42,8 @@ public:
 		kDCALpatchGA,		
 		kDCALpatchJE,				
 		kDCALpatchJE8x8,				
+		kEMCALpatchL0,
+		kDCALpatchL0,
 		kUndefPatch
 	};
 
@@ -113,6 +122,12 @@ public:
 	 */
 	int GetTriggerBits() const { return fTriggerBits; }
 
+	/**
+	 * Get the type of the patch
+	 * @return Type of the patch
+	 */
+	Patchtype GetPatchType() const { return fPatchType; }
+
 	/**
 	 * Check whether patch is of type EMCAL
 	 * @return True if patch is of type EMCAL, false otherwise
@@ -140,26 +155,277 @@ private:
 	Patchtype				fPatchType;		///< Type of the trigger patch
 };
 
+/**
+ * @class PackedRawPatch
+ * @brief Compact (8 byte) representation of a raw patch
+ *
+ * Stores the same information as RawPatch in one 32-bit word and a single
+ * precision amplitude, so that patch lists of a full event stay small and
+ * can be sorted and scanned quickly. Layout of the word:
+ * - bits 0-5:   starting column
+ * - bits 6-12:  starting row
+ * - bits 13-16: patch type
+ * - bits 17-19: patch size, encoded as log2(size) + 1 (0 for size 0)
+ * - bits 20-31: trigger bits (trigger bits 0-11)
+ * Patch sizes have to be 0 or a power of 2 up to 64 (see IsPatchSizeSupported). The size
+ * is checked when converting a RawPatch and when constructing a TriggerAlgorithm, the
+ * constructor used in the patch finders relies on the size of the algorithm.
+ */
+class PackedRawPatch {
+public:
+	class InvalidPatchSizeException : public std::exception{
+	public:
+		InvalidPatchSizeException(int patchsize):
+			exception(),
+			fMessage(""),
+			fPatchSize(patchsize)
+		{
+			std::stringstream msgstream;
+			msgstream << "Patch size " << fPatchSize << " cannot be stored in a packed patch";
+			fMessage = msgstream.str();
+		}
+		virtual ~InvalidPatchSizeException() throw() {}
+
+		int GetPatchSize() const throw() { return fPatchSize; }
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string 			fMessage;			///< Error message
+		int						fPatchSize;			///< Requested patch size
+	};
+
+	enum {
+		kNTriggerBits = 12				///< Number of trigger bits which can be stored
+	};
+
+	/**
+	 * Check whether a patch size can be stored in the packed representation
+	 * @param patchsize Size of the patch
+	 * @return True if the size is 0 or a power of 2 up to 64
+	 */
+	static bool IsPatchSizeSupported(unsigned int patchsize) {
+		return patchsize <= 64 && !(patchsize & (patchsize - 1));
+	}
+
+	/**
+	 * Default constructor, same content as the default RawPatch
+	 */
+	PackedRawPatch():
+		fWord(PackType(RawPatch::kUndefPatch)),
+		fADC(-1.f)
+	{}
+
+	/**
+	 * Constructor, initializing all fields
+	 * @param col Starting col
+	 * @param row Starting row
+	 * @param adc Patch amplitude
+	 * @param triggerBits Trigger bits of the patch
+	 * @param patchsize Size of the patch
+	 * @param ptype Type of the patch
+	 */
+	PackedRawPatch(unsigned char col, unsigned char row, double adc, unsigned int triggerBits, unsigned char patchsize, RawPatch::Patchtype ptype):
+		fWord(PackCol(col) | PackRow(row) | PackType(ptype) | PackSize(patchsize) | PackTriggerBits(triggerBits)),
+		fADC(static_cast<float>(adc))
+	{}
+
+	explicit PackedRawPatch(const RawPatch &patch);  // throws InvalidPatchSizeException
+
+	/**
+	 * Destructor
+	 */
+	~PackedRawPatch() {}
+
+	RawPatch ToRawPatch() const;
+	static const PackedRawPatch &GetMaxPatch(const std::vector<PackedRawPatch> &patches);
+
+	/**
+	 * Tie-break between patches with the same amplitude: the patch with the lower
+	 * start row, or in the same row the lower start column, is the max. patch
+	 * @param col Starting col of the patch
+	 * @param row Starting row of the patch
+	 * @param othercol Starting col of the other patch
+	 * @param otherrow Starting row of the other patch
+	 * @return True if the patch is preferred over the other patch
+	 */
+	static bool IsPreferredPosition(unsigned char col, unsigned char row, unsigned char othercol, unsigned char otherrow) {
+		return row < otherrow || (row == otherrow && col < othercol);
+	}
+
+	/**
+	 * Comparison operator, comparing to other in terms of ADC value
+	 * @param other Object to compare with
+	 * @return True if this adc is smaller, false otherwise
+	 */
+	bool operator<(const PackedRawPatch &other) const {
+		return fADC < other.fADC;
+	}
+
+	/**
+	 * Set the type of the patch
+	 * @param ptype Type of the patch
+	 */
+	void SetPatchType(RawPatch::Patchtype ptype) { fWord = (fWord & ~(kTypeMask << kTypeShift)) | PackType(ptype); }
+
+	/**
+	 * Get starting row of the patch
+	 * @return starting row
+	 */
+	unsigned char GetRowStart() const { return (fWord >> kRowShift) & kRowMask; }
+	/**
+	 * Get Starting column of the patch
+	 * @return starting column
+	 */
+	unsigned char GetColStart() const { return (fWord >> kColShift) & kColMask; }
+	/**
+	 * Get the patch amplitude
+	 * @return the patch amplitude (single precision)
+	 */
+	double GetADC() const { return fADC; }
+
+	/**
+	 * Get the size of the patch
+	 * @return size of the patch
+	 */
+	unsigned char GetPatchSize() const {
+		uint32_t sizecode = (fWord >> kSizeShift) & kSizeMask;
+		return sizecode ? 1 << (sizecode - 1) : 0;
+	}
+
+	/**
+	 * Get the trigger bits
+	 */
+	int GetTriggerBits() const { return (fWord >> kTriggerBitsShift) & kTriggerBitsMask; }
+
+	/**
+	 * Get the type of the patch
+	 * @return Type of the patch
+	 */
+	RawPatch::Patchtype GetPatchType() const { return static_cast<RawPatch::Patchtype>((fWord >> kTypeShift) & kTypeMask); }
+
+	/**
+	 * Check whether patch is of type EMCAL
+	 * @return True if patch is of type EMCAL, false otherwise
+	 */
+	bool IsEMCAL() const { return GetPatchType() == RawPatch::kEMCALpatch; }
+
+	/**
+	 * Check whether patch is of type DCAL-PHOS
+	 * @return True if patch is of type DCAL-PHOS, false otherwise
+	 */
+	bool IsDCALPHOS() const { return GetPatchType() == RawPatch::kDCALPHOSpatch; }
+
+	int GetUniqueID() const;
+
+private:
+	enum {
+		kColShift = 0,
+		kColMask = 0x3f,
+		kRowShift = 6,
+		kRowMask = 0x7f,
+		kTypeShift = 13,
+		kTypeMask = 0xf,
+		kSizeShift = 17,
+		kSizeMask = 0x7,
+		kTriggerBitsShift = 20,
+		kTriggerBitsMask = 0xfff
+	};
+
+	static uint32_t PackCol(unsigned char col) { return (uint32_t(col) & kColMask) << kColShift; }
+	static uint32_t PackRow(unsigned char row) { return (uint32_t(row) & kRowMask) << kRowShift; }
+	static uint32_t PackType(RawPatch::Patchtype ptype) { return (uint32_t(ptype) & kTypeMask) << kTypeShift; }
+	static uint32_t PackTriggerBits(unsigned int triggerBits) { return (uint32_t(triggerBits) & kTriggerBitsMask) << kTriggerBitsShift; }
+	static uint32_t PackSize(unsigned char patchsize) {
+		uint32_t sizecode = 0;
+		while(patchsize >> sizecode) sizecode++;
+		return (sizecode & kSizeMask) << kSizeShift;
+	}
+
+	uint32_t 				fWord;				///< Position, type, size and trigger bits of the patch
+	float 					fADC;				///< ADC value of the raw patch
+};
+
 /**
  * @class TriggerAlgorithm
  * @brief Base class for EMCAL trigger algorithms
  *
  * Base class for trigger algorithm implementations for the EMCAL trigger.
+ * Each instance declares the patches it produces (patch size, stride between
+ * window positions and detector), which defines its patch category. Instances
+ * are registered in the TriggerMaker, which runs them via the category
+ * interface (GetCategory and the packed FindPatches).
  */
 class TriggerAlgorithm {
 public:
-	TriggerAlgorithm();
+	TriggerAlgorithm(unsigned char patchsize = 0, unsigned char stride = 1);
 	virtual ~TriggerAlgorithm() {}
 
 	virtual std::vector<RawPatch> FindPatches(const TriggerChannelMap * channels) const = 0;
+
+	/**
+	 * Find the patches of the category of the algorithm in the compact representation.
+	 * @param channels Input channel map
+	 * @param subregions Subregion map filled from the input channel map (only provided if UsesSubregions is true)
+	 * @param patches Output container, cleared before filling, sorted by amplitude
+	 * @param mask Accepted patch positions (all positions accepted if NULL)
+	 */
+	virtual void FindPatches(const TriggerChannelMap *channels, const TriggerSubregionMap *subregions, std::vector<PackedRawPatch> &patches, const TriggerPatchMask *mask) const = 0;
+
+	/**
+	 * Get the patch category produced by the algorithm for its patch size and detector
+	 * @return Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+	 */
+	virtual int GetCategory() const = 0;
+
+	/**
+	 * Check whether the algorithm needs the 4x4 subregion amplitudes as input
+	 * @return True if the subregion map has to be provided
+	 */
+	virtual bool UsesSubregions() const { return false; }
+
 	/**
 	 * Set the trigger channel ADC map used to create the trigger patches
 	 * @param inputdata input
 	 */
 	void SetTriggerSetup(TriggerSetup *triggersetup) { fTriggerSetup = triggersetup; }
 
+	/**
+	 * Set the detector the algorithm runs on
+	 * @param detector Patch type of the detector (RawPatch::kEMCALpatch or RawPatch::kDCALPHOSpatch)
+	 */
+	void SetDetector(RawPatch::Patchtype detector) { fDetector = detector; }
+
+	/**
+	 * Get the detector the algorithm runs on
+	 * @return Patch type of the detector
+	 */
+	RawPatch::Patchtype GetDetector() const { return fDetector; }
+
+	/**
+	 * Check whether the algorithm runs on the DCAL-PHOS
+	 * @return True if the detector is the DCAL-PHOS
+	 */
+	bool IsDCALPHOS() const { return fDetector == RawPatch::kDCALPHOSpatch; }
+
+	/**
+	 * Get the size of the patches found by the algorithm
+	 * @return Patch size in FastORs
+	 */
+	unsigned char GetPatchSize() const { return fPatchSize; }
+
+	/**
+	 * Get the distance between neighboring window positions
+	 * @return Stride in FastORs
+	 */
+	unsigned char GetStride() const { return fStride; }
+
 protected:
 	TriggerSetup  		              *fTriggerSetup;       ///< Trigger setup data
+	RawPatch::Patchtype					fDetector;			///< Detector the algorithm runs on
+	unsigned char						fPatchSize;			///< Size of the patches in FastORs
+	unsigned char						fStride;			///< Distance between window positions in FastORs
 };
 
 #endif /* TRIGGERALGORITHM_H */
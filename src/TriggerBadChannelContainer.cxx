@@ -16,18 +16,38 @@
  *  You should have received a copy of the GNU General Public License           *
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
  ********************************************************************************/
+#include <cstring>
+
 #include "TriggerBadChannelContainer.h"
 
+namespace {
+/**
+ * Check whether a position is covered by the bitmask
+ */
+inline bool IsInMask(int col, int row) {
+  return col >= 0 && col < TriggerBadChannelContainer::kMaxCols && row >= 0 && row < TriggerBadChannelContainer::kMaxRows;
+}
+}
+
+TriggerBadChannelContainer::TriggerBadChannelContainer():
+  fChannels()
+{
+  memset(fMask, 0, sizeof(fMask));
+}
+
 void TriggerBadChannelContainer::AddChannel(int col, int row){
   if(HasChannel(col, row)) return;
+  if(IsInMask(col, row)) fMask[row] |= uint64_t(1) << col;
   fChannels.push_back(TriggerChannelPosition(col, row));
 }
 
 
-bool TriggerBadChannelContainer::HasChannel(int col, int row){
+bool TriggerBadChannelContainer::HasChannel(int col, int row) const {
+  if(IsInMask(col, row)) return (fMask[row] >> col) & 1;
+  // positions outside the bitmask are only in the list
   TriggerChannelPosition test(col, row);
   bool found(false);
-  for(std::vector<TriggerChannelPosition>::iterator channeliter = fChannels.begin(); channeliter != fChannels.end(); ++channeliter){
+  for(std::vector<TriggerChannelPosition>::const_iterator channeliter = fChannels.begin(); channeliter != fChannels.end(); ++channeliter){
 	  if(*channeliter == test){
 		  found = true;
 		  break;
@@ -36,6 +56,28 @@ bool TriggerBadChannelContainer::HasChannel(int col, int row){
   return found;
 }
 
+/**
+ * Replace the content of the container by the channels of a bitmask, as obtained
+ * from GetMask (e.g. from a bad channel file, see TriggerBadChannelFileReader)
+ * @param mask Bitmask with kNMaskWords words, word = row, bit = column
+ */
+void TriggerBadChannelContainer::SetMask(const uint64_t *mask){
+  memcpy(fMask, mask, sizeof(fMask));
+  fChannels.clear();
+  for(int row = 0; row < kMaxRows; row++){
+    for(uint64_t bits = fMask[row]; bits; bits &= bits - 1)
+      fChannels.push_back(TriggerChannelPosition(__builtin_ctzll(bits), row));
+  }
+}
+
+/**
+ * Remove all channels from the container
+ */
+void TriggerBadChannelContainer::Clear(){
+  memset(fMask, 0, sizeof(fMask));
+  fChannels.clear();
+}
+
 bool TriggerBadChannelContainer::TriggerChannelPosition::operator==(const TriggerChannelPosition &other) const {
   return fCol == other.fCol && fRow == other.fRow;
 }
@@ -7,6 +7,8 @@
  *  (at your option) any later version. (See cxx source for full Copyright notice)
  */
 
+#include <cstddef>
+#include <stdint.h>
 #include <vector>
 
 /**
@@ -16,9 +18,19 @@
  * This structure is a container for trigger channels in col-row space with
  * a given mask. Channels can only be added to the container, or it can be
  * checked whether the channel is listed in the container.
+ *
+ * Channels inside kMaxCols x kMaxRows are in addition stored in a bitmask
+ * (one 64-bit word per row, bit = column), so that the lookup and the
+ * insertion are constant-time. The bitmask can be exchanged as a whole
+ * (SetMask), e.g. when switching to the bad channels of another run.
  */
 class TriggerBadChannelContainer {
 public:
+  enum {
+    kMaxCols = 64,                  ///< Max. number of columns in the bitmask (bits per word)
+    kMaxRows = 128,                 ///< Max. number of rows in the bitmask
+    kNMaskWords = kMaxRows          ///< Number of 64-bit words of the bitmask
+  };
 
   /**
    * @struct TriggerChannelPosition
@@ -96,7 +108,7 @@ public:
   /**
    * Constructor
    */
-  TriggerBadChannelContainer(): fChannels() {}
+  TriggerBadChannelContainer();
 
   /**
    * Destructor, cleans up the container
@@ -117,7 +129,7 @@ public:
    * @param row Row of the channel
    * @return True if the channel is listed, false otherwise
    */
-  bool HasChannel(int col, int row);
+  bool HasChannel(int col, int row) const;
 
   /**
    * Get Channels
@@ -127,8 +139,24 @@ public:
     return fChannels;
   }
 
+  /**
+   * Get the number of channels in the container
+   * @return Number of channels
+   */
+  size_t GetNumberOfChannels() const { return fChannels.size(); }
+
+  /**
+   * Get the bitmask of the channels inside kMaxCols x kMaxRows
+   * @return Bitmask with kNMaskWords words, word = row, bit = column
+   */
+  const uint64_t *GetMask() const { return fMask; }
+
+  void SetMask(const uint64_t *mask);
+  void Clear();
+
 private:
   std::vector<TriggerChannelPosition>             fChannels;      ///< Container for listed channels
+  uint64_t                                        fMask[kNMaskWords];   ///< Bitmask of the listed channels inside kMaxCols x kMaxRows
 };
 
 #endif
@@ -0,0 +1,230 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <cstring>
+#include <fstream>
+
+#include "TriggerBadChannelFile.h"
+#include "TriggerMaker.h"
+
+namespace {
+const size_t kMaskSize = TriggerBadChannelContainer::kNMaskWords * sizeof(uint64_t);
+}
+
+const TriggerBinaryFile::FileFormat TriggerBadChannelFile::kFileFormat = {"Bad channel file", {'E', 'T', 'F', 'B', 'A', 'D', 'C', 'H'}, 1};
+
+/**
+ * Constructor, without run ranges
+ */
+TriggerBadChannelFileWriter::TriggerBadChannelFileWriter():
+	TriggerBadChannelFile(),
+	fRunRanges(),
+	fMasks()
+{
+}
+
+/**
+ * Add the bad channels of a run range. Masks identical to the ones of other run
+ * ranges are stored only once.
+ * @param firstrun First run of the range
+ * @param lastrun Last run of the range (inclusive)
+ * @param emcal Bad channels of the EMCAL
+ * @param dcalphos Bad channels of the DCAL-PHOS
+ * @throw RunRangeException in case the run range is empty or overlaps with a run range added before
+ */
+void TriggerBadChannelFileWriter::AddRunRange(uint32_t firstrun, uint32_t lastrun, const TriggerBadChannelContainer &emcal, const TriggerBadChannelContainer &dcalphos) {
+	if(firstrun > lastrun) throw RunRangeException(firstrun, lastrun, "last run before first run");
+	std::vector<RunRange>::iterator position = fRunRanges.begin();
+	while(position != fRunRanges.end() && position->fLastRun < firstrun) ++position;
+	if(position != fRunRanges.end() && position->fFirstRun <= lastrun)
+		throw RunRangeException(firstrun, lastrun, "overlapping with an existing run range");
+
+	RunRange range;
+	range.fFirstRun = firstrun;
+	range.fLastRun = lastrun;
+	range.fMaskEMCAL = AddMask(emcal.GetMask());
+	range.fMaskDCALPHOS = AddMask(dcalphos.GetMask());
+	fRunRanges.insert(position, range);
+}
+
+/**
+ * Find a bitmask in the list of distinct masks, adding it if not yet present
+ * @param mask Bitmask with TriggerBadChannelContainer::kNMaskWords words
+ * @return Index of the mask
+ */
+uint32_t TriggerBadChannelFileWriter::AddMask(const uint64_t *mask) {
+	uint32_t nmasks = GetNumberOfMasks();
+	for(uint32_t imask = 0; imask < nmasks; imask++){
+		if(!memcmp(&fMasks[imask * TriggerBadChannelContainer::kNMaskWords], mask, kMaskSize)) return imask;
+	}
+	fMasks.insert(fMasks.end(), mask, mask + TriggerBadChannelContainer::kNMaskWords);
+	return nmasks;
+}
+
+/**
+ * Write all run ranges to a file
+ * @param filename Name of the file
+ * @throw FileIOException in case the file cannot be written
+ */
+void TriggerBadChannelFileWriter::Write(const std::string &filename) const {
+	std::ofstream writer(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!writer.good()) throw FileIOException(kFileFormat.fType, filename, "cannot open file for writing");
+	FileHeader header;
+	InitSignature(header.fSignature, kFileFormat);
+	header.fNRunRanges = fRunRanges.size();
+	header.fNMasks = GetNumberOfMasks();
+	writer.write(reinterpret_cast<const char *>(&header), sizeof(header));
+	if(fRunRanges.size()) writer.write(reinterpret_cast<const char *>(&fRunRanges[0]), fRunRanges.size() * sizeof(RunRange));
+	if(fMasks.size()) writer.write(reinterpret_cast<const char *>(&fMasks[0]), fMasks.size() * sizeof(uint64_t));
+	writer.close();
+	if(writer.fail()) throw FileIOException(kFileFormat.fType, filename, "write error");
+}
+
+/**
+ * Constructor, without open file
+ */
+TriggerBadChannelFileReader::TriggerBadChannelFileReader():
+	TriggerBadChannelFile(),
+	fFilename(""),
+	fMapping(NULL),
+	fMappingSize(0),
+	fNRunRanges(0),
+	fRunRanges(NULL),
+	fMasks(NULL)
+{
+}
+
+/**
+ * Destructor, unmapping the file
+ */
+TriggerBadChannelFileReader::~TriggerBadChannelFileReader() {
+	Close();
+}
+
+/**
+ * Map a bad channel file into memory. A file still open is closed before.
+ * @param filename Name of the file
+ * @throw FileIOException in case the file cannot be read or has an invalid format
+ */
+void TriggerBadChannelFileReader::Open(const std::string &filename) {
+	Close();
+	size_t filesize(0);
+	void *mapping = MapFile(filename, kFileFormat, sizeof(FileHeader), filesize);
+
+	const FileHeader &header = *static_cast<const FileHeader *>(mapping);
+	std::string reason;
+	// 32 bit counts, the size computation cannot overflow
+	bool valid = static_cast<uint64_t>(filesize) == sizeof(FileHeader) + uint64_t(header.fNRunRanges) * sizeof(RunRange) + uint64_t(header.fNMasks) * kMaskSize;
+	if(!valid) reason = "truncated file";
+	const RunRange *ranges = reinterpret_cast<const RunRange *>(static_cast<const char *>(mapping) + sizeof(FileHeader));
+	for(uint32_t irange = 0; valid && irange < header.fNRunRanges; irange++){
+		if(ranges[irange].fFirstRun > ranges[irange].fLastRun || (irange && ranges[irange - 1].fLastRun >= ranges[irange].fFirstRun)
+				|| ranges[irange].fMaskEMCAL >= header.fNMasks || ranges[irange].fMaskDCALPHOS >= header.fNMasks){
+			reason = "invalid run range table";
+			valid = false;
+		}
+	}
+	if(!valid){
+		UnmapFile(mapping, filesize);
+		throw FileIOException(kFileFormat.fType, filename, reason);
+	}
+	fFilename = filename;
+	fMapping = mapping;
+	fMappingSize = filesize;
+	fNRunRanges = header.fNRunRanges;
+	fRunRanges = ranges;
+	fMasks = reinterpret_cast<const uint64_t *>(ranges + header.fNRunRanges);
+}
+
+/**
+ * Unmap the file. Nothing is done in case no file is open.
+ */
+void TriggerBadChannelFileReader::Close() {
+	if(fMapping) UnmapFile(fMapping, fMappingSize);
+	fMapping = NULL;
+	fMappingSize = 0;
+	fNRunRanges = 0;
+	fRunRanges = NULL;
+	fMasks = NULL;
+}
+
+/**
+ * Get the limits of a run range
+ * @param index Index of the run range, in order of the runs
+ * @param firstrun First run of the range
+ * @param lastrun Last run of the range (inclusive)
+ * @throw FileIOException in case the index is out of range
+ */
+void TriggerBadChannelFileReader::GetRunRange(uint32_t index, uint32_t &firstrun, uint32_t &lastrun) const {
+	if(index >= fNRunRanges) throw FileIOException(kFileFormat.fType, fFilename, "run range index out of range");
+	firstrun = fRunRanges[index].fFirstRun;
+	lastrun = fRunRanges[index].fLastRun;
+}
+
+/**
+ * Find the run range containing a run (binary search)
+ * @param run Run number
+ * @return Run range, NULL if the run is not in the file
+ */
+const TriggerBadChannelFile::RunRange *TriggerBadChannelFileReader::FindRunRange(uint32_t run) const {
+	uint32_t low = 0, high = fNRunRanges;
+	while(low < high){
+		uint32_t middle = low + (high - low) / 2;
+		if(fRunRanges[middle].fLastRun < run) low = middle + 1;
+		else high = middle;
+	}
+	if(low == fNRunRanges || fRunRanges[low].fFirstRun > run) return NULL;
+	return fRunRanges + low;
+}
+
+/**
+ * Find the run range containing a run
+ * @param run Run number
+ * @return Run range
+ * @throw RunRangeException in case the run is not in the file
+ */
+const TriggerBadChannelFile::RunRange &TriggerBadChannelFileReader::GetRunRangeChecked(uint32_t run) const {
+	const RunRange *range = FindRunRange(run);
+	if(!range) throw RunRangeException(run, run, "no bad channels defined in " + fFilename);
+	return *range;
+}
+
+/**
+ * Replace the content of bad channel containers by the bad channels of a run
+ * @param run Run number
+ * @param emcal Bad channels of the EMCAL
+ * @param dcalphos Bad channels of the DCAL-PHOS
+ * @throw RunRangeException in case the run is not in the file
+ */
+void TriggerBadChannelFileReader::LoadRun(uint32_t run, TriggerBadChannelContainer &emcal, TriggerBadChannelContainer &dcalphos) const {
+	const RunRange &range = GetRunRangeChecked(run);
+	emcal.SetMask(fMasks + range.fMaskEMCAL * TriggerBadChannelContainer::kNMaskWords);
+	dcalphos.SetMask(fMasks + range.fMaskDCALPHOS * TriggerBadChannelContainer::kNMaskWords);
+}
+
+/**
+ * Replace the bad channels of a trigger maker by the bad channels of a run
+ * @param run Run number
+ * @param maker Trigger maker
+ * @throw RunRangeException in case the run is not in the file
+ */
+void TriggerBadChannelFileReader::LoadRun(uint32_t run, TriggerMaker &maker) const {
+	const RunRange &range = GetRunRangeChecked(run);
+	maker.SetBadChannelMaskEMCAL(fMasks + range.fMaskEMCAL * TriggerBadChannelContainer::kNMaskWords);
+	maker.SetBadChannelMaskDCALPHOS(fMasks + range.fMaskDCALPHOS * TriggerBadChannelContainer::kNMaskWords);
+}
@@ -0,0 +1,168 @@
+#ifndef TRIGGERBADCHANNELFILE_H
+#define TRIGGERBADCHANNELFILE_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <exception>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TriggerBadChannelContainer.h"
+#include "TriggerBinaryFile.h"
+
+class TriggerMaker;
+
+/**
+ * @class TriggerBadChannelFile
+ * @brief Binary files of bad channel masks, versioned by run ranges
+ *
+ * File layout (byte order of the machine writing the file):
+ * - header: signature (magic, version, byte order marker, see TriggerBinaryFile), number
+ *   of run ranges, number of masks
+ * - run ranges (first run, last run, index of the EMCAL mask, index of the DCAL-PHOS mask),
+ *   sorted by run and not overlapping
+ * - bitmasks of bad channels (TriggerBadChannelContainer::GetMask), each stored once
+ *   even if used by several run ranges
+ *
+ * Run ranges are looked up in the file mapping, and switching to another run (LoadRun)
+ * copies one fixed-size bitmask per detector from the mapping into the bad channel
+ * containers, so its cost does not depend on the number of bad channels. Files are written with
+ * TriggerBadChannelFileWriter and read with TriggerBadChannelFileReader.
+ */
+class TriggerBadChannelFile : public TriggerBinaryFile {
+public:
+	class RunRangeException : public std::exception{
+	public:
+		RunRangeException(uint32_t firstrun, uint32_t lastrun, const std::string &reason):
+			exception(),
+			fMessage("")
+		{
+			std::stringstream msgbuilder;
+			msgbuilder << "Run range " << firstrun << "-" << lastrun << ": " << reason;
+			fMessage = msgbuilder.str();
+		}
+		virtual ~RunRangeException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string				fMessage;			///< Error message
+	};
+
+	TriggerBadChannelFile() {}
+	virtual ~TriggerBadChannelFile() {}
+
+protected:
+	/**
+	 * @struct FileHeader
+	 * @brief Header at the beginning of the file
+	 */
+	struct FileHeader {
+		FileSignature			fSignature;			///< File type, version and byte order
+		uint32_t				fNRunRanges;		///< Number of run ranges
+		uint32_t				fNMasks;			///< Number of bitmasks
+	};
+
+	/**
+	 * @struct RunRange
+	 * @brief Run range with the bitmasks valid for it
+	 */
+	struct RunRange {
+		uint32_t				fFirstRun;			///< First run of the range
+		uint32_t				fLastRun;			///< Last run of the range (inclusive)
+		uint32_t				fMaskEMCAL;			///< Index of the EMCAL bitmask
+		uint32_t				fMaskDCALPHOS;		///< Index of the DCAL-PHOS bitmask
+	};
+
+	static const FileFormat kFileFormat;			///< Format of bad channel files
+};
+
+/**
+ * @class TriggerBadChannelFileWriter
+ * @brief Writer of bad channel files (see TriggerBadChannelFile for the format)
+ *
+ * The run ranges are collected in memory and written at once with Write.
+ */
+class TriggerBadChannelFileWriter : public TriggerBadChannelFile {
+public:
+	TriggerBadChannelFileWriter();
+	virtual ~TriggerBadChannelFileWriter() {}
+
+	void AddRunRange(uint32_t firstrun, uint32_t lastrun, const TriggerBadChannelContainer &emcal, const TriggerBadChannelContainer &dcalphos);
+	void Write(const std::string &filename) const;
+
+	/**
+	 * Get the number of run ranges added so far
+	 * @return Number of run ranges
+	 */
+	size_t GetNumberOfRunRanges() const { return fRunRanges.size(); }
+
+	/**
+	 * Get the number of distinct bitmasks of the run ranges added so far
+	 * @return Number of bitmasks
+	 */
+	size_t GetNumberOfMasks() const { return fMasks.size() / TriggerBadChannelContainer::kNMaskWords; }
+
+private:
+	uint32_t AddMask(const uint64_t *mask);
+
+	std::vector<RunRange>			fRunRanges;			///< Run ranges, sorted by run
+	std::vector<uint64_t>			fMasks;				///< Distinct bitmasks, concatenated
+};
+
+/**
+ * @class TriggerBadChannelFileReader
+ * @brief Reader of bad channel files (see TriggerBadChannelFile for the format)
+ *
+ * The file is mapped read-only into memory. The run range of a run is found by
+ * binary search, and its bitmasks are copied into the bad channel containers
+ * (LoadRun), e.g. of the trigger maker when the run changes within a job.
+ */
+class TriggerBadChannelFileReader : public TriggerBadChannelFile {
+public:
+	TriggerBadChannelFileReader();
+	virtual ~TriggerBadChannelFileReader();
+
+	void Open(const std::string &filename);
+	void Close();
+
+	/**
+	 * Get the number of run ranges in the file
+	 * @return Number of run ranges (0 if no file is open)
+	 */
+	uint32_t GetNumberOfRunRanges() const { return fNRunRanges; }
+
+	/**
+	 * Check whether bad channels are defined for a run
+	 * @param run Run number
+	 * @return True if the run is inside one of the run ranges
+	 */
+	bool HasRun(uint32_t run) const { return FindRunRange(run) != NULL; }
+
+	void GetRunRange(uint32_t index, uint32_t &firstrun, uint32_t &lastrun) const;
+	void LoadRun(uint32_t run, TriggerBadChannelContainer &emcal, TriggerBadChannelContainer &dcalphos) const;
+	void LoadRun(uint32_t run, TriggerMaker &maker) const;
+
+private:
+	TriggerBadChannelFileReader(const TriggerBadChannelFileReader &ref);
+	TriggerBadChannelFileReader &operator=(const TriggerBadChannelFileReader &ref);
+
+	const RunRange *FindRunRange(uint32_t run) const;
+	const RunRange &GetRunRangeChecked(uint32_t run) const;
+
+	std::string						fFilename;			///< Name of the open file
+	void							*fMapping;			///< Start of the file mapping
+	size_t							fMappingSize;		///< Size of the file mapping
+	uint32_t						fNRunRanges;		///< Number of run ranges
+	const RunRange					*fRunRanges;		///< Run ranges, sorted by run
+	const uint64_t					*fMasks;			///< Bitmasks, TriggerBadChannelContainer::kNMaskWords words each
+};
+
+#endif /* TRIGGERBADCHANNELFILE_H */
@@ -0,0 +1,236 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+#include <cfloat>
+
+#include "TriggerBatchEngine.h"
+#include "TriggerChannelMap.h"
+#include "TriggerRegionMap.h"
+
+/**
+ * Constructor, initializing the interleaved channel maps for EMCAL and DCAL-PHOS
+ */
+TriggerBatchEngine::TriggerBatchEngine():
+	fTriggerSetup(),
+	fKernels(&TriggerKernels::GetKernels(TriggerKernels::SelectISA())),
+	fEMCAL(48, 64),
+	fDCALPHOS(48, 40),
+	fNEvents(0),
+	fLevel0Enabled(false),
+	fPatchMasks()
+{
+	for(int icat = 0; icat < TriggerMaker::kNPatchCategories; icat++){
+		for(int ilane = 0; ilane < kNLanes; ilane++){
+			fMaxADC[icat][ilane] = -DBL_MAX;
+			fTriggerBits[icat][ilane] = 0;
+		}
+	}
+}
+
+/**
+ * Use the patch masks of a trigger maker (PHOS acceptance and exclusion regions): window
+ * positions rejected by the mask of a category are skipped when evaluating the category.
+ * The masks are kept until the next call, also across batches.
+ * @param maker Trigger maker providing the patch masks
+ */
+void TriggerBatchEngine::SetPatchMasks(const TriggerMaker &maker) {
+	for(int category = RawPatch::kEMCALpatchGA; category <= RawPatch::kDCALpatchL0; category++)
+		fPatchMasks[TriggerMaker::GetCategoryIndex(category)] = maker.GetPatchMask(category);
+}
+
+/**
+ * Remove all events from the batch
+ */
+void TriggerBatchEngine::Reset() {
+	std::fill(fEMCAL.fADC.begin(), fEMCAL.fADC.end(), 0.);
+	std::fill(fDCALPHOS.fADC.begin(), fDCALPHOS.fADC.end(), 0.);
+	fNEvents = 0;
+}
+
+/**
+ * Add an event to the batch
+ * @param emcal EMCAL channel map of the event
+ * @param dcalphos DCAL-PHOS channel map of the event
+ * @return Index of the event in the batch
+ * @throw BatchFullException in case the batch is already full
+ */
+int TriggerBatchEngine::AddEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos) {
+	if(IsFull()) throw BatchFullException();
+	Load(emcal, fEMCAL, fNEvents);
+	Load(dcalphos, fDCALPHOS, fNEvents);
+	return fNEvents++;
+}
+
+/**
+ * Add the event currently stored in the channel maps of the trigger maker to the batch.
+ * The patch masks of the maker have to be the ones of the engine (SetPatchMasks), so
+ * that the events fire as in the maker.
+ * @param maker Trigger maker with filled channel maps
+ * @return Index of the event in the batch
+ * @throw BatchFullException in case the batch is already full
+ * @throw PatchMaskMismatchException in case the maker rejects other patch positions than the engine
+ */
+int TriggerBatchEngine::AddEvent(const TriggerMaker &maker) {
+	for(int category = RawPatch::kEMCALpatchGA; category <= RawPatch::kDCALpatchL0; category++)
+		if(!maker.GetPatchMask(category).HasSameRejections(fPatchMasks[TriggerMaker::GetCategoryIndex(category)]))
+			throw PatchMaskMismatchException(category);
+	return AddEvent(maker.GetEMCALChannels(), maker.GetDCALPHOSChannels());
+}
+
+/**
+ * Evaluate all events in the batch: Find the max. window amplitude for each patch
+ * category and determine the trigger bits fired.
+ */
+void TriggerBatchEngine::Process() {
+	double maxadc[kNLanes];
+	// same window positions as the gamma (2x2) and jet (16x16 and 8x8) algorithms
+	FindMaxWindow(fEMCAL, 2, 1, fEMCAL.fNRows - 1, fEMCAL.fNCols - 1, false, RawPatch::kEMCALpatchGA, maxadc);
+	SetResult(RawPatch::kEMCALpatchGA, maxadc);
+	FindMaxWindow(fDCALPHOS, 2, 1, fDCALPHOS.fNRows - 1, fDCALPHOS.fNCols - 1, false, RawPatch::kDCALpatchGA, maxadc);
+	SetResult(RawPatch::kDCALpatchGA, maxadc);
+	FindMaxWindow(fEMCAL, 16, 4, fEMCAL.fNRows - 15, fEMCAL.fNCols - 15, false, RawPatch::kEMCALpatchJE, maxadc);
+	SetResult(RawPatch::kEMCALpatchJE, maxadc);
+	FindMaxWindow(fDCALPHOS, 16, 4, fDCALPHOS.fNRows - 15, fDCALPHOS.fNCols - 15, false, RawPatch::kDCALpatchJE, maxadc);
+	SetResult(RawPatch::kDCALpatchJE, maxadc);
+	FindMaxWindow(fEMCAL, 8, 4, fEMCAL.fNRows - 8-1, fEMCAL.fNCols - 8-1, false, RawPatch::kEMCALpatchJE8x8, maxadc);
+	SetResult(RawPatch::kEMCALpatchJE8x8, maxadc);
+	FindMaxWindow(fDCALPHOS, 8, 4, fDCALPHOS.fNRows - 8-1, fDCALPHOS.fNCols - 8-1, false, RawPatch::kDCALpatchJE8x8, maxadc);
+	SetResult(RawPatch::kDCALpatchJE8x8, maxadc);
+	if(fLevel0Enabled){
+		// 2x2 windows within a TRU, as in the Level0 algorithm
+		FindMaxWindow(fEMCAL, 2, 1, fEMCAL.fNRows - 1, fEMCAL.fNCols - 1, true, RawPatch::kEMCALpatchL0, maxadc);
+		SetResult(RawPatch::kEMCALpatchL0, maxadc);
+		FindMaxWindow(fDCALPHOS, 2, 1, fDCALPHOS.fNRows - 1, fDCALPHOS.fNCols - 1, true, RawPatch::kDCALpatchL0, maxadc);
+		SetResult(RawPatch::kDCALpatchL0, maxadc);
+	} else {
+		for(int ilane = 0; ilane < kNLanes; ilane++) maxadc[ilane] = -DBL_MAX;
+		SetResult(RawPatch::kEMCALpatchL0, maxadc);
+		SetResult(RawPatch::kDCALpatchL0, maxadc);
+	}
+}
+
+/**
+ * Get the max. window amplitude of an event in the batch
+ * @param ievent Index of the event in the batch
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Max. window amplitude
+ * @throw EventIndexException in case the event is not in the batch
+ * @throw TriggerMaker::InvalidCategoryException in case of an invalid category or a Level0 category without Level0 enabled
+ */
+double TriggerBatchEngine::GetMaxADC(int ievent, int category) const {
+	return fMaxADC[GetResultIndex(ievent, category)][ievent];
+}
+
+/**
+ * Get the trigger bits fired by an event in a given patch category
+ * @param ievent Index of the event in the batch
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Trigger bits fired
+ * @throw EventIndexException in case the event is not in the batch
+ * @throw TriggerMaker::InvalidCategoryException in case of an invalid category or a Level0 category without Level0 enabled
+ */
+int TriggerBatchEngine::GetTriggerBits(int ievent, int category) const {
+	return fTriggerBits[GetResultIndex(ievent, category)][ievent];
+}
+
+/**
+ * Get the trigger bits fired by an event in any patch category
+ * @param ievent Index of the event in the batch
+ * @return Trigger bits fired
+ * @throw EventIndexException in case the event is not in the batch
+ */
+int TriggerBatchEngine::GetTriggerBits(int ievent) const {
+	if(ievent < 0 || ievent >= fNEvents) throw EventIndexException(ievent, fNEvents);
+	int result(0);
+	for(int icat = 0; icat < TriggerMaker::kNPatchCategories; icat++) result |= fTriggerBits[icat][ievent];
+	return result;
+}
+
+/**
+ * Check the arguments of the result getters
+ * @param ievent Index of the event in the batch
+ * @param category Patch category
+ * @return Index of the category in the result arrays
+ * @throw EventIndexException in case the event is not in the batch
+ * @throw TriggerMaker::InvalidCategoryException in case of an invalid category or a Level0 category without Level0 enabled
+ */
+int TriggerBatchEngine::GetResultIndex(int ievent, int category) const {
+	if(ievent < 0 || ievent >= fNEvents) throw EventIndexException(ievent, fNEvents);
+	if(!fLevel0Enabled && TriggerMaker::IsLevel0Category(category)) throw TriggerMaker::InvalidCategoryException(category);
+	return TriggerMaker::GetCategoryIndex(category);
+}
+
+/**
+ * Copy the channel map of an event into its lane of the interleaved grid
+ * @param channels Channel map of the event
+ * @param grid Interleaved grid of the detector
+ * @param lane Lane of the event
+ */
+void TriggerBatchEngine::Load(const TriggerChannelMap &channels, LaneGrid &grid, int lane) {
+	for(int irow = 0; irow < grid.fNRows; irow++)
+		for(int icol = 0; icol < grid.fNCols; icol++)
+			grid.GetCell(icol, irow)[lane] = channels.GetADC(icol, irow);
+}
+
+/**
+ * Find the max. window amplitude for all lanes. Windows start at the positions
+ * 0, step, 2*step, ... below lastrow and lastcol, and are summed row by row as
+ * in the trigger algorithms.
+ * @param grid Interleaved grid of the detector
+ * @param size Size of the window
+ * @param step Step size between window positions
+ * @param lastrow Upper limit (exclusive) of the starting row
+ * @param lastcol Upper limit (exclusive) of the starting column
+ * @param withinTRU Skip 2x2 windows crossing a TRU boundary (Level0)
+ * @param category Patch category, selecting the patch mask
+ * @param maxadc Output: max. window amplitude per lane
+ */
+void TriggerBatchEngine::FindMaxWindow(const LaneGrid &grid, int size, int step, int lastrow, int lastcol, bool withinTRU, int category, double *maxadc) const {
+	double adcsum[kNLanes];
+	const TriggerPatchMask &mask = fPatchMasks[TriggerMaker::GetCategoryIndex(category)];
+	const TriggerPatchMask *activemask = mask.HasRejections() ? &mask : NULL;
+	for(int ilane = 0; ilane < kNLanes; ilane++) maxadc[ilane] = -DBL_MAX;
+	for(int irow = 0; irow < lastrow; irow += step){
+		for(int icol = 0; icol < lastcol; icol += step){
+			if(withinTRU && !TriggerRegionMap::IsWindow2x2WithinTRU(icol, irow, grid.fNRows)) continue;
+			if(activemask && !activemask->IsAccepted(icol, irow)) continue;
+			for(int ilane = 0; ilane < kNLanes; ilane++) adcsum[ilane] = 0;
+			for(int jrow = 0; jrow < size; jrow++)
+				for(int jcol = 0; jcol < size; jcol++)
+					fKernels->fAddLanes(grid.GetCell(icol + jcol, irow + jrow), kNLanes, adcsum);
+			fKernels->fMaxLanes(adcsum, kNLanes, maxadc);
+		}
+	}
+}
+
+/**
+ * Store the max. window amplitudes of a category and derive the trigger bits.
+ * An event fires a threshold if its max. window amplitude is above it.
+ * @param category Patch category
+ * @param maxadc Max. window amplitude per lane
+ */
+void TriggerBatchEngine::SetResult(int category, const double *maxadc) {
+	int index = TriggerMaker::GetCategoryIndex(category);
+	const TriggerThresholdTable &thresholds = fTriggerSetup.GetThresholdTable(category);
+	for(int ilane = 0; ilane < kNLanes; ilane++){
+		fMaxADC[index][ilane] = maxadc[ilane];
+		int triggerBits = ilane < fNEvents ? thresholds.GetTriggerBits(maxadc[ilane]) : 0;
+		fTriggerBits[index][ilane] = triggerBits;
+	}
+}
@@ -0,0 +1,187 @@
+#ifndef TRIGGERBATCHENGINE_H
+#define TRIGGERBATCHENGINE_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "TriggerKernels.h"
+#include "TriggerMaker.h"
+#include "TriggerPatchMask.h"
+#include "TriggerSetup.h"
+
+class TriggerChannelMap;
+
+/**
+ * @class TriggerBatchEngine
+ * @brief Trigger evaluation for a batch of events in parallel
+ *
+ * The channel maps of up to kNLanes events are stored interleaved, with the event
+ * index running fastest. Each window sum is then computed for all events at once
+ * with the innermost loop running over the events, which the compiler can map on
+ * vector instructions. For each event the max. window amplitude per gamma and jet
+ * patch category (and Level0, if enabled with SetLevel0Enabled) and the trigger bits
+ * fired are determined. Window positions and summation order (sums over the FastORs of
+ * each window) are the same as in the reference finders on the channel map
+ * (GammaTriggerAlgorithm::FindPatches, JetTriggerAlgorithm::FindPatches and FindPatches8x8,
+ * Level0TriggerAlgorithm::FindPatches), so results are identical to their max. patches for
+ * the same thresholds. The TriggerMaker sums the jet patches from the 4x4 subregions, so its
+ * jet amplitudes agree only within rounding. The loops over the events use the vector
+ * kernels of the instruction set selected at construction (TriggerKernels). Patch
+ * positions rejected by the patch masks of a trigger maker (PHOS acceptance, exclusion
+ * regions) are skipped after SetPatchMasks; without it patches in the PHOS region are
+ * accepted, unlike in the TriggerMaker. Intended for large productions where only the
+ * event-level trigger decision is needed.
+ *
+ * Usage: add events with AddEvent until the batch is full (or no events are left),
+ * call Process, read the results, and call Reset before adding the next batch.
+ */
+class TriggerBatchEngine {
+public:
+	enum {
+		kNLanes = 16
+	};
+
+	class BatchFullException : public std::exception{
+	public:
+		BatchFullException() {}
+		virtual ~BatchFullException() throw() {}
+		const char *what() const throw() {
+			return "Event batch is full";
+		}
+	};
+
+	class EventIndexException : public std::exception{
+	public:
+		EventIndexException(int ievent, int nevents):
+			exception(),
+			fMessage("")
+		{
+			std::stringstream msgstream;
+			msgstream << "Event index " << ievent << " outside the batch of " << nevents << " events";
+			fMessage = msgstream.str();
+		}
+		virtual ~EventIndexException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string 			fMessage;			///< Error message
+	};
+
+	class PatchMaskMismatchException : public std::exception{
+	public:
+		PatchMaskMismatchException(int category):
+			exception(),
+			fMessage("")
+		{
+			std::stringstream msgstream;
+			msgstream << "Patch mask of the trigger maker differs from the batch engine for patch category " << category;
+			fMessage = msgstream.str();
+		}
+		virtual ~PatchMaskMismatchException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string 			fMessage;			///< Error message
+	};
+
+	TriggerBatchEngine();
+	virtual ~TriggerBatchEngine() {}
+
+	/**
+	 * Set the trigger setup (thresholds and trigger bits) used to evaluate the events
+	 * @param setup Configuration of the trigger patch finders
+	 */
+	void SetTriggerSetup(const TriggerSetup &setup) { fTriggerSetup = setup; }
+
+	/**
+	 * Use the vector kernels of an instruction set (unsupported instruction sets are replaced
+	 * by the widest supported one)
+	 * @param isa Instruction set
+	 */
+	void SetKernelISA(TriggerKernels::ISA isa) { fKernels = &TriggerKernels::GetKernels(isa); }
+
+	/**
+	 * Get the instruction set of the vector kernels in use
+	 * @return Instruction set
+	 */
+	TriggerKernels::ISA GetKernelISA() const { return fKernels->fISA; }
+
+	/**
+	 * Switch on the evaluation of the Level0 categories, as in TriggerMaker::SetLevel0Enabled
+	 * @param doEnable If true the Level0 categories are evaluated in Process
+	 */
+	void SetLevel0Enabled(bool doEnable) { fLevel0Enabled = doEnable; }
+
+	/**
+	 * Check whether the Level0 categories are evaluated
+	 * @return True if the Level0 categories are evaluated
+	 */
+	bool IsLevel0Enabled() const { return fLevel0Enabled; }
+
+	void SetPatchMasks(const TriggerMaker &maker);
+
+	void Reset();
+	int AddEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos);
+	int AddEvent(const TriggerMaker &maker);
+	void Process();
+
+	/**
+	 * Get the number of events in the current batch
+	 * @return Number of events
+	 */
+	int GetNumberOfEvents() const { return fNEvents; }
+
+	/**
+	 * Check whether the batch is full
+	 * @return True if no further event can be added
+	 */
+	bool IsFull() const { return fNEvents == kNLanes; }
+
+	double GetMaxADC(int ievent, int category) const;
+	int GetTriggerBits(int ievent, int category) const;
+	int GetTriggerBits(int ievent) const;
+
+private:
+	/**
+	 * @struct LaneGrid
+	 * @brief Channel map of a detector for all events, event index running fastest
+	 */
+	struct LaneGrid {
+		LaneGrid(int ncols, int nrows): fNCols(ncols), fNRows(nrows), fADC(ncols * nrows * kNLanes, 0.) {}
+		const double *GetCell(int col, int row) const { return &fADC[(row * fNCols + col) * kNLanes]; }
+		double *GetCell(int col, int row) { return &fADC[(row * fNCols + col) * kNLanes]; }
+
+		int						fNCols;				///< Number of columns
+		int						fNRows;				///< Number of rows
+		std::vector<double>		fADC;				///< ADC values, event index running fastest
+	};
+
+	void Load(const TriggerChannelMap &channels, LaneGrid &grid, int lane);
+	void FindMaxWindow(const LaneGrid &grid, int size, int step, int lastrow, int lastcol, bool withinTRU, int category, double *maxadc) const;
+	void SetResult(int category, const double *maxadc);
+	int GetResultIndex(int ievent, int category) const;
+
+	TriggerSetup				fTriggerSetup;										///< Trigger thresholds and bits
+	const TriggerKernels::KernelTable	*fKernels;									///< Vector kernels for the loops over the events
+	LaneGrid					fEMCAL;												///< Interleaved EMCAL channel maps
+	LaneGrid					fDCALPHOS;											///< Interleaved DCAL-PHOS channel maps
+	int							fNEvents;											///< Number of events in the batch
+	bool						fLevel0Enabled;										///< Evaluate the Level0 categories
+	TriggerPatchMask			fPatchMasks[TriggerMaker::kNPatchCategories];		///< Accepted window positions per category
+	double						fMaxADC[TriggerMaker::kNPatchCategories][kNLanes];	///< Max. window amplitude per category and event
+	int							fTriggerBits[TriggerMaker::kNPatchCategories][kNLanes];	///< Trigger bits per category and event
+};
+
+#endif /* TRIGGERBATCHENGINE_H */
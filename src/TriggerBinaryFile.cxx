@@ -0,0 +1,84 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "TriggerBinaryFile.h"
+
+namespace {
+const uint32_t kByteOrderMarker = 0x01020304;
+}
+
+/**
+ * Initialize the signature at the beginning of a file header
+ * @param signature Signature to be initialized
+ * @param format Format of the file
+ */
+void TriggerBinaryFile::InitSignature(FileSignature &signature, const FileFormat &format) {
+	memcpy(signature.fMagic, format.fMagic, sizeof(signature.fMagic));
+	signature.fVersion = format.fVersion;
+	signature.fByteOrder = kByteOrderMarker;
+}
+
+/**
+ * Map a file read-only into memory and check its signature. The mapping is shared,
+ * so processes forked after mapping the file read the same pages.
+ * @param filename Name of the file
+ * @param format Expected format of the file
+ * @param headersize Size of the file header (starting with the signature)
+ * @param filesize Output: Size of the file and of the mapping
+ * @return Start of the mapping (to be released with UnmapFile)
+ * @throw FileIOException in case the file cannot be mapped, is shorter than the header or has another format
+ */
+void *TriggerBinaryFile::MapFile(const std::string &filename, const FileFormat &format, size_t headersize, size_t &filesize) {
+	int fd = open(filename.c_str(), O_RDONLY);
+	if(fd < 0) throw FileIOException(format.fType, filename, "cannot open file for reading");
+	struct stat filestat;
+	if(fstat(fd, &filestat) || filestat.st_size < static_cast<off_t>(headersize)){
+		close(fd);
+		throw FileIOException(format.fType, filename, "unknown file type");
+	}
+	void *mapping = mmap(NULL, filestat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(mapping == MAP_FAILED) throw FileIOException(format.fType, filename, "cannot map file");
+	filesize = filestat.st_size;
+
+	const FileSignature &signature = *static_cast<const FileSignature *>(mapping);
+	std::string reason;
+	if(memcmp(signature.fMagic, format.fMagic, sizeof(signature.fMagic))) reason = "unknown file type";
+	else if(signature.fVersion != format.fVersion) reason = "unsupported version";
+	else if(signature.fByteOrder != kByteOrderMarker) reason = "byte order mismatch";
+	if(!reason.empty()){
+		UnmapFile(mapping, filesize);
+		throw FileIOException(format.fType, filename, reason);
+	}
+	return mapping;
+}
+
+/**
+ * Release a mapping obtained with MapFile
+ * @param mapping Start of the mapping
+ * @param filesize Size of the mapping
+ */
+void TriggerBinaryFile::UnmapFile(void *mapping, size_t filesize) {
+	munmap(mapping, filesize);
+}
@@ -0,0 +1,73 @@
+#ifndef TRIGGERBINARYFILE_H
+#define TRIGGERBINARYFILE_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <cstddef>
+#include <exception>
+#include <stdint.h>
+#include <string>
+
+/**
+ * @class TriggerBinaryFile
+ * @brief Common parts of the binary files (event files, bad channel files)
+ *
+ * Each file starts with a signature: magic identifying the file type, format version
+ * and a marker of the byte order of the machine writing the file. Files are read
+ * through a read-only memory mapping of the whole file (MapFile), which is only
+ * returned if the signature matches the file format. Errors are reported with a
+ * FileIOException naming the file type.
+ */
+class TriggerBinaryFile {
+public:
+	class FileIOException : public std::exception{
+	public:
+		FileIOException(const std::string &filetype, const std::string &filename, const std::string &reason):
+			exception(),
+			fMessage("")
+		{
+			fMessage = filetype + " " + filename + ": " + reason;
+		}
+		virtual ~FileIOException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string				fMessage;			///< Error message
+	};
+
+	/**
+	 * @struct FileFormat
+	 * @brief Identification of a file format
+	 */
+	struct FileFormat {
+		const char				*fType;				///< Name of the file type in error messages
+		char					fMagic[8];			///< File type identifier
+		uint32_t				fVersion;			///< Format version
+	};
+
+	TriggerBinaryFile() {}
+	virtual ~TriggerBinaryFile() {}
+
+protected:
+	/**
+	 * @struct FileSignature
+	 * @brief Beginning of the header of each file
+	 */
+	struct FileSignature {
+		char					fMagic[8];			///< File type identifier
+		uint32_t				fVersion;			///< Format version
+		uint32_t				fByteOrder;			///< Byte order marker
+	};
+
+	static void InitSignature(FileSignature &signature, const FileFormat &format);
+	static void *MapFile(const std::string &filename, const FileFormat &format, size_t headersize, size_t &filesize);
+	static void UnmapFile(void *mapping, size_t filesize);
+};
+
+#endif /* TRIGGERBINARYFILE_H */
@@ -18,6 +18,7 @@
  ********************************************************************************/
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 
 #include "TriggerChannelMap.h"
 
@@ -25,14 +26,24 @@
  * Constructor, initializing channel map with the dimensions needed
  * @param ncols Number of columns
  * @param nrows Number of rows
+ * @param layout Storage layout of the amplitudes
  */
-TriggerChannelMap::TriggerChannelMap(int ncols, int nrows):
+TriggerChannelMap::TriggerChannelMap(int ncols, int nrows, Layout layout):
     fNADCCols(ncols),
     fNADCRows(nrows),
-    fADC(NULL)
+    fNTileCols((ncols + kSubregionSize - 1) / kSubregionSize),
+    fArraySize(0),
+    fLayout(layout),
+    fADC(NULL),
+    fRowOffsets(nrows, 0),
+    fColOffsets(ncols, 0),
+    fHasOccupancy(ncols <= 64 * kSubregionSize),
+    fOccupancy((nrows + kSubregionSize - 1) / kSubregionSize, 0)
 {
-  fADC = new double[fNADCCols * fNADCRows];
-  memset(fADC, 0, sizeof(double) * fNADCCols * fNADCRows);
+  fArraySize = fLayout == kTiled ? fNTileCols * static_cast<int>(fOccupancy.size()) * kTileSize : fNADCCols * fNADCRows;
+  fADC = new double[fArraySize];
+  memset(fADC, 0, sizeof(double) * fArraySize);
+  UpdateOffsets();
 }
 
 /**
@@ -52,6 +63,7 @@ void TriggerChannelMap::SetADC(int col, int row, double adc) {
   if(row >= fNADCRows || col >= fNADCCols)
 	  throw BoundaryException(row, col, fNADCRows, fNADCCols);
   fADC[GetIndexInArray(col, row)] = adc;
+  SetOccupied(col, row);
 }
 
 /**
@@ -64,13 +76,58 @@ void TriggerChannelMap::AddADC(int col, int row, double adc) {
   if(row >= fNADCRows || col >= fNADCCols)
 	  throw BoundaryException(row, col, fNADCRows, fNADCCols);
   fADC[GetIndexInArray(col, row)] += adc;
+  SetOccupied(col, row);
 }
 
 /**
  * Set the ADC values stored in the 2D map again to 0
  */
 void TriggerChannelMap::Reset() {
-  memset(fADC, 0, sizeof(double) * fNADCCols * fNADCRows);
+  memset(fADC, 0, sizeof(double) * fArraySize);
+  std::fill(fOccupancy.begin(), fOccupancy.end(), 0);
+}
+
+/**
+ * Change the storage layout of the amplitudes, keeping the content of the map
+ * @param layout New layout
+ */
+void TriggerChannelMap::SetLayout(Layout layout) {
+  if(layout == fLayout) return;
+  std::vector<double> content(fNADCCols * fNADCRows);
+  for(int irow = 0; irow < fNADCRows; irow++) GetRow(irow, &content[irow * fNADCCols]);
+  delete[] fADC;
+  fLayout = layout;
+  fArraySize = fLayout == kTiled ? fNTileCols * static_cast<int>(fOccupancy.size()) * kTileSize : fNADCCols * fNADCRows;
+  fADC = new double[fArraySize];
+  memset(fADC, 0, sizeof(double) * fArraySize);
+  UpdateOffsets();
+  for(int irow = 0; irow < fNADCRows; irow++)
+    for(int icol = 0; icol < fNADCCols; icol++) fADC[GetIndexInArray(icol, irow)] = content[irow * fNADCCols + icol];
+}
+
+/**
+ * Tabulate the offsets of rows and columns in the amplitude array for the current layout
+ */
+void TriggerChannelMap::UpdateOffsets() {
+  for(int irow = 0; irow < fNADCRows; irow++)
+    fRowOffsets[irow] = fLayout == kTiled ? (irow / kSubregionSize) * fNTileCols * kTileSize + (irow % kSubregionSize) * kSubregionSize : irow * fNADCCols;
+  for(int icol = 0; icol < fNADCCols; icol++)
+    fColOffsets[icol] = fLayout == kTiled ? (icol / kSubregionSize) * kTileSize + icol % kSubregionSize : icol;
+}
+
+/**
+ * Copy the amplitudes of a row into a buffer, for any layout (no boundary check)
+ * @param row Row in the map
+ * @param buffer Output buffer, with space for the number of columns of the map
+ */
+void TriggerChannelMap::GetRow(int row, double *buffer) const {
+  if(fLayout == kRowMajor){
+    memcpy(buffer, fADC + fRowOffsets[row], sizeof(double) * fNADCCols);
+    return;
+  }
+  const double *tilerow = fADC + fRowOffsets[row];
+  for(int icol = 0; icol < fNADCCols; icol++)
+    buffer[icol] = tilerow[fColOffsets[icol]];
 }
 
 /**
@@ -84,3 +141,18 @@ double TriggerChannelMap::GetADC(int col, int row) const {
 	  throw BoundaryException(row, col, fNADCRows, fNADCCols);
   return fADC[GetIndexInArray(col, row)];
 }
+
+/**
+ * Get the occupancy of the subregions covering a row range. Bit i of the mask is set
+ * if any subregion in column i / 4 covering the rows was modified since the last reset.
+ * In case the occupancy is not tracked all bits are set.
+ * @param rowmin First row of the range
+ * @param rowmax Last row of the range
+ * @return Occupancy mask of the subregion columns
+ */
+unsigned long long TriggerChannelMap::GetOccupancyMask(int rowmin, int rowmax) const {
+  if(!fHasOccupancy) return ~0ULL;
+  unsigned long long mask(0);
+  for(int srow = rowmin / kSubregionSize; srow <= rowmax / kSubregionSize; srow++) mask |= fOccupancy[srow];
+  return mask;
+}
@@ -10,9 +10,36 @@
 #include <exception>
 #include <sstream>
 #include <string>
+#include <vector>
 
+/**
+ * @class TriggerChannelMap
+ * @brief 2D map of trigger channel amplitudes
+ *
+ * Besides the amplitudes the map keeps track of the 4x4 subregions which were
+ * modified since the last reset (occupancy). Patch finders can use the occupancy
+ * to skip windows which only cover untouched (zero) channels.
+ *
+ * The amplitudes are stored either row by row (kRowMajor) or in tiles of 4x4 channels,
+ * each tile (subregion) contiguous and row by row inside (kTiled), so that subregion
+ * sums read 16 consecutive amplitudes. Accessors by column and row (GetADC, GetRow) are
+ * independent of the layout, direct access to the storage is GetRowData (row-major
+ * layout) or GetTileData (tiled layout). The position of a channel in the storage is the
+ * sum of a row offset and a column offset, both tabulated for the layout of the map, so
+ * the accessors do not depend on the layout at runtime.
+ */
 class TriggerChannelMap{
 public:
+	enum {
+		kSubregionSize = 4,
+		kTileSize = kSubregionSize * kSubregionSize
+	};
+
+	enum Layout {
+		kRowMajor = 0,
+		kTiled
+	};
+
 	class BoundaryException : public std::exception{
 	public:
 		BoundaryException():
@@ -54,11 +81,39 @@ public:
 		int						fNCol;				///< Number of cols in the channel map
 	};
 
-	TriggerChannelMap(int cols, int rows);
+	class LayoutException : public std::exception{
+	public:
+		LayoutException(Layout layout):
+			exception(),
+			fMessage(""),
+			fLayout(layout)
+		{
+			fMessage = fLayout == kTiled ? "Direct row access not possible in the tiled layout" : "Direct tile access not possible in the row-major layout";
+		}
+		virtual ~LayoutException() throw() {}
+
+		Layout GetLayout() const throw() { return fLayout; }
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string 			fMessage;			///< Error message
+		Layout					fLayout;			///< Layout of the channel map
+	};
+
+	TriggerChannelMap(int cols, int rows, Layout layout = kRowMajor);
 	virtual ~TriggerChannelMap();
 
 	void Reset();
 
+	void SetLayout(Layout layout);
+	/**
+	 * Get the storage layout of the amplitudes
+	 * @return Layout of the map
+	 */
+	Layout GetLayout() const { return fLayout; }
+
 	void SetADC(int col, int row, double adc);
 	void AddADC(int col, int row, double adc);
 	double GetADC(int col, int row) const;
@@ -73,15 +128,77 @@ public:
 	 */
 	int GetNumberOfRows() const { return fNADCRows; }
 
+	unsigned long long GetOccupancyMask(int rowmin, int rowmax) const;
+
+	/**
+	 * Get read access to the amplitudes of a row, for patch finders scanning the map
+	 * (no boundary check). Only valid for the row-major layout.
+	 * @param row Row in the map
+	 * @return Pointer to the amplitude of the first column of the row
+	 * @throw LayoutException in case the map has the tiled layout
+	 */
+	const double *GetRowData(int row) const {
+		if(fLayout != kRowMajor) throw LayoutException(fLayout);
+		return fADC + fRowOffsets[row];
+	}
+
+	/**
+	 * Get read access to the 16 amplitudes of a 4x4 tile, row by row (no boundary check).
+	 * Only valid for the tiled layout. Channels of tiles at the border outside of the map
+	 * are 0.
+	 * @param scol Subregion column of the tile
+	 * @param srow Subregion row of the tile
+	 * @return Pointer to the amplitude of the first channel of the tile
+	 * @throw LayoutException in case the map has the row-major layout
+	 */
+	const double *GetTileData(int scol, int srow) const {
+		if(fLayout != kTiled) throw LayoutException(fLayout);
+		return fADC + (srow * fNTileCols + scol) * kTileSize;
+	}
+
+	void GetRow(int row, double *buffer) const;
+
+	/**
+	 * Check whether any subregion in a column range is set in an occupancy mask
+	 * @param mask Occupancy mask (one bit per subregion column)
+	 * @param colmin First column of the range
+	 * @param colmax Last column of the range
+	 * @return True if at least one subregion covering the column range is occupied
+	 */
+	static bool IsOccupied(unsigned long long mask, int colmin, int colmax) {
+		int scolmin = colmin / kSubregionSize, nscol = colmax / kSubregionSize - scolmin + 1;
+		unsigned long long range = nscol >= 64 ? ~0ULL : ((1ULL << nscol) - 1);
+		return (mask >> scolmin) & range;
+	}
+
 protected:
+	/**
+	 * Mark the subregion containing a position as occupied
+	 * @param col Column of the position
+	 * @param row Row of the position
+	 */
+	void SetOccupied(int col, int row) {
+		if(fHasOccupancy) fOccupancy[row / kSubregionSize] |= 1ULL << (col / kSubregionSize);
+	}
 
-	inline int GetIndexInArray(int col, int row) const;
+	/**
+	 * Get the position of a channel in the amplitude array (no boundary check)
+	 * @param col Column of the channel
+	 * @param row Row of the channel
+	 * @return Index in the amplitude array
+	 */
+	int GetIndexInArray(int col, int row) const { return fRowOffsets[row] + fColOffsets[col]; }
+	void UpdateOffsets();
 	int                     fNADCCols;      ///< Number of columns
 	int                     fNADCRows;      ///< Number of rows
+	int                     fNTileCols;     ///< Number of tile columns (subregion columns)
+	int                     fArraySize;     ///< Size of the amplitude array (padded to full tiles in the tiled layout)
+	Layout                  fLayout;        ///< Storage layout of the amplitudes
 	double                  *fADC;          ///< Array of Trigger ADC values
+	std::vector<int>        fRowOffsets;    ///< Offset of a row in the amplitude array, for the layout
+	std::vector<int>        fColOffsets;    ///< Offset of a column in the amplitude array, for the layout
+	bool                    fHasOccupancy;  ///< Occupancy tracked (max. 64 subregions in a row)
+	std::vector<unsigned long long> fOccupancy;  ///< Bit mask of modified subregions, per row of subregions
 };
 
-int TriggerChannelMap::GetIndexInArray(int col, int row) const {
-	return fNADCCols * row + col;
-}
 #endif /* TRIGGERCHANNELMAP_H */
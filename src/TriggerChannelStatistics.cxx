@@ -0,0 +1,219 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+#include <cmath>
+
+#include "TriggerChannelMap.h"
+#include "TriggerChannelStatistics.h"
+#include "TriggerMaker.h"
+
+/**
+ * Constructor, initializing empty statistics for EMCAL (48x64 channels) and DCAL-PHOS (48x40 channels)
+ * @param occupancyThreshold Amplitude above which a channel counts as occupied
+ */
+TriggerChannelStatistics::TriggerChannelStatistics(double occupancyThreshold):
+	fOccupancyThreshold(occupancyThreshold),
+	fEMCAL(48, 64),
+	fDCALPHOS(48, 40),
+	fRow(48, 0.),
+	fNEvents(0)
+{
+}
+
+/**
+ * Add the channel amplitudes of an event
+ * @param emcal EMCAL channel map of the event
+ * @param dcalphos DCAL-PHOS channel map of the event
+ */
+void TriggerChannelStatistics::AddEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos) {
+	AddDetector(emcal, fEMCAL);
+	AddDetector(dcalphos, fDCALPHOS);
+	fNEvents++;
+}
+
+/**
+ * Add the channel amplitudes of the event currently stored in the channel maps of the trigger maker
+ * @param maker Trigger maker with filled channel maps
+ */
+void TriggerChannelStatistics::AddEvent(const TriggerMaker &maker) {
+	AddEvent(maker.GetEMCALChannels(), maker.GetDCALPHOSChannels());
+}
+
+/**
+ * Add the statistics accumulated in parallel. The occupancy threshold of this object is kept.
+ * @param other Statistics to be added
+ */
+void TriggerChannelStatistics::Merge(const TriggerChannelStatistics &other) {
+	ChannelGrid *grids[2] = {&fEMCAL, &fDCALPHOS};
+	const ChannelGrid *othergrids[2] = {&other.fEMCAL, &other.fDCALPHOS};
+	for(int idet = 0; idet < 2; idet++){
+		for(size_t ichannel = 0; ichannel < grids[idet]->fNOccupied.size(); ichannel++){
+			grids[idet]->fNOccupied[ichannel] += othergrids[idet]->fNOccupied[ichannel];
+			grids[idet]->fSumADC[ichannel] += othergrids[idet]->fSumADC[ichannel];
+			grids[idet]->fSumADC2[ichannel] += othergrids[idet]->fSumADC2[ichannel];
+		}
+	}
+	fNEvents += other.fNEvents;
+}
+
+/**
+ * Remove all accumulated statistics
+ */
+void TriggerChannelStatistics::Reset() {
+	ChannelGrid *grids[2] = {&fEMCAL, &fDCALPHOS};
+	for(int idet = 0; idet < 2; idet++){
+		std::fill(grids[idet]->fNOccupied.begin(), grids[idet]->fNOccupied.end(), 0);
+		std::fill(grids[idet]->fSumADC.begin(), grids[idet]->fSumADC.end(), 0.);
+		std::fill(grids[idet]->fSumADC2.begin(), grids[idet]->fSumADC2.end(), 0.);
+	}
+	fNEvents = 0;
+}
+
+/**
+ * Get the fraction of events in which a channel was occupied (no boundary check)
+ * @param isDCALPHOS If true the DCAL-PHOS channel, otherwise the EMCAL channel
+ * @param col Column of the channel
+ * @param row Row of the channel
+ * @return Occupancy (0 if no event was added)
+ */
+double TriggerChannelStatistics::GetOccupancy(bool isDCALPHOS, int col, int row) const {
+	const ChannelGrid &grid = isDCALPHOS ? fDCALPHOS : fEMCAL;
+	return fNEvents ? static_cast<double>(grid.fNOccupied[row * grid.fNCols + col]) / fNEvents : 0.;
+}
+
+/**
+ * Get the mean amplitude of a channel over all events (no boundary check)
+ * @param isDCALPHOS If true the DCAL-PHOS channel, otherwise the EMCAL channel
+ * @param col Column of the channel
+ * @param row Row of the channel
+ * @return Mean amplitude (0 if no event was added)
+ */
+double TriggerChannelStatistics::GetMeanADC(bool isDCALPHOS, int col, int row) const {
+	const ChannelGrid &grid = isDCALPHOS ? fDCALPHOS : fEMCAL;
+	return fNEvents ? grid.fSumADC[row * grid.fNCols + col] / fNEvents : 0.;
+}
+
+/**
+ * Get the standard deviation of the amplitude of a channel over all events (no boundary check)
+ * @param isDCALPHOS If true the DCAL-PHOS channel, otherwise the EMCAL channel
+ * @param col Column of the channel
+ * @param row Row of the channel
+ * @return Standard deviation of the amplitude (0 if no event was added)
+ */
+double TriggerChannelStatistics::GetRMSADC(bool isDCALPHOS, int col, int row) const {
+	if(!fNEvents) return 0.;
+	const ChannelGrid &grid = isDCALPHOS ? fDCALPHOS : fEMCAL;
+	double mean = grid.fSumADC[row * grid.fNCols + col] / fNEvents;
+	return std::sqrt(std::max(grid.fSumADC2[row * grid.fNCols + col] / fNEvents - mean * mean, 0.));
+}
+
+/**
+ * Find the hot channels of a detector: channels with occupancy or mean amplitude above the
+ * median of all channels of the detector by more than nsigma times the spread. The spread is
+ * the robust standard deviation (1.4826 x median absolute deviation), but at least the
+ * statistical uncertainty of the median channel (binomial for the occupancy, standard error
+ * of the mean for the amplitude).
+ * @param isDCALPHOS If true the DCAL-PHOS channels, otherwise the EMCAL channels
+ * @param nsigma Number of standard deviations above the median for a channel to be hot
+ * @return Hot channels, row by row (empty if no event was added)
+ */
+std::vector<TriggerBadChannelContainer::TriggerChannelPosition> TriggerChannelStatistics::FindHotChannels(bool isDCALPHOS, double nsigma) const {
+	std::vector<TriggerBadChannelContainer::TriggerChannelPosition> result;
+	if(!fNEvents) return result;
+	const ChannelGrid &grid = isDCALPHOS ? fDCALPHOS : fEMCAL;
+	std::vector<double> occupancy, meanadc, meanerror;
+	for(int row = 0; row < grid.fNRows; row++){
+		for(int col = 0; col < grid.fNCols; col++){
+			occupancy.push_back(GetOccupancy(isDCALPHOS, col, row));
+			meanadc.push_back(GetMeanADC(isDCALPHOS, col, row));
+			meanerror.push_back(GetRMSADC(isDCALPHOS, col, row) / std::sqrt(static_cast<double>(fNEvents)));
+		}
+	}
+	double occupancyMedian(0), occupancySpread(0), adcMedian(0), adcSpread(0), errorMedian(0), errorSpread(0);
+	GetMedianAndSpread(occupancy, occupancyMedian, occupancySpread);
+	GetMedianAndSpread(meanadc, adcMedian, adcSpread);
+	GetMedianAndSpread(meanerror, errorMedian, errorSpread);
+	occupancySpread = std::max(occupancySpread, std::max(std::sqrt(occupancyMedian * (1. - occupancyMedian) / fNEvents), 1. / fNEvents));
+	adcSpread = std::max(adcSpread, errorMedian);
+
+	for(int row = 0; row < grid.fNRows; row++){
+		for(int col = 0; col < grid.fNCols; col++){
+			int index = row * grid.fNCols + col;
+			bool hotOccupancy = occupancy[index] - occupancyMedian > nsigma * occupancySpread,
+					hotADC = adcSpread > 0. && meanadc[index] - adcMedian > nsigma * adcSpread;
+			if(hotOccupancy || hotADC) result.push_back(TriggerBadChannelContainer::TriggerChannelPosition(col, row));
+		}
+	}
+	return result;
+}
+
+/**
+ * Add the hot channels of EMCAL and DCAL-PHOS to the bad channels of a trigger maker
+ * @param maker Trigger maker
+ * @param nsigma Number of standard deviations above the median for a channel to be hot
+ */
+void TriggerChannelStatistics::AddHotChannels(TriggerMaker &maker, double nsigma) const {
+	std::vector<TriggerBadChannelContainer::TriggerChannelPosition> hotchannels = FindHotChannels(false, nsigma);
+	for(std::vector<TriggerBadChannelContainer::TriggerChannelPosition>::const_iterator channeliter = hotchannels.begin(); channeliter != hotchannels.end(); ++channeliter)
+		maker.AddBadChannelEMCAL(channeliter->GetCol(), channeliter->GetRow());
+	hotchannels = FindHotChannels(true, nsigma);
+	for(std::vector<TriggerBadChannelContainer::TriggerChannelPosition>::const_iterator channeliter = hotchannels.begin(); channeliter != hotchannels.end(); ++channeliter)
+		maker.AddBadChannelDCALPHOS(channeliter->GetCol(), channeliter->GetRow());
+}
+
+/**
+ * Accumulate the amplitudes of a detector. Subregions not touched since the last reset of the
+ * channel map are skipped in case they cannot be occupied (threshold not negative).
+ * @param channels Channel map of the detector
+ * @param grid Statistics of the detector
+ */
+void TriggerChannelStatistics::AddDetector(const TriggerChannelMap &channels, ChannelGrid &grid) {
+	const bool sparse = fOccupancyThreshold >= 0.;
+	fRow.resize(grid.fNCols);
+	for(int row = 0; row < grid.fNRows; row++){
+		unsigned long long occupancy = sparse ? channels.GetOccupancyMask(row, row) : ~0ULL;
+		if(!occupancy) continue;
+		channels.GetRow(row, &fRow[0]);
+		int index = row * grid.fNCols;
+		for(int col = 0; col < grid.fNCols; col++, index++){
+			if(!TriggerChannelMap::IsOccupied(occupancy, col, col)) continue;
+			double adc = fRow[col];
+			if(adc > fOccupancyThreshold) grid.fNOccupied[index]++;
+			grid.fSumADC[index] += adc;
+			grid.fSumADC2[index] += adc * adc;
+		}
+	}
+}
+
+/**
+ * Get the median and the robust standard deviation (1.4826 x median absolute deviation) of a set of values
+ * @param values Values (copied, as they are reordered)
+ * @param median Output: median
+ * @param spread Output: robust standard deviation
+ */
+void TriggerChannelStatistics::GetMedianAndSpread(std::vector<double> values, double &median, double &spread) {
+	median = spread = 0.;
+	if(values.empty()) return;
+	size_t halfsize = values.size() / 2;
+	std::nth_element(values.begin(), values.begin() + halfsize, values.end());
+	median = values[halfsize];
+	for(std::vector<double>::iterator valueiter = values.begin(); valueiter != values.end(); ++valueiter) *valueiter = std::fabs(*valueiter - median);
+	std::nth_element(values.begin(), values.begin() + halfsize, values.end());
+	spread = 1.4826 * values[halfsize];
+}
@@ -0,0 +1,91 @@
+#ifndef TRIGGERCHANNELSTATISTICS_H
+#define TRIGGERCHANNELSTATISTICS_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <vector>
+
+#include "TriggerBadChannelContainer.h"
+
+class TriggerChannelMap;
+class TriggerMaker;
+
+/**
+ * @class TriggerChannelStatistics
+ * @brief Occupancy and mean amplitude per FastOR accumulated over a run, with hot channel detection
+ *
+ * For every FastOR of the EMCAL and the DCAL-PHOS the number of events with an amplitude
+ * above the occupancy threshold and the sum and sum of squares of the amplitude are
+ * accumulated, so the memory is constant and statistics filled in parallel (e.g. one per
+ * thread) are combined with Merge.
+ *
+ * Hot (noisy) channels are found as outliers in occupancy or mean amplitude with respect
+ * to the other channels of the same detector: a channel is hot if its value is above the
+ * median by more than nsigma times the robust spread (1.4826 x median absolute deviation).
+ * The spread is at least the statistical uncertainty expected for the number of events,
+ * so channels are not flagged from fluctuations when most channels have identical values.
+ */
+class TriggerChannelStatistics {
+public:
+	TriggerChannelStatistics(double occupancyThreshold = 0.);
+	virtual ~TriggerChannelStatistics() {}
+
+	void AddEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos);
+	void AddEvent(const TriggerMaker &maker);
+	void Merge(const TriggerChannelStatistics &other);
+	void Reset();
+
+	/**
+	 * Get the number of events added
+	 * @return Number of events
+	 */
+	unsigned long GetNumberOfEvents() const { return fNEvents; }
+	/**
+	 * Get the amplitude above which a channel counts as occupied
+	 * @return Occupancy threshold
+	 */
+	double GetOccupancyThreshold() const { return fOccupancyThreshold; }
+
+	double GetOccupancy(bool isDCALPHOS, int col, int row) const;
+	double GetMeanADC(bool isDCALPHOS, int col, int row) const;
+	double GetRMSADC(bool isDCALPHOS, int col, int row) const;
+
+	std::vector<TriggerBadChannelContainer::TriggerChannelPosition> FindHotChannels(bool isDCALPHOS, double nsigma = 5.) const;
+	void AddHotChannels(TriggerMaker &maker, double nsigma = 5.) const;
+
+private:
+	/**
+	 * @struct ChannelGrid
+	 * @brief Accumulated values of all channels of a detector, row by row
+	 */
+	struct ChannelGrid {
+		ChannelGrid(int ncols, int nrows):
+			fNCols(ncols),
+			fNRows(nrows),
+			fNOccupied(ncols * nrows, 0),
+			fSumADC(ncols * nrows, 0.),
+			fSumADC2(ncols * nrows, 0.)
+		{}
+
+		int							fNCols;				///< Number of columns
+		int							fNRows;				///< Number of rows
+		std::vector<unsigned long>	fNOccupied;			///< Number of events with the channel occupied
+		std::vector<double>			fSumADC;			///< Sum of the amplitudes
+		std::vector<double>			fSumADC2;			///< Sum of the squared amplitudes
+	};
+
+	void AddDetector(const TriggerChannelMap &channels, ChannelGrid &grid);
+	static void GetMedianAndSpread(std::vector<double> values, double &median, double &spread);
+
+	double						fOccupancyThreshold;		///< Amplitude above which a channel counts as occupied
+	ChannelGrid					fEMCAL;						///< Statistics of the EMCAL channels
+	ChannelGrid					fDCALPHOS;					///< Statistics of the DCAL-PHOS channels
+	std::vector<double>			fRow;						///< Buffer for a row of the channel map
+	unsigned long				fNEvents;					///< Number of events added
+};
+
+#endif /* TRIGGERCHANNELSTATISTICS_H */
@@ -0,0 +1,182 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <cmath>
+
+#include "TriggerBadChannelContainer.h"
+#include "TriggerChannelMap.h"
+#include "TriggerDigitizer.h"
+#include "TriggerRandom.h"
+
+/**
+ * Constructor, initializing the parameters of all FastORs with gain 1,
+ * no pedestal and no noise, and the energy resolution with no smearing
+ * @param ncols Number of columns of the channel map
+ * @param nrows Number of rows of the channel map
+ */
+TriggerDigitizer::TriggerDigitizer(int ncols, int nrows):
+	fNCols(ncols),
+	fNRows(nrows),
+	fGain(ncols * nrows, 1.),
+	fPedestal(ncols * nrows, 0.),
+	fNoise(ncols * nrows, 0.),
+	fStochasticTerm(0.),
+	fConstantTerm(0.),
+	fRoundToInteger(false)
+{
+}
+
+/**
+ * Set the gain of all FastORs
+ * @param gain Gain in ADC counts per energy unit
+ */
+void TriggerDigitizer::SetGain(double gain) {
+	fGain.assign(fGain.size(), gain);
+}
+
+/**
+ * Set the gain of a FastOR
+ * @param col Column of the FastOR
+ * @param row Row of the FastOR
+ * @param gain Gain in ADC counts per energy unit
+ * @throw TriggerChannelMap::BoundaryException in case the position is outside the channel map
+ */
+void TriggerDigitizer::SetGain(int col, int row, double gain) {
+	fGain[GetIndex(col, row)] = gain;
+}
+
+/**
+ * Set the pedestal of all FastORs
+ * @param pedestal Pedestal in ADC counts
+ */
+void TriggerDigitizer::SetPedestal(double pedestal) {
+	fPedestal.assign(fPedestal.size(), pedestal);
+}
+
+/**
+ * Set the pedestal of a FastOR
+ * @param col Column of the FastOR
+ * @param row Row of the FastOR
+ * @param pedestal Pedestal in ADC counts
+ * @throw TriggerChannelMap::BoundaryException in case the position is outside the channel map
+ */
+void TriggerDigitizer::SetPedestal(int col, int row, double pedestal) {
+	fPedestal[GetIndex(col, row)] = pedestal;
+}
+
+/**
+ * Set the noise of all FastORs
+ * @param noise Width of the Gaussian noise in ADC counts
+ */
+void TriggerDigitizer::SetNoise(double noise) {
+	fNoise.assign(fNoise.size(), noise);
+}
+
+/**
+ * Set the noise of a FastOR
+ * @param col Column of the FastOR
+ * @param row Row of the FastOR
+ * @param noise Width of the Gaussian noise in ADC counts
+ * @throw TriggerChannelMap::BoundaryException in case the position is outside the channel map
+ */
+void TriggerDigitizer::SetNoise(int col, int row, double noise) {
+	fNoise[GetIndex(col, row)] = noise;
+}
+
+/**
+ * Get the gain of a FastOR
+ * @param col Column of the FastOR
+ * @param row Row of the FastOR
+ * @return Gain in ADC counts per energy unit
+ * @throw TriggerChannelMap::BoundaryException in case the position is outside the channel map
+ */
+double TriggerDigitizer::GetGain(int col, int row) const {
+	return fGain[GetIndex(col, row)];
+}
+
+/**
+ * Get the pedestal of a FastOR
+ * @param col Column of the FastOR
+ * @param row Row of the FastOR
+ * @return Pedestal in ADC counts
+ * @throw TriggerChannelMap::BoundaryException in case the position is outside the channel map
+ */
+double TriggerDigitizer::GetPedestal(int col, int row) const {
+	return fPedestal[GetIndex(col, row)];
+}
+
+/**
+ * Get the noise of a FastOR
+ * @param col Column of the FastOR
+ * @param row Row of the FastOR
+ * @return Width of the Gaussian noise in ADC counts
+ * @throw TriggerChannelMap::BoundaryException in case the position is outside the channel map
+ */
+double TriggerDigitizer::GetNoise(int col, int row) const {
+	return fNoise[GetIndex(col, row)];
+}
+
+/**
+ * Convert the energies in the channel map into ADC amplitudes. Each FastOR uses the
+ * random numbers at its channel index in two streams (resolution and noise) derived
+ * from seed and stream, so the result is reproducible for a given seed. FastORs without
+ * energy, pedestal and noise are not modified. Bad channels are not modified.
+ * @param channels Channel map filled with the energy deposits, converted in place
+ * @param seed Seed of the event, e.g. the event number
+ * @param stream Stream index separating detectors using the same event seed
+ * @param badchannels Optional list of bad channels
+ * @throw TriggerChannelMap::BoundaryException in case the size of the channel map doesn't match
+ */
+void TriggerDigitizer::Digitize(TriggerChannelMap &channels, uint64_t seed, uint64_t stream, const TriggerBadChannelContainer *badchannels) const {
+	if(channels.GetNumberOfCols() != fNCols || channels.GetNumberOfRows() != fNRows)
+		throw TriggerChannelMap::BoundaryException(channels.GetNumberOfRows(), channels.GetNumberOfCols(), fNRows, fNCols);
+
+	TriggerRandom resolution(seed, 2 * stream), noise(seed, 2 * stream + 1);
+	for(int row = 0; row < fNRows; row++){
+		for(int col = 0; col < fNCols; col++){
+			int index = row * fNCols + col;
+			if(badchannels && badchannels->HasChannel(col, row)) continue;
+			double energy = channels.GetADC(col, row);
+			if(energy == 0. && fPedestal[index] == 0. && fNoise[index] == 0.) continue;
+
+			// energy resolution
+			if(energy > 0. && (fStochasticTerm || fConstantTerm)){
+				double sigma = std::sqrt(fStochasticTerm * fStochasticTerm / energy + fConstantTerm * fConstantTerm);
+				energy *= 1. + sigma * resolution.Gaus(index);
+			}
+
+			double adc = fGain[index] * energy + fPedestal[index];
+			if(fNoise[index]) adc += fNoise[index] * noise.Gaus(index);
+			if(fRoundToInteger) adc = adc > 0. ? std::floor(adc + 0.5) : 0.;
+			channels.SetADC(col, row, adc);
+		}
+	}
+}
+
+/**
+ * Get the index of a FastOR in the parameter arrays
+ * @param col Column of the FastOR
+ * @param row Row of the FastOR
+ * @return Index in the parameter arrays
+ * @throw TriggerChannelMap::BoundaryException in case the position is outside the channel map
+ */
+int TriggerDigitizer::GetIndex(int col, int row) const {
+	if(col < 0 || col >= fNCols || row < 0 || row >= fNRows)
+		throw TriggerChannelMap::BoundaryException(row, col, fNRows, fNCols);
+	return row * fNCols + col;
+}
@@ -0,0 +1,91 @@
+#ifndef TRIGGERDIGITIZER_H
+#define TRIGGERDIGITIZER_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <stdint.h>
+#include <vector>
+
+class TriggerBadChannelContainer;
+class TriggerChannelMap;
+
+/**
+ * @class TriggerDigitizer
+ * @brief Emulation of the FastOR response on a filled trigger channel map
+ *
+ * Converts the energy deposited in each FastOR into an amplitude in ADC counts:
+ * the energy is smeared with the relative resolution
+ * \f$\sigma/E = \sqrt{a^2/E + b^2}\f$ (stochastic term a, constant term b),
+ * multiplied with the gain of the FastOR, and pedestal and Gaussian noise of the
+ * FastOR are added. Optionally the amplitude is rounded to integer ADC counts and
+ * truncated at 0. Random numbers are taken from counter-based streams (see TriggerRandom)
+ * indexed by the channel, so the result depends only on the event seed. The loop over
+ * the FastORs is scalar: the iterations are independent, but the logarithm and cosine of
+ * the Gaussian random numbers are not vectorized without fast-math.
+ *
+ * With the default parameters (gain 1, no pedestal, noise or smearing) the channel
+ * map is not modified.
+ */
+class TriggerDigitizer {
+public:
+	TriggerDigitizer(int ncols, int nrows);
+	/**
+	 * Destructor
+	 */
+	virtual ~TriggerDigitizer() {}
+
+	void SetGain(double gain);
+	void SetGain(int col, int row, double gain);
+	void SetPedestal(double pedestal);
+	void SetPedestal(int col, int row, double pedestal);
+	void SetNoise(double noise);
+	void SetNoise(int col, int row, double noise);
+
+	/**
+	 * Set the energy resolution
+	 * @param stochastic Stochastic term a (\f$\sigma/E = \sqrt{a^2/E + b^2}\f$)
+	 * @param constant Constant term b
+	 */
+	void SetResolution(double stochastic, double constant) { fStochasticTerm = stochastic; fConstantTerm = constant; }
+
+	/**
+	 * Switch rounding of the amplitudes to integer ADC counts (truncated at 0)
+	 * @param doRound If true amplitudes are rounded
+	 */
+	void SetRoundToInteger(bool doRound) { fRoundToInteger = doRound; }
+
+	double GetGain(int col, int row) const;
+	double GetPedestal(int col, int row) const;
+	double GetNoise(int col, int row) const;
+
+	/**
+	 * Get the number of columns of the channel map
+	 * @return Number of columns
+	 */
+	int GetNumberOfCols() const { return fNCols; }
+	/**
+	 * Get the number of rows of the channel map
+	 * @return Number of rows
+	 */
+	int GetNumberOfRows() const { return fNRows; }
+
+	void Digitize(TriggerChannelMap &channels, uint64_t seed, uint64_t stream = 0, const TriggerBadChannelContainer *badchannels = NULL) const;
+
+private:
+	int GetIndex(int col, int row) const;
+
+	int							fNCols;				///< Number of columns of the channel map
+	int							fNRows;				///< Number of rows of the channel map
+	std::vector<double>			fGain;				///< Gain (ADC counts per energy unit) per FastOR, row-major
+	std::vector<double>			fPedestal;			///< Pedestal in ADC counts per FastOR, row-major
+	std::vector<double>			fNoise;				///< Width of the Gaussian noise in ADC counts per FastOR, row-major
+	double						fStochasticTerm;	///< Stochastic term of the energy resolution
+	double						fConstantTerm;		///< Constant term of the energy resolution
+	bool						fRoundToInteger;	///< Round amplitudes to integer ADC counts
+};
+
+#endif /* TRIGGERDIGITIZER_H */
@@ -0,0 +1,207 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include "TriggerEventFile.h"
+#include "TriggerMaker.h"
+
+const TriggerBinaryFile::FileFormat TriggerEventFile::kFileFormat = {"Event file", {'E', 'T', 'F', 'E', 'V', 'E', 'N', 'T'}, 1};
+
+/**
+ * Constructor, without open file
+ */
+TriggerEventFileWriter::TriggerEventFileWriter():
+	TriggerEventFile(),
+	fFilename(""),
+	fWriter(),
+	fEventOffsets(1, 0)
+{
+}
+
+/**
+ * Destructor, completing the file if still open
+ */
+TriggerEventFileWriter::~TriggerEventFileWriter() {
+	try {
+		Close();
+	} catch(FileIOException &e) {
+	}
+}
+
+/**
+ * Create a new event file. A file still open is completed before.
+ * @param filename Name of the file
+ * @throw FileIOException in case the file cannot be created
+ */
+void TriggerEventFileWriter::Open(const std::string &filename) {
+	Close();
+	fWriter.clear();
+	fWriter.open(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!fWriter.good()) throw FileIOException(kFileFormat.fType, filename, "cannot open file for writing");
+	fFilename = filename;
+	fEventOffsets.assign(1, 0);
+	WriteHeader();
+}
+
+/**
+ * Append an event to the file
+ * @param particles Particles of the event
+ * @throw FileIOException in case no file is open or the event cannot be written
+ */
+void TriggerEventFileWriter::AddEvent(const std::vector<TriggerEventGenerator::Particle> &particles) {
+	if(!fWriter.is_open()) throw FileIOException(kFileFormat.fType, fFilename, "file not open");
+	ParticleRecord record;
+	record.fPadding = 0;
+	for(std::vector<TriggerEventGenerator::Particle>::const_iterator partiter = particles.begin(); partiter != particles.end(); ++partiter){
+		record.fEta = partiter->fEta;
+		record.fPhi = partiter->fPhi;
+		record.fEnergy = partiter->fEnergy;
+		record.fType = partiter->fType;
+		fWriter.write(reinterpret_cast<const char *>(&record), sizeof(record));
+	}
+	if(!fWriter.good()) throw FileIOException(kFileFormat.fType, fFilename, "write error");
+	fEventOffsets.push_back(fEventOffsets.back() + particles.size());
+}
+
+/**
+ * Complete the file, writing the event index and the final header. Nothing is done
+ * in case no file is open.
+ * @throw FileIOException in case the file cannot be completed
+ */
+void TriggerEventFileWriter::Close() {
+	if(!fWriter.is_open()) return;
+	fWriter.write(reinterpret_cast<const char *>(&fEventOffsets[0]), fEventOffsets.size() * sizeof(uint64_t));
+	fWriter.seekp(0);
+	WriteHeader();
+	fWriter.close();
+	if(fWriter.fail()) throw FileIOException(kFileFormat.fType, fFilename, "write error");
+}
+
+/**
+ * Write the header with the current number of events and particles at the current position
+ */
+void TriggerEventFileWriter::WriteHeader() {
+	FileHeader header;
+	InitSignature(header.fSignature, kFileFormat);
+	header.fNEvents = GetNumberOfEvents();
+	header.fNParticles = fEventOffsets.back();
+	fWriter.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+/**
+ * Constructor, without open file
+ */
+TriggerEventFileReader::TriggerEventFileReader():
+	TriggerEventFile(),
+	fFilename(""),
+	fMapping(NULL),
+	fMappingSize(0),
+	fNEvents(0),
+	fParticles(NULL),
+	fEventOffsets(NULL)
+{
+}
+
+/**
+ * Destructor, unmapping the file
+ */
+TriggerEventFileReader::~TriggerEventFileReader() {
+	Close();
+}
+
+/**
+ * Map an event file into memory. A file still open is closed before.
+ * @param filename Name of the file
+ * @throw FileIOException in case the file cannot be read, has an invalid format, a size not
+ * matching the header or a corrupt event index
+ */
+void TriggerEventFileReader::Open(const std::string &filename) {
+	Close();
+	size_t filesize(0);
+	void *mapping = MapFile(filename, kFileFormat, sizeof(FileHeader), filesize);
+
+	const FileHeader &header = *static_cast<const FileHeader *>(mapping);
+	std::string reason;
+	// sizes checked by division, counts in the header may be arbitrary
+	uint64_t payload = static_cast<uint64_t>(filesize) - sizeof(FileHeader);
+	bool valid = header.fNParticles <= payload / sizeof(ParticleRecord)
+			&& header.fNEvents < (payload - header.fNParticles * sizeof(ParticleRecord)) / sizeof(uint64_t)
+			&& payload == header.fNParticles * sizeof(ParticleRecord) + (header.fNEvents + 1) * sizeof(uint64_t);
+	if(!valid) reason = "truncated file";
+	if(valid){
+		// event index: starts at 0, not decreasing, ends at the number of particles
+		const uint64_t *offsets = reinterpret_cast<const uint64_t *>(static_cast<const char *>(mapping) + sizeof(FileHeader) + header.fNParticles * sizeof(ParticleRecord));
+		valid = offsets[0] == 0 && offsets[header.fNEvents] == header.fNParticles;
+		for(uint64_t ievent = 0; valid && ievent < header.fNEvents; ievent++)
+			if(offsets[ievent + 1] < offsets[ievent]) valid = false;
+		if(!valid) reason = "corrupt event index";
+	}
+	if(!valid){
+		UnmapFile(mapping, filesize);
+		throw FileIOException(kFileFormat.fType, filename, reason);
+	}
+	fFilename = filename;
+	fMapping = mapping;
+	fMappingSize = filesize;
+	fNEvents = header.fNEvents;
+	fParticles = reinterpret_cast<const ParticleRecord *>(static_cast<const char *>(mapping) + sizeof(FileHeader));
+	fEventOffsets = reinterpret_cast<const uint64_t *>(fParticles + header.fNParticles);
+}
+
+/**
+ * Unmap the file. Nothing is done in case no file is open.
+ */
+void TriggerEventFileReader::Close() {
+	if(fMapping) UnmapFile(fMapping, fMappingSize);
+	fMapping = NULL;
+	fMappingSize = 0;
+	fNEvents = 0;
+	fParticles = NULL;
+	fEventOffsets = NULL;
+}
+
+/**
+ * Get the particles of an event
+ * @param eventnumber Number of the event in the file
+ * @param particles Output container for the particles, cleared before
+ * @throw FileIOException in case the event is not in the file
+ */
+void TriggerEventFileReader::GetEvent(uint64_t eventnumber, std::vector<TriggerEventGenerator::Particle> &particles) const {
+	if(eventnumber >= fNEvents) throw FileIOException(kFileFormat.fType, fFilename, "event number out of range");
+	particles.clear();
+	for(const ParticleRecord *record = fParticles + fEventOffsets[eventnumber]; record != fParticles + fEventOffsets[eventnumber + 1]; ++record){
+		TriggerEventGenerator::Particle particle;
+		particle.fEta = record->fEta;
+		particle.fPhi = record->fPhi;
+		particle.fEnergy = record->fEnergy;
+		particle.fType = static_cast<TriggerShowerModel::ParticleType>(record->fType);
+		particles.push_back(particle);
+	}
+}
+
+/**
+ * Reset the trigger maker and fill the channel maps with the particles of an event
+ * @param eventnumber Number of the event in the file
+ * @param maker Trigger maker to be filled
+ * @throw FileIOException in case the event is not in the file
+ */
+void TriggerEventFileReader::FillEvent(uint64_t eventnumber, TriggerMaker &maker) const {
+	if(eventnumber >= fNEvents) throw FileIOException(kFileFormat.fType, fFilename, "event number out of range");
+	maker.Reset();
+	for(const ParticleRecord *record = fParticles + fEventOffsets[eventnumber]; record != fParticles + fEventOffsets[eventnumber + 1]; ++record)
+		maker.FillChannelMap(record->fEta, record->fPhi, record->fEnergy, static_cast<TriggerShowerModel::ParticleType>(record->fType));
+}
@@ -0,0 +1,134 @@
+#ifndef TRIGGEREVENTFILE_H
+#define TRIGGEREVENTFILE_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <fstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TriggerBinaryFile.h"
+#include "TriggerEventGenerator.h"
+
+class TriggerMaker;
+
+/**
+ * @class TriggerEventFile
+ * @brief Binary files of particle events
+ *
+ * File layout (byte order of the machine writing the file):
+ * - header: signature (magic, version, byte order marker, see TriggerBinaryFile), number
+ *   of events, number of particles
+ * - particle records (eta, phi, energy as double, particle type), events in sequence
+ * - index of the first particle of each event, plus the total number of particles
+ *
+ * The index at the end of the file allows to access any event range without reading
+ * the file sequentially. Files are written with TriggerEventFileWriter and read with
+ * TriggerEventFileReader.
+ */
+class TriggerEventFile : public TriggerBinaryFile {
+public:
+	TriggerEventFile() {}
+	virtual ~TriggerEventFile() {}
+
+protected:
+	/**
+	 * @struct FileHeader
+	 * @brief Header at the beginning of the file
+	 */
+	struct FileHeader {
+		FileSignature			fSignature;			///< File type, version and byte order
+		uint64_t				fNEvents;			///< Number of events
+		uint64_t				fNParticles;		///< Number of particles
+	};
+
+	/**
+	 * @struct ParticleRecord
+	 * @brief Particle as stored in the file
+	 */
+	struct ParticleRecord {
+		double					fEta;				///< Eta of the particle
+		double					fPhi;				///< Phi of the particle
+		double					fEnergy;			///< Energy of the particle
+		int32_t					fType;				///< Type of the particle
+		int32_t					fPadding;			///< Unused
+	};
+
+	static const FileFormat kFileFormat;			///< Format of event files
+};
+
+/**
+ * @class TriggerEventFileWriter
+ * @brief Writer of event files (see TriggerEventFile for the format)
+ *
+ * Events are appended one by one, the index and the final header are written in Close.
+ */
+class TriggerEventFileWriter : public TriggerEventFile {
+public:
+	TriggerEventFileWriter();
+	virtual ~TriggerEventFileWriter();
+
+	void Open(const std::string &filename);
+	void AddEvent(const std::vector<TriggerEventGenerator::Particle> &particles);
+	void Close();
+
+	/**
+	 * Get the number of events written so far
+	 * @return Number of events
+	 */
+	uint64_t GetNumberOfEvents() const { return fEventOffsets.size() - 1; }
+
+private:
+	TriggerEventFileWriter(const TriggerEventFileWriter &ref);
+	TriggerEventFileWriter &operator=(const TriggerEventFileWriter &ref);
+
+	void WriteHeader();
+
+	std::string						fFilename;			///< Name of the open file
+	std::ofstream					fWriter;			///< Output stream
+	std::vector<uint64_t>			fEventOffsets;		///< Index of the first particle per event
+};
+
+/**
+ * @class TriggerEventFileReader
+ * @brief Reader of event files (see TriggerEventFile for the format)
+ *
+ * The file is mapped read-only into memory, so events are accessed in any order
+ * without I/O calls. The mapping is shared: processes forked after opening the
+ * file read the same pages.
+ */
+class TriggerEventFileReader : public TriggerEventFile {
+public:
+	TriggerEventFileReader();
+	virtual ~TriggerEventFileReader();
+
+	void Open(const std::string &filename);
+	void Close();
+
+	/**
+	 * Get the number of events in the file
+	 * @return Number of events (0 if no file is open)
+	 */
+	uint64_t GetNumberOfEvents() const { return fNEvents; }
+
+	void GetEvent(uint64_t eventnumber, std::vector<TriggerEventGenerator::Particle> &particles) const;
+	void FillEvent(uint64_t eventnumber, TriggerMaker &maker) const;
+
+private:
+	TriggerEventFileReader(const TriggerEventFileReader &ref);
+	TriggerEventFileReader &operator=(const TriggerEventFileReader &ref);
+
+	std::string						fFilename;			///< Name of the open file
+	void							*fMapping;			///< Start of the file mapping
+	size_t							fMappingSize;		///< Size of the file mapping
+	uint64_t						fNEvents;			///< Number of events
+	const ParticleRecord			*fParticles;		///< Particle records
+	const uint64_t					*fEventOffsets;		///< Index of the first particle per event (nevents + 1 entries)
+};
+
+#endif /* TRIGGEREVENTFILE_H */
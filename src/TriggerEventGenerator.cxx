@@ -0,0 +1,91 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <cmath>
+
+#include "TriggerEventGenerator.h"
+#include "TriggerMaker.h"
+#include "TriggerRandom.h"
+
+/**
+ * Constructor, with the default event shape: 1000 - 2000 particles per event with
+ * |eta| < 1, full azimuth and energies up to 100, all electromagnetic.
+ * @param runseed Seed of the run
+ */
+TriggerEventGenerator::TriggerEventGenerator(uint64_t runseed):
+	fRunSeed(runseed),
+	fMinParticles(1000),
+	fMaxParticles(2000),
+	fEtaMin(-1.),
+	fEtaMax(1.),
+	fPhiMin(0.),
+	fPhiMax(TriggerRandom::kTwoPi),
+	fEnergyMin(0.),
+	fEnergyMax(100.),
+	fHadronFraction(0.),
+	fDigitize(false)
+{
+}
+
+/**
+ * Get the seed of an event, derived from the run seed and the event number. The seed is
+ * used for the particle generation and for the digitization.
+ * @param eventnumber Number of the event in the run
+ * @return Seed of the event
+ */
+uint64_t TriggerEventGenerator::GetEventSeed(uint64_t eventnumber) const {
+	return TriggerRandom(fRunSeed, eventnumber).GetKey();
+}
+
+/**
+ * Generate the particles of an event. The result only depends on the run seed, the event
+ * number and the configuration of the generator.
+ * @param eventnumber Number of the event in the run
+ * @param particles Output container, cleared before filling
+ */
+void TriggerEventGenerator::GenerateEvent(uint64_t eventnumber, std::vector<Particle> &particles) const {
+	particles.clear();
+	TriggerRandom random(GetEventSeed(eventnumber), kParticleStream);
+	int nparticles = fMinParticles;
+	if(fMaxParticles > fMinParticles)
+		nparticles += static_cast<int>(random.Integer(0) % static_cast<uint64_t>(fMaxParticles - fMinParticles + 1));
+	particles.resize(nparticles);
+	for(int ipart = 0; ipart < nparticles; ipart++){
+		uint64_t counter = 1 + static_cast<uint64_t>(ipart) * kNumbersPerParticle;
+		Particle &particle = particles[ipart];
+		particle.fEta = fEtaMin + (fEtaMax - fEtaMin) * random.Uniform(counter);
+		particle.fPhi = fPhiMin + (fPhiMax - fPhiMin) * random.Uniform(counter + 1);
+		particle.fEnergy = fEnergyMin + (fEnergyMax - fEnergyMin) * random.Uniform(counter + 2);
+		particle.fType = random.Uniform(counter + 3) < fHadronFraction ? TriggerShowerModel::kHadronic : TriggerShowerModel::kElectromagnetic;
+	}
+}
+
+/**
+ * Generate an event and fill it into the channel maps of a trigger maker. The trigger maker
+ * is reset before and, if enabled, digitized with the seed of the event afterwards.
+ * @param eventnumber Number of the event in the run
+ * @param maker Trigger maker to be filled
+ */
+void TriggerEventGenerator::FillEvent(uint64_t eventnumber, TriggerMaker &maker) const {
+	std::vector<Particle> particles;
+	GenerateEvent(eventnumber, particles);
+	maker.Reset();
+	for(std::vector<Particle>::const_iterator partiter = particles.begin(); partiter != particles.end(); ++partiter)
+		maker.FillChannelMap(partiter->fEta, partiter->fPhi, partiter->fEnergy, partiter->fType);
+	if(fDigitize) maker.Digitize(GetEventSeed(eventnumber));
+}
@@ -0,0 +1,119 @@
+#ifndef TRIGGEREVENTGENERATOR_H
+#define TRIGGEREVENTGENERATOR_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include "TriggerShowerModel.h"
+
+class TriggerMaker;
+
+/**
+ * @class TriggerEventGenerator
+ * @brief Reproducible random events for tests and benchmarks of the trigger maker
+ *
+ * Generates events of particles with uniform distributions in multiplicity, eta, phi
+ * and energy. All random numbers of an event come from counter-based streams
+ * (TriggerRandom) keyed by the run seed and the event number, so an event only depends
+ * on these two numbers: events can be generated in any order, in parallel or on
+ * different machines with bit-identical results. The generator has no state changing
+ * during the event loop and can be shared between threads.
+ */
+class TriggerEventGenerator {
+public:
+	/**
+	 * @struct Particle
+	 * @brief Particle hitting the calorimeter surface
+	 */
+	struct Particle {
+		double								fEta;				///< Eta of the particle
+		double								fPhi;				///< Phi of the particle
+		double								fEnergy;			///< Energy of the particle
+		TriggerShowerModel::ParticleType	fType;				///< Type of the particle
+	};
+
+	TriggerEventGenerator(uint64_t runseed = 0);
+	virtual ~TriggerEventGenerator() {}
+
+	/**
+	 * Set the seed of the run
+	 * @param runseed Seed of the run
+	 */
+	void SetRunSeed(uint64_t runseed) { fRunSeed = runseed; }
+
+	/**
+	 * Get the seed of the run
+	 * @return Seed of the run
+	 */
+	uint64_t GetRunSeed() const { return fRunSeed; }
+
+	/**
+	 * Set the range of the number of particles per event (uniform, limits inclusive)
+	 * @param min Min. number of particles
+	 * @param max Max. number of particles
+	 */
+	void SetMultiplicity(int min, int max) { fMinParticles = min; fMaxParticles = max; }
+
+	/**
+	 * Set the eta range of the particles
+	 * @param min Min. eta
+	 * @param max Max. eta
+	 */
+	void SetEtaRange(double min, double max) { fEtaMin = min; fEtaMax = max; }
+
+	/**
+	 * Set the phi range of the particles
+	 * @param min Min. phi
+	 * @param max Max. phi
+	 */
+	void SetPhiRange(double min, double max) { fPhiMin = min; fPhiMax = max; }
+
+	/**
+	 * Set the energy range of the particles
+	 * @param min Min. energy
+	 * @param max Max. energy
+	 */
+	void SetEnergyRange(double min, double max) { fEnergyMin = min; fEnergyMax = max; }
+
+	/**
+	 * Set the fraction of hadronic particles, the others are electromagnetic
+	 * @param fraction Fraction of hadronic particles (0 - 1)
+	 */
+	void SetHadronFraction(double fraction) { fHadronFraction = fraction; }
+
+	/**
+	 * Switch on the emulation of the detector response (TriggerMaker::Digitize) in FillEvent
+	 * @param doDigitize If true the channel maps are digitized with the seed of the event
+	 */
+	void SetDigitize(bool doDigitize) { fDigitize = doDigitize; }
+
+	uint64_t GetEventSeed(uint64_t eventnumber) const;
+	void GenerateEvent(uint64_t eventnumber, std::vector<Particle> &particles) const;
+	void FillEvent(uint64_t eventnumber, TriggerMaker &maker) const;
+
+private:
+	enum {
+		kParticleStream = 16,				///< Stream of the particle generation (streams below are left to the digitizers)
+		kNumbersPerParticle = 4				///< Random numbers drawn per particle
+	};
+
+	uint64_t						fRunSeed;				///< Seed of the run
+	int								fMinParticles;			///< Min. number of particles per event
+	int								fMaxParticles;			///< Max. number of particles per event
+	double							fEtaMin;				///< Min. eta of the particles
+	double							fEtaMax;				///< Max. eta of the particles
+	double							fPhiMin;				///< Min. phi of the particles
+	double							fPhiMax;				///< Max. phi of the particles
+	double							fEnergyMin;				///< Min. energy of the particles
+	double							fEnergyMax;				///< Max. energy of the particles
+	double							fHadronFraction;		///< Fraction of hadronic particles
+	bool							fDigitize;				///< Digitize the channel maps in FillEvent
+};
+
+#endif /* TRIGGEREVENTGENERATOR_H */
@@ -0,0 +1,255 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+
+#include "JetTriggerAlgorithm.h"
+#include "TriggerChannelMap.h"
+#include "TriggerFusedScan.h"
+#include "TriggerPatchMask.h"
+#include "TriggerRegionMap.h"
+#include "TriggerSetup.h"
+#include "TriggerSubregionMap.h"
+
+/**
+ * Constructor, without requested outputs
+ */
+TriggerFusedScan::TriggerFusedScan():
+	fTriggerSetup(NULL),
+	fKernels(&TriggerKernels::GetKernels(TriggerKernels::SelectISA())),
+	fSubregionSums(),
+	fRowBuffer(),
+	fWindowSums()
+{
+	ClearOutputs();
+}
+
+/**
+ * Request the patches of an output type
+ * @param type Output type
+ * @param patches Output container, cleared and filled in Scan
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void TriggerFusedScan::SetOutput(OutputType type, std::vector<PackedRawPatch> *patches, const TriggerPatchMask *mask) {
+	fPatches[type] = patches;
+	fSummaries[type] = NULL;
+	fMasks[type] = mask;
+}
+
+/**
+ * Request the summary of an output type instead of the patch list
+ * @param type Output type
+ * @param summary Output summary, reset and filled in Scan
+ * @param mask Accepted patch positions (all positions accepted if NULL)
+ */
+void TriggerFusedScan::SetSummaryOutput(OutputType type, TriggerSummary::CategorySummary *summary, const TriggerPatchMask *mask) {
+	fPatches[type] = NULL;
+	fSummaries[type] = summary;
+	fMasks[type] = mask;
+}
+
+/**
+ * Remove all requested outputs
+ */
+void TriggerFusedScan::ClearOutputs() {
+	for(int itype = 0; itype < kNOutputTypes; itype++){
+		fPatches[itype] = NULL;
+		fSummaries[itype] = NULL;
+		fMasks[itype] = NULL;
+	}
+}
+
+/**
+ * Scan the channel map of one detector, filling the requested outputs and the subregion map.
+ * The subregion map is always filled. Windows only covering untouched channels are skipped
+ * in case none of the 2x2 thresholds is negative. For channel maps in the tiled layout
+ * the subregion sums are taken from the contiguous tiles and the rows of the 2x2 windows
+ * are gathered from the tiles, with the same results as for the row-major layout.
+ * @param channels Input channel map
+ * @param subregions Subregion map to be filled from the channel map
+ * @param detector Detector of the channel map (RawPatch::kEMCALpatch or RawPatch::kDCALPHOSpatch)
+ */
+void TriggerFusedScan::Scan(const TriggerChannelMap &channels, TriggerSubregionMap &subregions, RawPatch::Patchtype detector) {
+	const TriggerThresholdTable *thresholdsGamma = HasOutput(kGamma) ? &fTriggerSetup->GetThresholdTable(GetCategory(kGamma, detector)) : NULL,
+			*thresholdsLevel0 = HasOutput(kLevel0) ? &fTriggerSetup->GetThresholdTable(GetCategory(kLevel0, detector)) : NULL;
+	const TriggerPatchMask *maskGamma = fMasks[kGamma], *maskLevel0 = fMasks[kLevel0];
+	const int ncols = channels.GetNumberOfCols(), nrows = channels.GetNumberOfRows(), nscols = subregions.GetNumberOfCols();
+	const bool sparse = (!thresholdsGamma || thresholdsGamma->GetMinThreshold() >= 0) && (!thresholdsLevel0 || thresholdsLevel0->GetMinThreshold() >= 0);
+	if(thresholdsGamma) ClearOutput(kGamma);
+	if(thresholdsLevel0) ClearOutput(kLevel0);
+	const bool tiled = channels.GetLayout() == TriggerChannelMap::kTiled;
+	fSubregionSums.resize(nscols);
+	if(tiled) fRowBuffer.resize(2 * ncols);
+	fWindowSums.resize(ncols);
+
+	for(int rowmin = 0; rowmin < nrows; rowmin += TriggerSubregionMap::kSubregionSize){
+		int rowmax = std::min(rowmin + TriggerSubregionMap::kSubregionSize, nrows) - 1;
+		unsigned long long occupancy = channels.GetOccupancyMask(rowmin, rowmax);
+		std::fill(fSubregionSums.begin(), fSubregionSums.end(), 0.);
+		if(tiled){
+			// 4x4 subregion sums from the contiguous tiles, same summation order as row by row
+			int srow = rowmin / TriggerSubregionMap::kSubregionSize;
+			for(int scol = 0; scol < nscols; scol++){
+				if(!TriggerChannelMap::IsOccupied(occupancy, scol * TriggerSubregionMap::kSubregionSize, scol * TriggerSubregionMap::kSubregionSize)) continue;
+				const double *tile = channels.GetTileData(scol, srow);
+				double &subregionsum = fSubregionSums[scol];
+				for(int ichannel = 0; ichannel < TriggerChannelMap::kTileSize; ichannel++) subregionsum += tile[ichannel];
+			}
+		}
+		for(int irow = rowmin; irow <= rowmax; irow++){
+			const double *row0 = tiled ? NULL : channels.GetRowData(irow);
+
+			// 4x4 subregion sums, untouched subregions stay 0
+			if(!tiled){
+				for(int scol = 0; scol < nscols; scol++){
+					int colmin = scol * TriggerSubregionMap::kSubregionSize, colmax = std::min(colmin + TriggerSubregionMap::kSubregionSize, ncols) - 1;
+					if(!TriggerChannelMap::IsOccupied(occupancy, colmin, colmax)) continue;
+					double &subregionsum = fSubregionSums[scol];
+					for(int icol = colmin; icol <= colmax; icol++) subregionsum += row0[icol];
+				}
+			}
+
+			// 2x2 windows starting in this row, shared by gamma and Level0 decision
+			if(!(thresholdsGamma || thresholdsLevel0) || irow >= nrows - 1) continue;
+			unsigned long long occupancy2x2 = sparse ? channels.GetOccupancyMask(irow, irow + 1) : ~0ULL;
+			if(!occupancy2x2) continue;
+			const double *row1 = NULL;
+			if(tiled){
+				// rows of the 2x2 windows gathered from the tiles
+				channels.GetRow(irow, &fRowBuffer[0]);
+				channels.GetRow(irow + 1, &fRowBuffer[ncols]);
+				row0 = &fRowBuffer[0];
+				row1 = &fRowBuffer[ncols];
+			} else {
+				row1 = channels.GetRowData(irow + 1);
+			}
+			fKernels->fSumWindows2x2(row0, row1, ncols - 1, &fWindowSums[0]);
+			for(int icol = 0; icol < ncols - 1; icol++){
+				if(!TriggerChannelMap::IsOccupied(occupancy2x2, icol, icol + 1)) continue;
+				double adcsum = fWindowSums[icol];
+				if(thresholdsGamma && !(maskGamma && !maskGamma->IsAccepted(icol, irow))){
+					int triggerBits = thresholdsGamma->GetTriggerBits(adcsum);
+					if(triggerBits) AddPatch(kGamma, icol, irow, adcsum, triggerBits, 2, detector);
+				}
+				if(thresholdsLevel0 && !(maskLevel0 && !maskLevel0->IsAccepted(icol, irow))){
+					int triggerBits = thresholdsLevel0->GetTriggerBits(adcsum);
+					if(triggerBits && TriggerRegionMap::IsWindow2x2WithinTRU(icol, irow, nrows))
+						AddPatch(kLevel0, icol, irow, adcsum, triggerBits, 2, detector);
+				}
+			}
+		}
+		for(int scol = 0; scol < nscols; scol++) subregions.SetADC(scol, rowmin / TriggerSubregionMap::kSubregionSize, fSubregionSums[scol]);
+	}
+
+	ScanJetWindows(subregions, detector);
+
+	for(int itype = 0; itype < kNOutputTypes; itype++)
+		if(HasOutput(static_cast<OutputType>(itype))) FinishOutput(static_cast<OutputType>(itype));
+}
+
+/**
+ * Evaluate the 16x16 and 8x8 jet windows in the same loop over the subregion map
+ * @param subregions Subregion map filled from the channel map
+ * @param detector Detector of the channel map
+ */
+void TriggerFusedScan::ScanJetWindows(const TriggerSubregionMap &subregions, RawPatch::Patchtype detector) {
+	const OutputType jettypes[2] = {kJet, kJet8x8};
+	const int windowsizes[2] = {4, 2};
+	const TriggerThresholdTable *thresholds[2] = {NULL, NULL};
+	int nwindowcols[2] = {0, 0}, nwindowrows[2] = {0, 0}, maxcols(0), maxrows(0);
+	for(int ijet = 0; ijet < 2; ijet++){
+		if(!HasOutput(jettypes[ijet])) continue;
+		ClearOutput(jettypes[ijet]);
+		thresholds[ijet] = &fTriggerSetup->GetThresholdTable(GetCategory(jettypes[ijet], detector));
+		nwindowcols[ijet] = JetTriggerAlgorithm::GetNumberOfSubregionWindows(subregions.GetNumberOfCols(), windowsizes[ijet]);
+		nwindowrows[ijet] = JetTriggerAlgorithm::GetNumberOfSubregionWindows(subregions.GetNumberOfRows(), windowsizes[ijet]);
+		maxcols = std::max(maxcols, nwindowcols[ijet]);
+		maxrows = std::max(maxrows, nwindowrows[ijet]);
+	}
+
+	for(int srow = 0; srow < maxrows; srow++){
+		for(int scol = 0; scol < maxcols; scol++){
+			int col = scol * TriggerSubregionMap::kSubregionSize, row = srow * TriggerSubregionMap::kSubregionSize;
+			for(int ijet = 0; ijet < 2; ijet++){
+				if(!thresholds[ijet] || scol >= nwindowcols[ijet] || srow >= nwindowrows[ijet]) continue;
+				const TriggerPatchMask *mask = fMasks[jettypes[ijet]];
+				if(mask && !mask->IsAccepted(col, row)) continue;
+				double adcsum = subregions.GetWindowADC(scol, srow, windowsizes[ijet]);
+				int triggerBits = thresholds[ijet]->GetTriggerBits(adcsum);
+				if(triggerBits)
+					AddPatch(jettypes[ijet], col, row, adcsum, triggerBits, windowsizes[ijet] * TriggerSubregionMap::kSubregionSize, detector);
+			}
+		}
+	}
+}
+
+/**
+ * Clear the patch list or reset the summary of an output before the scan
+ * @param type Output type
+ */
+void TriggerFusedScan::ClearOutput(OutputType type) {
+	if(fPatches[type]){
+		fPatches[type]->clear();
+		return;
+	}
+	fSummaries[type]->Reset();
+	fAmplitudes[type].clear();
+}
+
+/**
+ * Complete an output after the scan: patch lists are sorted so that the main patch appears
+ * last, for summaries the median is determined by partial sorting of the amplitudes, with
+ * the same result as the median of the sorted patch list.
+ * @param type Output type
+ */
+void TriggerFusedScan::FinishOutput(OutputType type) {
+	if(fPatches[type]){
+		std::sort(fPatches[type]->begin(), fPatches[type]->end());
+		return;
+	}
+	TriggerSummary::CategorySummary &summary = *fSummaries[type];
+	std::vector<float> &amplitudes = fAmplitudes[type];
+	if(amplitudes.empty()) return;
+	size_t halfsize = amplitudes.size() / 2;
+	std::nth_element(amplitudes.begin(), amplitudes.begin() + halfsize, amplitudes.end());
+	double upper = amplitudes[halfsize];
+	if(amplitudes.size() % 2){
+		summary.fMedianADC = upper;
+	} else {
+		double lower = *std::max_element(amplitudes.begin(), amplitudes.begin() + halfsize);
+		summary.fMedianADC = (lower + upper) / 2;
+	}
+}
+
+/**
+ * Get the patch category of an output type for a detector
+ * @param type Output type
+ * @param detector Detector (RawPatch::kEMCALpatch or RawPatch::kDCALPHOSpatch)
+ * @return Patch category
+ */
+int TriggerFusedScan::GetCategory(OutputType type, RawPatch::Patchtype detector) {
+	bool isDCALPHOS = detector == RawPatch::kDCALPHOSpatch;
+	switch(type){
+	case kGamma: return isDCALPHOS ? RawPatch::kDCALpatchGA : RawPatch::kEMCALpatchGA;
+	case kLevel0: return isDCALPHOS ? RawPatch::kDCALpatchL0 : RawPatch::kEMCALpatchL0;
+	case kJet: return isDCALPHOS ? RawPatch::kDCALpatchJE : RawPatch::kEMCALpatchJE;
+	case kJet8x8: return isDCALPHOS ? RawPatch::kDCALpatchJE8x8 : RawPatch::kEMCALpatchJE8x8;
+	default: break;
+	};
+	return RawPatch::kUndefPatch;
+}
@@ -0,0 +1,123 @@
+#ifndef TRIGGERFUSEDSCAN_H
+#define TRIGGERFUSEDSCAN_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <vector>
+
+#include "TriggerAlgorithm.h"
+#include "TriggerKernels.h"
+#include "TriggerSummary.h"
+
+class TriggerChannelMap;
+class TriggerPatchMask;
+class TriggerSetup;
+class TriggerSubregionMap;
+
+/**
+ * @class TriggerFusedScan
+ * @brief Patch finding for all standard categories of one detector in a single pass
+ *
+ * Traverses the channel map of a detector once: for every row the 2x2 window sums
+ * are evaluated against the gamma and the Level0 thresholds, and the FastOR amplitudes
+ * are accumulated into the 4x4 subregion sums. The 16x16 and 8x8 jet windows are then
+ * evaluated together on the subregion map. Only the requested outputs are filled,
+ * either as patch list or, without storing the patches, as TriggerSummary::CategorySummary.
+ *
+ * Window positions, summation order, thresholds and masks are the same as in
+ * GammaTriggerAlgorithm, Level0TriggerAlgorithm and JetTriggerAlgorithm, so the patches
+ * are identical to the ones of the separate finders.
+ */
+class TriggerFusedScan {
+public:
+	enum OutputType {
+		kGamma = 0,
+		kLevel0,
+		kJet,
+		kJet8x8,
+		kNOutputTypes
+	};
+
+	TriggerFusedScan();
+	virtual ~TriggerFusedScan() {}
+
+	/**
+	 * Set the trigger setup providing the threshold tables
+	 * @param setup Trigger setup
+	 */
+	void SetTriggerSetup(const TriggerSetup *setup) { fTriggerSetup = setup; }
+
+	/**
+	 * Set the vector kernels used for the window sums (default: TriggerKernels::SelectISA)
+	 * @param kernels Kernels of the instruction set to be used
+	 */
+	void SetKernels(const TriggerKernels::KernelTable &kernels) { fKernels = &kernels; }
+
+	/**
+	 * Get the vector kernels used for the window sums
+	 * @return Kernels in use
+	 */
+	const TriggerKernels::KernelTable &GetKernels() const { return *fKernels; }
+
+	void SetOutput(OutputType type, std::vector<PackedRawPatch> *patches, const TriggerPatchMask *mask = NULL);
+	void SetSummaryOutput(OutputType type, TriggerSummary::CategorySummary *summary, const TriggerPatchMask *mask = NULL);
+	void ClearOutputs();
+
+	/**
+	 * Check whether patches or the summary of an output type are requested
+	 * @param type Output type
+	 * @return True if an output container or summary is set
+	 */
+	bool HasOutput(OutputType type) const { return fPatches[type] != NULL || fSummaries[type] != NULL; }
+
+	void Scan(const TriggerChannelMap &channels, TriggerSubregionMap &subregions, RawPatch::Patchtype detector);
+
+	static int GetCategory(OutputType type, RawPatch::Patchtype detector);
+
+private:
+	void ScanJetWindows(const TriggerSubregionMap &subregions, RawPatch::Patchtype detector);
+	void ClearOutput(OutputType type);
+	void FinishOutput(OutputType type);
+
+	/**
+	 * Add a patch to the output: to the patch list, or to the summary (count, trigger bits,
+	 * max. patch and amplitude for the median). Ties of the max. amplitude are resolved as
+	 * in PackedRawPatch::GetMaxPatch.
+	 */
+	void AddPatch(OutputType type, unsigned char col, unsigned char row, double adc, int triggerBits, unsigned char patchsize, RawPatch::Patchtype detector) {
+		if(fPatches[type]){
+			fPatches[type]->push_back(PackedRawPatch(col, row, adc, triggerBits, patchsize, detector));
+			return;
+		}
+		TriggerSummary::CategorySummary &summary = *fSummaries[type];
+		float adcpacked = static_cast<float>(adc);
+		summary.fTriggerBits |= triggerBits;
+		if(!summary.fNPatches || adcpacked > summary.fMaxADC
+				|| (adcpacked == summary.fMaxADC && PackedRawPatch::IsPreferredPosition(col, row, summary.fMaxCol, summary.fMaxRow))){
+			summary.fMaxADC = adcpacked;
+			summary.fMaxTriggerBits = triggerBits;
+			summary.fMaxCol = col;
+			summary.fMaxRow = row;
+			summary.fPatchSize = patchsize;
+			summary.fPatchType = detector;
+		}
+		summary.fNPatches++;
+		fAmplitudes[type].push_back(adcpacked);
+	}
+
+	const TriggerSetup					*fTriggerSetup;						///< Trigger setup providing the thresholds
+	const TriggerKernels::KernelTable	*fKernels;							///< Vector kernels for the window sums
+	std::vector<PackedRawPatch>			*fPatches[kNOutputTypes];			///< Output containers (NULL if not requested)
+	TriggerSummary::CategorySummary		*fSummaries[kNOutputTypes];			///< Output summaries (NULL if not requested)
+	std::vector<float>					fAmplitudes[kNOutputTypes];			///< Patch amplitudes of the summary outputs, for the median
+	const TriggerPatchMask				*fMasks[kNOutputTypes];				///< Accepted patch positions per output (NULL: all accepted)
+	std::vector<double>					fSubregionSums;						///< Subregion sums of the current row of subregions
+	std::vector<double>					fRowBuffer;							///< Rows of the 2x2 windows, for tiled channel maps
+	std::vector<double>					fWindowSums;						///< 2x2 window sums of the current row
+};
+
+#endif /* TRIGGERFUSEDSCAN_H */
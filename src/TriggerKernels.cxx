@@ -0,0 +1,277 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "TriggerKernels.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ETF_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const char *kISANames[TriggerKernels::kNISAs] = {"generic", "sse4.2", "avx2", "avx512"};
+
+// Generic variants, summation in the same order as the patch finders
+void SumWindows2x2Generic(const double *row0, const double *row1, int nwindows, double *sums) {
+	for(int icol = 0; icol < nwindows; icol++){
+		double adcsum = 0;
+		adcsum += row0[icol];
+		adcsum += row0[icol + 1];
+		adcsum += row1[icol];
+		adcsum += row1[icol + 1];
+		sums[icol] = adcsum;
+	}
+}
+
+void AddLanesGeneric(const double *values, int n, double *sums) {
+	for(int i = 0; i < n; i++) sums[i] += values[i];
+}
+
+void MaxLanesGeneric(const double *values, int n, double *max) {
+	for(int i = 0; i < n; i++) if(values[i] > max[i]) max[i] = values[i];
+}
+
+// bin = floor((value - min) * scale) + 1, limited to the underflow (NaN included) and overflow bins
+void ComputeBinsGeneric(const double *values, int n, double min, double scale, int nbins, int32_t *bins) {
+	const double lowest = -1., highest = nbins;
+	for(int i = 0; i < n; i++){
+		double bin = std::floor((values[i] - min) * scale);
+		if(!(bin > lowest)) bin = lowest;
+		if(!(bin < highest)) bin = highest;
+		bins[i] = static_cast<int32_t>(bin + 1.);
+	}
+}
+
+#ifdef ETF_KERNELS_X86
+// SSE4.2 variants, 2 lanes
+__attribute__((target("sse4.2")))
+void SumWindows2x2SSE42(const double *row0, const double *row1, int nwindows, double *sums) {
+	int icol = 0;
+	for(; icol + 2 <= nwindows; icol += 2){
+		__m128d adcsum = _mm_add_pd(_mm_setzero_pd(), _mm_loadu_pd(row0 + icol));
+		adcsum = _mm_add_pd(adcsum, _mm_loadu_pd(row0 + icol + 1));
+		adcsum = _mm_add_pd(adcsum, _mm_loadu_pd(row1 + icol));
+		adcsum = _mm_add_pd(adcsum, _mm_loadu_pd(row1 + icol + 1));
+		_mm_storeu_pd(sums + icol, adcsum);
+	}
+	SumWindows2x2Generic(row0 + icol, row1 + icol, nwindows - icol, sums + icol);
+}
+
+__attribute__((target("sse4.2")))
+void AddLanesSSE42(const double *values, int n, double *sums) {
+	int i = 0;
+	for(; i + 2 <= n; i += 2) _mm_storeu_pd(sums + i, _mm_add_pd(_mm_loadu_pd(sums + i), _mm_loadu_pd(values + i)));
+	AddLanesGeneric(values + i, n - i, sums + i);
+}
+
+__attribute__((target("sse4.2")))
+void MaxLanesSSE42(const double *values, int n, double *max) {
+	int i = 0;
+	for(; i + 2 <= n; i += 2) _mm_storeu_pd(max + i, _mm_max_pd(_mm_loadu_pd(values + i), _mm_loadu_pd(max + i)));
+	MaxLanesGeneric(values + i, n - i, max + i);
+}
+
+__attribute__((target("sse4.2")))
+void ComputeBinsSSE42(const double *values, int n, double min, double scale, int nbins, int32_t *bins) {
+	const __m128d vmin = _mm_set1_pd(min), vscale = _mm_set1_pd(scale), lowest = _mm_set1_pd(-1.), highest = _mm_set1_pd(nbins), one = _mm_set1_pd(1.);
+	int i = 0;
+	for(; i + 2 <= n; i += 2){
+		__m128d bin = _mm_floor_pd(_mm_mul_pd(_mm_sub_pd(_mm_loadu_pd(values + i), vmin), vscale));
+		bin = _mm_min_pd(_mm_max_pd(bin, lowest), highest);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(bins + i), _mm_cvtpd_epi32(_mm_add_pd(bin, one)));
+	}
+	ComputeBinsGeneric(values + i, n - i, min, scale, nbins, bins + i);
+}
+
+// AVX2 variants, 4 lanes
+__attribute__((target("avx2")))
+void SumWindows2x2AVX2(const double *row0, const double *row1, int nwindows, double *sums) {
+	int icol = 0;
+	for(; icol + 4 <= nwindows; icol += 4){
+		__m256d adcsum = _mm256_add_pd(_mm256_setzero_pd(), _mm256_loadu_pd(row0 + icol));
+		adcsum = _mm256_add_pd(adcsum, _mm256_loadu_pd(row0 + icol + 1));
+		adcsum = _mm256_add_pd(adcsum, _mm256_loadu_pd(row1 + icol));
+		adcsum = _mm256_add_pd(adcsum, _mm256_loadu_pd(row1 + icol + 1));
+		_mm256_storeu_pd(sums + icol, adcsum);
+	}
+	SumWindows2x2Generic(row0 + icol, row1 + icol, nwindows - icol, sums + icol);
+}
+
+__attribute__((target("avx2")))
+void AddLanesAVX2(const double *values, int n, double *sums) {
+	int i = 0;
+	for(; i + 4 <= n; i += 4) _mm256_storeu_pd(sums + i, _mm256_add_pd(_mm256_loadu_pd(sums + i), _mm256_loadu_pd(values + i)));
+	AddLanesGeneric(values + i, n - i, sums + i);
+}
+
+__attribute__((target("avx2")))
+void MaxLanesAVX2(const double *values, int n, double *max) {
+	int i = 0;
+	for(; i + 4 <= n; i += 4) _mm256_storeu_pd(max + i, _mm256_max_pd(_mm256_loadu_pd(values + i), _mm256_loadu_pd(max + i)));
+	MaxLanesGeneric(values + i, n - i, max + i);
+}
+
+__attribute__((target("avx2")))
+void ComputeBinsAVX2(const double *values, int n, double min, double scale, int nbins, int32_t *bins) {
+	const __m256d vmin = _mm256_set1_pd(min), vscale = _mm256_set1_pd(scale), lowest = _mm256_set1_pd(-1.), highest = _mm256_set1_pd(nbins), one = _mm256_set1_pd(1.);
+	int i = 0;
+	for(; i + 4 <= n; i += 4){
+		__m256d bin = _mm256_floor_pd(_mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(values + i), vmin), vscale));
+		bin = _mm256_min_pd(_mm256_max_pd(bin, lowest), highest);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(bins + i), _mm256_cvtpd_epi32(_mm256_add_pd(bin, one)));
+	}
+	ComputeBinsGeneric(values + i, n - i, min, scale, nbins, bins + i);
+}
+
+// AVX-512 variants, 8 lanes
+__attribute__((target("avx512f")))
+void SumWindows2x2AVX512(const double *row0, const double *row1, int nwindows, double *sums) {
+	int icol = 0;
+	for(; icol + 8 <= nwindows; icol += 8){
+		__m512d adcsum = _mm512_add_pd(_mm512_setzero_pd(), _mm512_loadu_pd(row0 + icol));
+		adcsum = _mm512_add_pd(adcsum, _mm512_loadu_pd(row0 + icol + 1));
+		adcsum = _mm512_add_pd(adcsum, _mm512_loadu_pd(row1 + icol));
+		adcsum = _mm512_add_pd(adcsum, _mm512_loadu_pd(row1 + icol + 1));
+		_mm512_storeu_pd(sums + icol, adcsum);
+	}
+	SumWindows2x2Generic(row0 + icol, row1 + icol, nwindows - icol, sums + icol);
+}
+
+__attribute__((target("avx512f")))
+void AddLanesAVX512(const double *values, int n, double *sums) {
+	int i = 0;
+	for(; i + 8 <= n; i += 8) _mm512_storeu_pd(sums + i, _mm512_add_pd(_mm512_loadu_pd(sums + i), _mm512_loadu_pd(values + i)));
+	AddLanesGeneric(values + i, n - i, sums + i);
+}
+
+__attribute__((target("avx512f")))
+void MaxLanesAVX512(const double *values, int n, double *max) {
+	int i = 0;
+	for(; i + 8 <= n; i += 8) _mm512_storeu_pd(max + i, _mm512_max_pd(_mm512_loadu_pd(values + i), _mm512_loadu_pd(max + i)));
+	MaxLanesGeneric(values + i, n - i, max + i);
+}
+
+__attribute__((target("avx512f")))
+void ComputeBinsAVX512(const double *values, int n, double min, double scale, int nbins, int32_t *bins) {
+	const __m512d vmin = _mm512_set1_pd(min), vscale = _mm512_set1_pd(scale), lowest = _mm512_set1_pd(-1.), highest = _mm512_set1_pd(nbins), one = _mm512_set1_pd(1.);
+	int i = 0;
+	for(; i + 8 <= n; i += 8){
+		__m512d bin = _mm512_roundscale_pd(_mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(values + i), vmin), vscale), _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+		bin = _mm512_min_pd(_mm512_max_pd(bin, lowest), highest);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(bins + i), _mm512_cvtpd_epi32(_mm512_add_pd(bin, one)));
+	}
+	ComputeBinsGeneric(values + i, n - i, min, scale, nbins, bins + i);
+}
+#endif
+
+const TriggerKernels::KernelTable kKernelTables[TriggerKernels::kNISAs] = {
+	{TriggerKernels::kGeneric, &SumWindows2x2Generic, &AddLanesGeneric, &MaxLanesGeneric, &ComputeBinsGeneric},
+#ifdef ETF_KERNELS_X86
+	{TriggerKernels::kSSE42, &SumWindows2x2SSE42, &AddLanesSSE42, &MaxLanesSSE42, &ComputeBinsSSE42},
+	{TriggerKernels::kAVX2, &SumWindows2x2AVX2, &AddLanesAVX2, &MaxLanesAVX2, &ComputeBinsAVX2},
+	{TriggerKernels::kAVX512, &SumWindows2x2AVX512, &AddLanesAVX512, &MaxLanesAVX512, &ComputeBinsAVX512}
+#else
+	{TriggerKernels::kGeneric, &SumWindows2x2Generic, &AddLanesGeneric, &MaxLanesGeneric, &ComputeBinsGeneric},
+	{TriggerKernels::kGeneric, &SumWindows2x2Generic, &AddLanesGeneric, &MaxLanesGeneric, &ComputeBinsGeneric},
+	{TriggerKernels::kGeneric, &SumWindows2x2Generic, &AddLanesGeneric, &MaxLanesGeneric, &ComputeBinsGeneric}
+#endif
+};
+
+}
+
+/**
+ * Get the widest instruction set supported by the CPU
+ * @return Instruction set
+ */
+TriggerKernels::ISA TriggerKernels::GetBestISA() {
+	for(int isa = kNISAs - 1; isa > kGeneric; isa--)
+		if(IsSupported(static_cast<ISA>(isa))) return static_cast<ISA>(isa);
+	return kGeneric;
+}
+
+/**
+ * Check whether kernels of an instruction set can run on the CPU
+ * @param isa Instruction set
+ * @return True if the CPU supports the instruction set (always true for kGeneric)
+ */
+bool TriggerKernels::IsSupported(ISA isa) {
+	if(isa == kGeneric) return true;
+#ifdef ETF_KERNELS_X86
+	__builtin_cpu_init();
+	switch(isa){
+	case kSSE42: return __builtin_cpu_supports("sse4.2");
+	case kAVX2: return __builtin_cpu_supports("avx2");
+	case kAVX512: return __builtin_cpu_supports("avx512f");
+	default: break;
+	};
+#endif
+	return false;
+}
+
+/**
+ * Select the instruction set of the kernels: the one requested in the environment variable
+ * ETF_KERNEL_ISA if set and supported by the CPU, otherwise the widest supported one
+ * @return Selected instruction set
+ */
+TriggerKernels::ISA TriggerKernels::SelectISA() {
+	const char *requested = getenv("ETF_KERNEL_ISA");
+	ISA isa;
+	if(requested && GetISAFromName(requested, isa) && IsSupported(isa)) return isa;
+	return GetBestISA();
+}
+
+/**
+ * Get the kernels of an instruction set. In case the instruction set is not supported by
+ * the CPU, the kernels of the widest supported instruction set are returned instead.
+ * @param isa Instruction set
+ * @return Kernels (fISA gives the instruction set actually used)
+ */
+const TriggerKernels::KernelTable &TriggerKernels::GetKernels(ISA isa) {
+	if(isa < kGeneric || isa >= kNISAs || !IsSupported(isa)) isa = GetBestISA();
+	return kKernelTables[isa];
+}
+
+/**
+ * Get the name of an instruction set, as used in ETF_KERNEL_ISA
+ * @param isa Instruction set
+ * @return Name of the instruction set
+ */
+const char *TriggerKernels::GetISAName(ISA isa) {
+	if(isa < kGeneric || isa >= kNISAs) return "unknown";
+	return kISANames[isa];
+}
+
+/**
+ * Get the instruction set from its name
+ * @param name Name of the instruction set (generic, sse4.2, avx2, avx512)
+ * @param isa Output: instruction set
+ * @return True if the name is known
+ */
+bool TriggerKernels::GetISAFromName(const char *name, ISA &isa) {
+	for(int iisa = 0; iisa < kNISAs; iisa++){
+		if(strcmp(name, kISANames[iisa])) continue;
+		isa = static_cast<ISA>(iisa);
+		return true;
+	}
+	return false;
+}
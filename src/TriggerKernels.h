@@ -0,0 +1,55 @@
+#ifndef TRIGGERKERNELS_H
+#define TRIGGERKERNELS_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <stdint.h>
+
+/**
+ * @class TriggerKernels
+ * @brief Vector kernels of the patch finding, compiled for several instruction sets
+ *
+ * The inner loops of the window summation and of the histogram binning are compiled in variants for the generic
+ * x86-64 instruction set, SSE4.2, AVX2 and AVX-512, in the same library without
+ * architecture flags. The widest variant supported by the CPU is selected at run time
+ * (cpuid). For tests of the single variants the selection can be overridden with the
+ * environment variable ETF_KERNEL_ISA (generic, sse4.2, avx2, avx512); variants not
+ * supported by the CPU are never selected. All variants compute in the same order, so the
+ * results are identical. On other architectures or compilers only the generic variant
+ * is available.
+ */
+class TriggerKernels {
+public:
+	enum ISA {
+		kGeneric = 0,
+		kSSE42,
+		kAVX2,
+		kAVX512,
+		kNISAs
+	};
+
+	/**
+	 * @struct KernelTable
+	 * @brief Kernels of one instruction set
+	 */
+	struct KernelTable {
+		ISA		fISA;																			///< Instruction set of the kernels
+		void	(*fSumWindows2x2)(const double *row0, const double *row1, int nwindows, double *sums);	///< 2x2 window sums of a pair of rows
+		void	(*fAddLanes)(const double *values, int n, double *sums);							///< Element-wise sum: sums[i] += values[i]
+		void	(*fMaxLanes)(const double *values, int n, double *max);								///< Element-wise max: max[i] = max(values[i], max[i])
+		void	(*fComputeBins)(const double *values, int n, double min, double scale, int nbins, int32_t *bins);	///< Histogram bins (0: underflow, nbins + 1: overflow)
+	};
+
+	static ISA GetBestISA();
+	static bool IsSupported(ISA isa);
+	static ISA SelectISA();
+	static const KernelTable &GetKernels(ISA isa);
+	static const char *GetISAName(ISA isa);
+	static bool GetISAFromName(const char *name, ISA &isa);
+};
+
+#endif /* TRIGGERKERNELS_H */
@@ -16,192 +16,367 @@
  *  You should have received a copy of the GNU General Public License           *
  *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
  ********************************************************************************/
+#include <algorithm>
+
 #include "TriggerMaker.h"
 
 /**
  * Constructor, initializing channel maps for EMCAL and DCAL-PHOS
  */
 TriggerMaker::TriggerMaker() :
-	fJetTrigger(),
-	fGammaTrigger(),
+	fAlgorithms(),
+	fFusedScan(),
 	fTriggerChannelsEMCAL(48, 64),
 	fTriggerChannelsDCALPHOS(48, 40),
+	fRegionsEMCAL(48, 64),
+	fRegionsDCALPHOS(48, 40),
+	fSubregionsEMCAL(48, 64),
+	fSubregionsDCALPHOS(48, 40),
+	fDigitizerEMCAL(48, 64),
+	fDigitizerDCALPHOS(48, 40),
+	fShowerModel(),
 	fTriggerMapping(),
+	fMapping(&fTriggerMapping),
 	fBadChannelsEMCAL(),
 	fBadChannelsDCALPHOS(),
-	fHasRun(false),
 	fAcceptPHOSPatches(true),
-	fGammaEMCAL(),
-	fGammaDCALPHOS(),
-	fJetEMCAL(),
-	fJetDCALPHOS(),
-	fJetEMCAL8x8(),
-	fJetDCALPHOS8x8()
+	fShowerSpreading(false),
+	fLevel0Enabled(false),
+	fHasSubregionsEMCAL(false),
+	fHasSubregionsDCALPHOS(false),
+	fExclusionRegionsEMCAL(),
+	fExclusionRegionsDCALPHOS()
 {
-	fJetTrigger.SetTriggerSetup(&fTriggerSetup);
-	fGammaTrigger.SetTriggerSetup(&fTriggerSetup);
+	for(int icat = 0; icat < kNPatchCategories; icat++){
+		fCategoryAlgorithms[icat] = NULL;
+		fCategoryEnabled[icat] = true;
+		fDefaultAlgorithm[icat] = false;
+	}
+	fFusedScan.SetTriggerSetup(&fTriggerSetup);
+	AddDefaultAlgorithms();
 }
 
 /**
- * Destructor
+ * Destructor, deleting the registered patch finders
  */
 TriggerMaker::~TriggerMaker() {
+	ClearAlgorithms();
 }
 
 /**
- * Reset channel maps
+ * Register a patch finder. The trigger maker takes ownership of the algorithm. The
+ * patch category is defined by the algorithm (see TriggerAlgorithm::GetCategory),
+ * an algorithm already registered for the same category is replaced. Patch finders
+ * are run in the order of registration.
+ * @param algorithm Patch finder to be registered
+ * @throw InvalidCategoryException in case the algorithm doesn't produce a gamma, jet or Level0 category
  */
-void TriggerMaker::Reset() {
-	fTriggerChannelsEMCAL.Reset();
-	fTriggerChannelsDCALPHOS.Reset();
-	fGammaEMCAL.clear();
-	fGammaDCALPHOS.clear();
-	fJetEMCAL.clear();
-	fJetDCALPHOS.clear();
-	fJetEMCAL8x8.clear();
-	fJetDCALPHOS8x8.clear();
-	fHasRun = false;
+void TriggerMaker::AddAlgorithm(TriggerAlgorithm *algorithm) {
+	RegisterAlgorithm(algorithm, false);
 }
 
 /**
- * Main function to reconstruct trigger patches in the EMCAL and in the DCAL-PHOS.
- * Patches are found using the trigger channels map, which has to be filled from outside.
- * The order in the output list is:
- * #- EMCAL gamma
- * #- DCAL-PHOS gamma
- * #- EMCAL jet
- * #- DCAL-PHOS jet
- * @return vector with all trigger patches.
+ * Register a patch finder, see AddAlgorithm. Categories of standard patch finders
+ * are evaluated in the fused scan of the detector in FindPatches.
+ * @param algorithm Patch finder to be registered
+ * @param isDefault True if the algorithm is a standard patch finder
  */
+void TriggerMaker::RegisterAlgorithm(TriggerAlgorithm *algorithm, bool isDefault) {
+	int index(0);
+	try {
+		index = GetCategoryIndex(algorithm->GetCategory());
+	} catch(InvalidCategoryException &) {
+		delete algorithm;
+		throw;
+	}
+	algorithm->SetTriggerSetup(&fTriggerSetup);
+	if(fCategoryAlgorithms[index]){
+		std::replace(fAlgorithms.begin(), fAlgorithms.end(), fCategoryAlgorithms[index], algorithm);
+		delete fCategoryAlgorithms[index];
+	} else {
+		fAlgorithms.push_back(algorithm);
+	}
+	fCategoryAlgorithms[index] = algorithm;
+	fDefaultAlgorithm[index] = isDefault;
+	// Patches of the replaced algorithm are not valid any more
+	fPatches[index].clear();
+	fHasRun[index] = false;
+	UpdatePatchMasks();
+}
 
-void TriggerMaker::FindPatches() {
-
-	fGammaEMCAL     = fGammaTrigger.FindPatches 	(	&fTriggerChannelsEMCAL		);
-	fGammaDCALPHOS  = fGammaTrigger.FindPatches 	(	&fTriggerChannelsDCALPHOS	);
-	fJetEMCAL       = fJetTrigger.  FindPatches 	(	&fTriggerChannelsEMCAL		);
-	fJetDCALPHOS    = fJetTrigger.  FindPatches 	(	&fTriggerChannelsDCALPHOS	);
-	fJetEMCAL8x8    = fJetTrigger.  FindPatches8x8	(	&fTriggerChannelsEMCAL		);
-	fJetDCALPHOS8x8 = fJetTrigger.  FindPatches8x8	(	&fTriggerChannelsDCALPHOS	);
+/**
+ * Register the standard patch finders: gamma, jet (16x16 and 8x8) and Level0
+ * for EMCAL and DCAL-PHOS.
+ */
+void TriggerMaker::AddDefaultAlgorithms() {
+	RawPatch::Patchtype detectors[2] = {RawPatch::kEMCALpatch, RawPatch::kDCALPHOSpatch};
+	std::vector<TriggerAlgorithm *> algorithms;
+	for(int idet = 0; idet < 2; idet++){
+		algorithms.push_back(new GammaTriggerAlgorithm);
+		algorithms.push_back(new JetTriggerAlgorithm(16));
+		algorithms.push_back(new JetTriggerAlgorithm(8));
+		for(std::vector<TriggerAlgorithm *>::iterator algiter = algorithms.end() - 3; algiter != algorithms.end(); ++algiter)
+			(*algiter)->SetDetector(detectors[idet]);
+	}
+	for(int idet = 0; idet < 2; idet++){
+		algorithms.push_back(new Level0TriggerAlgorithm);
+		algorithms.back()->SetDetector(detectors[idet]);
+	}
+	for(std::vector<TriggerAlgorithm *>::iterator algiter = algorithms.begin(); algiter != algorithms.end(); ++algiter)
+		RegisterAlgorithm(*algiter, true);
+}
 
-	fHasRun = true;
+/**
+ * Remove and delete all registered patch finders. Categories without patch finder don't
+ * have any patches.
+ */
+void TriggerMaker::ClearAlgorithms() {
+	for(std::vector<TriggerAlgorithm *>::iterator algiter = fAlgorithms.begin(); algiter != fAlgorithms.end(); ++algiter)
+		delete *algiter;
+	fAlgorithms.clear();
+	for(int icat = 0; icat < kNPatchCategories; icat++){
+		fCategoryAlgorithms[icat] = NULL;
+		fDefaultAlgorithm[icat] = false;
+		fPatches[icat].clear();
+		fHasRun[icat] = false;
+	}
 }
 
-std::vector<RawPatch> TriggerMaker::GetPatches(const int what) {
-	if (fHasRun == false)
-		FindPatches();
+/**
+ * Get the patch finder registered for a patch category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Patch finder of the category (NULL if none is registered)
+ */
+const TriggerAlgorithm *TriggerMaker::GetAlgorithm(int category) const {
+	return fCategoryAlgorithms[GetCategoryIndex(category)];
+}
 
-	std::vector<RawPatch> result;
+/**
+ * Switch on or off the patch finding for a patch category. Disabled categories are
+ * skipped in FindPatches and don't have any patches, also if requested explicitly.
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @param doEnable If true patches of the category are found
+ */
+void TriggerMaker::SetCategoryEnabled(int category, bool doEnable) {
+	int index = GetCategoryIndex(category);
+	if(fCategoryEnabled[index] == doEnable) return;
+	fCategoryEnabled[index] = doEnable;
+	fPatches[index].clear();
+	fHasRun[index] = false;
+}
 
-	if (what == RawPatch::kAny || what == RawPatch::kEMCALpatchGA ) {
-		for (std::vector<RawPatch>::iterator patchiter = fGammaEMCAL.begin(); patchiter != fGammaEMCAL.end(); patchiter++) {
-			patchiter->SetPatchType(RawPatch::kEMCALpatch);
-			result.push_back(*patchiter);
-		}
-	}
+/**
+ * Check whether the patch finding is switched on for a patch category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return True if patches of the category are found
+ */
+bool TriggerMaker::IsCategoryEnabled(int category) const {
+	return fCategoryEnabled[GetCategoryIndex(category)];
+}
 
-	if (what == RawPatch::kAny || what == RawPatch::kDCALpatchGA ) {
-		for (std::vector<RawPatch>::iterator patchiter = fGammaDCALPHOS.begin(); patchiter != fGammaDCALPHOS.end(); patchiter++) {
-			if(!fAcceptPHOSPatches && IsPHOSPatch(patchiter->GetColStart(), patchiter->GetRowStart(), 2)) continue;
-			patchiter->SetPatchType(RawPatch::kDCALPHOSpatch);
-			result.push_back(*patchiter);
-		}
+/**
+ * Reset channel maps
+ */
+void TriggerMaker::Reset() {
+	fTriggerChannelsEMCAL.Reset();
+	fTriggerChannelsDCALPHOS.Reset();
+	fHasSubregionsEMCAL = fHasSubregionsDCALPHOS = false;
+	for(int icat = 0; icat < kNPatchCategories; icat++){
+		fPatches[icat].clear();
+		fHasRun[icat] = false;
 	}
+}
 
-	if (what == RawPatch::kAny || what == RawPatch::kEMCALpatchJE ) {
-		for (std::vector<RawPatch>::iterator patchiter = fJetEMCAL.begin(); patchiter != fJetEMCAL.end(); patchiter++) {
-			patchiter->SetPatchType(RawPatch::kEMCALpatch);
-			result.push_back(*patchiter);
-		}
-	}
+/**
+ * Convert the energies filled into the channel maps into FastOR amplitudes, applying the
+ * response emulation configured in the digitizers of EMCAL and DCAL-PHOS (see TriggerDigitizer).
+ * Has to be called once per event after filling the channel maps and before requesting patches.
+ * Bad channels are not modified.
+ * @param seed Seed of the event (e.g. the event number), random numbers only depend on it
+ */
+void TriggerMaker::Digitize(uint64_t seed) {
+	fDigitizerEMCAL.Digitize(fTriggerChannelsEMCAL, seed, 0, &fBadChannelsEMCAL);
+	fDigitizerDCALPHOS.Digitize(fTriggerChannelsDCALPHOS, seed, 1, &fBadChannelsDCALPHOS);
+	fHasSubregionsEMCAL = fHasSubregionsDCALPHOS = false;
+	for(int icat = 0; icat < kNPatchCategories; icat++) fHasRun[icat] = false;
+}
 
-	if (what == RawPatch::kAny || what == RawPatch::kDCALpatchJE ) {
-		for (std::vector<RawPatch>::iterator patchiter = fJetDCALPHOS.begin(); patchiter != fJetDCALPHOS.end(); patchiter++) {
-			if(!fAcceptPHOSPatches && IsPHOSPatch(patchiter->GetColStart(), patchiter->GetRowStart(), 16)) continue;
-			patchiter->SetPatchType(RawPatch::kDCALPHOSpatch);
-			result.push_back(*patchiter);
-		}
+/**
+ * Main function to reconstruct trigger patches in the EMCAL and in the DCAL-PHOS.
+ * Patches are found using the trigger channels map, which has to be filled from outside.
+ * All enabled categories are (re-)evaluated, Level0 categories only if the Level0 trigger
+ * is enabled: categories of the standard patch finders in one fused scan per detector
+ * (see TriggerFusedScan), the other registered patch finders in the order of registration.
+ * Getters for single categories only evaluate the category requested in case the patches
+ * for this category are not yet available.
+ */
+void TriggerMaker::FindPatches() {
+	fHasSubregionsEMCAL = fHasSubregionsDCALPHOS = false;
+	for(int icat = 0; icat < kNPatchCategories; icat++) fHasRun[icat] = false;
+	ScanDetector(false);
+	ScanDetector(true);
+	for(std::vector<TriggerAlgorithm *>::const_iterator algiter = fAlgorithms.begin(); algiter != fAlgorithms.end(); ++algiter){
+		int category = (*algiter)->GetCategory();
+		if(fHasRun[GetCategoryIndex(category)] || !IsCategorySelected(category, RawPatch::kAny)) continue;
+		EvaluateCategory(category);
 	}
+}
 
-	if (what == RawPatch::kAny || what == RawPatch::kEMCALpatchJE8x8 ) {
-		for (std::vector<RawPatch>::iterator patchiter = fJetEMCAL8x8.begin(); patchiter != fJetEMCAL8x8.end(); patchiter++) {
-			patchiter->SetPatchType(RawPatch::kEMCALpatch);
-			result.push_back(*patchiter);
-		}
+/**
+ * Evaluate all enabled categories (Level0 categories only if the Level0 trigger is enabled)
+ * like FindPatches, but only determine the event summary per category. Categories of the
+ * standard patch finders are summarized during the fused scan without building patch lists,
+ * so patches of these categories are found again if requested after this call. Categories
+ * of other registered patch finders are evaluated to patch lists and summarized from them.
+ * @param summary Event summary, reset and filled for all categories
+ */
+void TriggerMaker::FindSummary(TriggerSummary &summary) {
+	summary.Reset();
+	fHasSubregionsEMCAL = fHasSubregionsDCALPHOS = false;
+	for(int icat = 0; icat < kNPatchCategories; icat++) fHasRun[icat] = false;
+	ScanDetector(false, &summary);
+	ScanDetector(true, &summary);
+	for(std::vector<TriggerAlgorithm *>::const_iterator algiter = fAlgorithms.begin(); algiter != fAlgorithms.end(); ++algiter){
+		int category = (*algiter)->GetCategory(), index = GetCategoryIndex(category);
+		if(fDefaultAlgorithm[index] || !IsCategorySelected(category, RawPatch::kAny)) continue;
+		EvaluateCategory(category);
+		summary.Fill(category, fPatches[index]);
 	}
+}
 
-	if (what == RawPatch::kAny || what == RawPatch::kDCALpatchJE8x8 ) {
-		for (std::vector<RawPatch>::iterator patchiter = fJetDCALPHOS8x8.begin(); patchiter != fJetDCALPHOS8x8.end(); patchiter++) {
-			if(!fAcceptPHOSPatches && IsPHOSPatch(patchiter->GetColStart(), patchiter->GetRowStart(), 8)) continue;
-			patchiter->SetPatchType(RawPatch::kDCALPHOSpatch);
-			result.push_back(*patchiter);
-		}
+/**
+ * Get a read-only view on the patches of one or all patch categories, without copying
+ * the patches. Patch types are assigned and patches 100% in PHOS (if not accepted) or in
+ * exclusion regions are rejected during the patch finding, so repeated queries don't have
+ * any extra cost.
+ * Patches of the requested categories are found if not yet done for this event. The
+ * range is only valid until the trigger maker is reset or the patches are found again.
+ * @param what Patch category, or RawPatch::kAny for all categories
+ * @return Range over the patches of the selected categories
+ */
+TriggerPatchRange TriggerMaker::GetPatchRange(const int what) {
+	TriggerPatchRange result;
+	for(int category = RawPatch::kEMCALpatchGA; category <= RawPatch::kDCALpatchL0; category++){
+		if(!IsCategorySelected(category, what)) continue;
+		const std::vector<PackedRawPatch> &patches = GetCategoryPatches(category);
+		if(!patches.empty()) result.AddSegment(&patches.front(), &patches.front() + patches.size());
 	}
+	return result;
+}
 
+/**
+ * Get a copy of the patches of one or all patch categories, converted to RawPatch
+ * @param what Patch category, or RawPatch::kAny for all categories
+ * @return List of patches of the selected categories
+ */
+std::vector<RawPatch> TriggerMaker::GetPatches(const int what) {
+	TriggerPatchRange patches = GetPatchRange(what);
+	std::vector<RawPatch> result;
+	result.reserve(patches.size());
+	for(TriggerPatchRange::const_iterator patchiter = patches.begin(); patchiter != patches.end(); ++patchiter)
+		result.push_back(patchiter->ToRawPatch());
 	return result;
 }
 
+/**
+ * Switch whether patches 100% in PHOS are accepted. The PHOS acceptance is compiled into
+ * the patch masks of the DCAL-PHOS categories, so that rejected patches are not created
+ * in the patch finding. In case the setting changes, patches are found again at the next request.
+ * @param doAccept switch whether we accept or not
+ */
+void TriggerMaker::SetAcceptPHOSPatches(bool doAccept) {
+	if(doAccept == fAcceptPHOSPatches) return;
+	fAcceptPHOSPatches = doAccept;
+	UpdatePatchMasks();
+}
+
+/**
+ * Exclude a region of the EMCAL from the patch finding, e.g. a hot spot. Patches
+ * with at least one FastOR in the region are rejected in all EMCAL patch categories.
+ * @param region Region in col-row space of the EMCAL channel map (limits inclusive)
+ */
+void TriggerMaker::AddExclusionRegionEMCAL(const TriggerRegionMap::Region &region) {
+	fExclusionRegionsEMCAL.push_back(region);
+	UpdatePatchMasks();
+}
+
+/**
+ * Exclude a region of the DCAL-PHOS from the patch finding, e.g. a hot spot. Patches
+ * with at least one FastOR in the region are rejected in all DCAL-PHOS patch categories.
+ * @param region Region in col-row space of the DCAL-PHOS channel map (limits inclusive)
+ */
+void TriggerMaker::AddExclusionRegionDCALPHOS(const TriggerRegionMap::Region &region) {
+	fExclusionRegionsDCALPHOS.push_back(region);
+	UpdatePatchMasks();
+}
+
+/**
+ * Remove all exclusion regions of EMCAL and DCAL-PHOS
+ */
+void TriggerMaker::ClearExclusionRegions() {
+	fExclusionRegionsEMCAL.clear();
+	fExclusionRegionsDCALPHOS.clear();
+	UpdatePatchMasks();
+}
+
 bool TriggerMaker::IsPHOSPatch(int col, int row, int size){
 	return (col >= kMinEtaPHOS) && (col+size <kMaxEtaPHOS) && (row >= kMinRowPHOS) && (row+size < kMaxRowPHOS);
 }
 
-RawPatch TriggerMaker::GetMaxGammaEMCAL()
+/**
+ * Get the patch with the highest amplitude for a given patch category, among patches
+ * with the same amplitude the one with the lowest start row and column (see
+ * PackedRawPatch::GetMaxPatch). Patches of the category are found if not yet done for this event.
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Patch with the highest amplitude (default patch if no patch was found)
+ */
+RawPatch TriggerMaker::GetMaxPatch(int category)
 {
-	if (fHasRun == false)
-		FindPatches();
-	if (fGammaEMCAL.empty())
+	const std::vector<PackedRawPatch> &patches = GetCategoryPatches(category);
+	if (patches.empty())
 		return RawPatch();
 	else
-		return fGammaEMCAL.back();
+		return PackedRawPatch::GetMaxPatch(patches).ToRawPatch();
+}
+
+RawPatch TriggerMaker::GetMaxGammaEMCAL()
+{
+	return GetMaxPatch(RawPatch::kEMCALpatchGA);
 }
 
 RawPatch TriggerMaker::GetMaxGammaDCALPHOS()
 {
-	if (fHasRun == false)
-		FindPatches();
-	if (fGammaDCALPHOS.empty())
-		return RawPatch();
-	else
-		return fGammaDCALPHOS.back();
+	return GetMaxPatch(RawPatch::kDCALpatchGA);
 }
 
 RawPatch TriggerMaker::GetMaxJetEMCAL()
 {
-	if (fHasRun == false)
-		FindPatches();
-	if (fJetEMCAL.empty())
-		return RawPatch();
-	else
-		return fJetEMCAL.back();
+	return GetMaxPatch(RawPatch::kEMCALpatchJE);
 }
 
 RawPatch TriggerMaker::GetMaxJetDCALPHOS()
 {
-	if (fHasRun == false)
-		FindPatches();
-	if (fJetDCALPHOS.empty())
-		return RawPatch();
-	else
-		return fJetDCALPHOS.back();
+	return GetMaxPatch(RawPatch::kDCALpatchJE);
 }
 
 RawPatch TriggerMaker::GetMaxJetEMCAL8x8()
 {
-	if (fHasRun == false)
-		FindPatches();
-	if (fJetEMCAL8x8.empty())
-		return RawPatch();
-	else
-		return fJetEMCAL8x8.back();
+	return GetMaxPatch(RawPatch::kEMCALpatchJE8x8);
 }
 
 RawPatch TriggerMaker::GetMaxJetDCALPHOS8x8()
 {
-	if (fHasRun == false)
-		FindPatches();
-	if (fJetDCALPHOS8x8.empty())
-		return RawPatch();
-	else
-		return fJetDCALPHOS8x8.back();
+	return GetMaxPatch(RawPatch::kDCALpatchJE8x8);
+}
+
+RawPatch TriggerMaker::GetMaxLevel0EMCAL()
+{
+	return GetMaxPatch(RawPatch::kEMCALpatchL0);
+}
+
+RawPatch TriggerMaker::GetMaxLevel0DCALPHOS()
+{
+	return GetMaxPatch(RawPatch::kDCALpatchL0);
 }
 
 double TriggerMaker::GetMedian(std::vector<RawPatch> v)
@@ -224,46 +399,275 @@ double TriggerMaker::GetMedian(std::vector<RawPatch> v)
 	return median;
 }
 
+/**
+ * Get the median amplitude of a list of compact patches, sorted by amplitude
+ * @param v Sorted list of patches
+ * @return Median amplitude (0 for an empty list)
+ */
+double TriggerMaker::GetMedian(const std::vector<PackedRawPatch> &v) const
+{
+	double median = 0;
+	size_t size = v.size();
+
+	if (size > 0)
+	{
+		size_t halfsize = v.size() / 2;
+		if (size % 2 == 0)
+		{
+			median = (v[halfsize - 1].GetADC() + v[halfsize].GetADC()) / 2;
+		}
+		else
+		{
+			median = v[halfsize].GetADC();
+		}
+	}
+	return median;
+}
+
+/**
+ * Get the median amplitude of all patches for a given patch category.
+ * Patches of the category are found if not yet done for this event.
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Median amplitude (0 if no patch was found)
+ */
+double TriggerMaker::GetMedianADC(int category)
+{
+	return GetMedian(GetCategoryPatches(category));
+}
+
 double TriggerMaker::GetMedianGammaEMCAL()
 {
-	if (fHasRun == false)
-		FindPatches();
-	return GetMedian(fGammaEMCAL);
+	return GetMedianADC(RawPatch::kEMCALpatchGA);
 }
 
 double TriggerMaker::GetMedianGammaDCALPHOS()
 {
-	if (fHasRun == false)
-		FindPatches();
-	return GetMedian(fGammaDCALPHOS);
+	return GetMedianADC(RawPatch::kDCALpatchGA);
 }
 
 double TriggerMaker::GetMedianJetEMCAL()
 {
-	if (fHasRun == false)
-		FindPatches();
-	return GetMedian(fJetEMCAL);
+	return GetMedianADC(RawPatch::kEMCALpatchJE);
 }
 
 double TriggerMaker::GetMedianJetDCALPHOS()
 {
-	if (fHasRun == false)
-		FindPatches();
-	return GetMedian(fJetDCALPHOS);
+	return GetMedianADC(RawPatch::kDCALpatchJE);
 }
 
 double TriggerMaker::GetMedianJetEMCAL8x8()
 {
-	if (fHasRun == false)
-		FindPatches();
-	return GetMedian(fJetEMCAL8x8);
+	return GetMedianADC(RawPatch::kEMCALpatchJE8x8);
 }
 
 double TriggerMaker::GetMedianJetDCALPHOS8x8()
 {
-	if (fHasRun == false)
-		FindPatches();
-	return GetMedian(fJetDCALPHOS8x8);
+	return GetMedianADC(RawPatch::kDCALpatchJE8x8);
+}
+
+/**
+ * Run the patch finder of a single patch category on the corresponding channel map
+ * and mark the category as evaluated. The 4x4 subregion amplitudes are summed once per
+ * event for the patch finders requiring them. Categories without patch finder or
+ * disabled don't have any patches.
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ */
+void TriggerMaker::EvaluateCategory(int category) {
+	int index = GetCategoryIndex(category);
+	const TriggerAlgorithm *algorithm = fCategoryAlgorithms[index];
+	std::vector<PackedRawPatch> &patches = fPatches[index];
+	if(algorithm && fCategoryEnabled[index]){
+		bool isDCALPHOS = algorithm->IsDCALPHOS();
+		const TriggerChannelMap *channels = isDCALPHOS ? &fTriggerChannelsDCALPHOS : &fTriggerChannelsEMCAL;
+		const TriggerSubregionMap *subregions = algorithm->UsesSubregions() ? &GetSubregions(isDCALPHOS) : NULL;
+		algorithm->FindPatches(channels, subregions, patches, GetActivePatchMask(category));
+	} else {
+		patches.clear();
+	}
+	fHasRun[index] = true;
+}
+
+/**
+ * Find the patches of all selected categories of a detector which use a standard patch
+ * finder in a single pass over the channel map. The subregion amplitudes are summed in
+ * the same pass.
+ * @param isDCALPHOS If true the DCAL-PHOS is scanned, otherwise the EMCAL
+ * @param summary If not NULL, the categories are only summarized, without finding the patches
+ */
+void TriggerMaker::ScanDetector(bool isDCALPHOS, TriggerSummary *summary) {
+	RawPatch::Patchtype ptype = isDCALPHOS ? RawPatch::kDCALPHOSpatch : RawPatch::kEMCALpatch;
+	bool hasOutput(false);
+	fFusedScan.ClearOutputs();
+	for(int itype = 0; itype < TriggerFusedScan::kNOutputTypes; itype++){
+		TriggerFusedScan::OutputType type = static_cast<TriggerFusedScan::OutputType>(itype);
+		int category = TriggerFusedScan::GetCategory(type, ptype), index = GetCategoryIndex(category);
+		if(!fDefaultAlgorithm[index] || !IsCategorySelected(category, RawPatch::kAny)) continue;
+		if(summary){
+			fFusedScan.SetSummaryOutput(type, &summary->GetCategorySummary(category), GetActivePatchMask(category));
+		} else {
+			fFusedScan.SetOutput(type, &fPatches[index], GetActivePatchMask(category));
+			fHasRun[index] = true;
+		}
+		hasOutput = true;
+	}
+	if(!hasOutput) return;
+	if(isDCALPHOS){
+		fFusedScan.Scan(fTriggerChannelsDCALPHOS, fSubregionsDCALPHOS, ptype);
+		fHasSubregionsDCALPHOS = true;
+	} else {
+		fFusedScan.Scan(fTriggerChannelsEMCAL, fSubregionsEMCAL, ptype);
+		fHasSubregionsEMCAL = true;
+	}
+}
+
+/**
+ * Check whether a patch category is selected by a patch type selector. Categories
+ * without patch finder or disabled are never selected, Level0 categories are only
+ * selected by RawPatch::kAny if the Level0 trigger is enabled.
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @param what Patch category, or RawPatch::kAny for all categories
+ * @return True if the category is selected
+ */
+bool TriggerMaker::IsCategorySelected(int category, int what) const {
+	int index = GetCategoryIndex(category);
+	if(!(fCategoryAlgorithms[index] && fCategoryEnabled[index])) return false;
+	if(what == RawPatch::kAny) return fLevel0Enabled || !IsLevel0Category(category);
+	return what == category;
+}
+
+/**
+ * Get the 4x4 subregion amplitudes of one detector, summing them from the
+ * trigger channel map in case this was not yet done for this event.
+ * @param isDCALPHOS If true the DCAL-PHOS subregions are provided, otherwise the EMCAL subregions
+ * @return Subregion map of the detector
+ */
+const TriggerSubregionMap &TriggerMaker::GetSubregions(bool isDCALPHOS) {
+	if(isDCALPHOS){
+		if(!fHasSubregionsDCALPHOS) fSubregionsDCALPHOS.Fill(fTriggerChannelsDCALPHOS);
+		fHasSubregionsDCALPHOS = true;
+		return fSubregionsDCALPHOS;
+	}
+	if(!fHasSubregionsEMCAL) fSubregionsEMCAL.Fill(fTriggerChannelsEMCAL);
+	fHasSubregionsEMCAL = true;
+	return fSubregionsEMCAL;
+}
+
+/**
+ * Get the 4x4 subregion amplitudes of the EMCAL (12x16 subregions), e.g. for the
+ * estimation of the underlying event density. The amplitudes are summed once per
+ * event and shared with the jet patch finders.
+ * @return Subregion map of the EMCAL
+ */
+const TriggerSubregionMap &TriggerMaker::GetEMCALSubregions() {
+	return GetSubregions(false);
+}
+
+/**
+ * Get the 4x4 subregion amplitudes of the DCAL-PHOS (12x10 subregions), e.g. for the
+ * estimation of the underlying event density. The amplitudes are summed once per
+ * event and shared with the jet patch finders.
+ * @return Subregion map of the DCAL-PHOS
+ */
+const TriggerSubregionMap &TriggerMaker::GetDCALPHOSSubregions() {
+	return GetSubregions(true);
+}
+
+/**
+ * Get the patches of a given category, running the corresponding patch finder
+ * only in case the category was not yet evaluated for this event.
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Patches of the category, sorted by amplitude
+ */
+std::vector<PackedRawPatch> &TriggerMaker::GetCategoryPatches(int category) {
+	if (fHasRun[GetCategoryIndex(category)] == false)
+		EvaluateCategory(category);
+	return fPatches[GetCategoryIndex(category)];
+}
+
+/**
+ * Get the mask of accepted patch positions of a category to be applied in the patch finders
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Patch mask (NULL if all positions are accepted)
+ */
+const TriggerPatchMask *TriggerMaker::GetActivePatchMask(int category) const {
+	const TriggerPatchMask &mask = fPatchMasks[GetCategoryIndex(category)];
+	return mask.HasRejections() ? &mask : NULL;
+}
+
+/**
+ * Compile the PHOS acceptance and the exclusion regions into the patch masks of all
+ * categories. Patches are found again at the next request.
+ */
+void TriggerMaker::UpdatePatchMasks() {
+	for(int category = RawPatch::kEMCALpatchGA; category <= RawPatch::kDCALpatchL0; category++){
+		int index = GetCategoryIndex(category),
+				patchsize = fCategoryAlgorithms[index] ? fCategoryAlgorithms[index]->GetPatchSize() : GetCategoryPatchSize(category);
+		bool isDCALPHOS = IsDCALPHOSCategory(category);
+		const TriggerChannelMap &channels = isDCALPHOS ? fTriggerChannelsDCALPHOS : fTriggerChannelsEMCAL;
+		const std::vector<TriggerRegionMap::Region> &exclusions = isDCALPHOS ? fExclusionRegionsDCALPHOS : fExclusionRegionsEMCAL;
+		TriggerPatchMask &mask = fPatchMasks[index];
+		mask.Configure(channels.GetNumberOfCols(), channels.GetNumberOfRows(), patchsize);
+		if(isDCALPHOS && !fAcceptPHOSPatches){
+			for(int row = 0; row < channels.GetNumberOfRows(); row++)
+				for(int col = 0; col < channels.GetNumberOfCols(); col++)
+					if(IsPHOSPatch(col, row, patchsize)) mask.Reject(col, row);
+		}
+		for(std::vector<TriggerRegionMap::Region>::const_iterator regioniter = exclusions.begin(); regioniter != exclusions.end(); ++regioniter)
+			mask.RejectOverlapping(*regioniter);
+		fHasRun[index] = false;
+	}
+}
+
+/**
+ * Map the patch category to the index in the result arrays
+ * @param category Patch category
+ * @return Index of the category
+ * @throw InvalidCategoryException in case the category is not a gamma, jet or Level0 category
+ */
+int TriggerMaker::GetCategoryIndex(int category) {
+	if(category < RawPatch::kEMCALpatchGA || category > RawPatch::kDCALpatchL0)
+		throw InvalidCategoryException(category);
+	return category - RawPatch::kEMCALpatchGA;
+}
+
+/**
+ * Check whether the patch category belongs to the DCAL-PHOS
+ * @param category Patch category
+ * @return True if the patches of the category are found on the DCAL-PHOS channel map
+ */
+bool TriggerMaker::IsDCALPHOSCategory(int category) {
+	return category == RawPatch::kDCALpatchGA || category == RawPatch::kDCALpatchJE || category == RawPatch::kDCALpatchJE8x8 || category == RawPatch::kDCALpatchL0;
+}
+
+/**
+ * Check whether the patch category is a Level0 category
+ * @param category Patch category
+ * @return True if the category contains Level0 patches
+ */
+bool TriggerMaker::IsLevel0Category(int category) {
+	return category == RawPatch::kEMCALpatchL0 || category == RawPatch::kDCALpatchL0;
+}
+
+/**
+ * Get the patch size of the patches in a given patch category
+ * @param category Patch category
+ * @return Size of the patches in FastORs
+ */
+int TriggerMaker::GetCategoryPatchSize(int category) {
+	switch(category){
+	case RawPatch::kEMCALpatchGA:
+	case RawPatch::kDCALpatchGA:
+	case RawPatch::kEMCALpatchL0:
+	case RawPatch::kDCALpatchL0:
+		return 2;
+	case RawPatch::kEMCALpatchJE:
+	case RawPatch::kDCALpatchJE:
+		return 16;
+	case RawPatch::kEMCALpatchJE8x8:
+	case RawPatch::kDCALpatchJE8x8:
+		return 8;
+	};
+	return 0;
 }
 
 /**
@@ -275,12 +679,27 @@ double TriggerMaker::GetMedianJetDCALPHOS8x8()
  * @param energy Track/Particle energy
  */
 void TriggerMaker::FillChannelMap(double eta, double phi, double energy) {
-	TriggerChannel position = fTriggerMapping.GetPositionFromEtaPhi(eta, phi);
-	if (position.IsEMCAL()) {
-		if (!fBadChannelsEMCAL.HasChannel(position.GetCol(), position.GetRow()))
-			fTriggerChannelsEMCAL.AddADC(position.GetCol(), position.GetRow(), energy);
-	} else if (position.IsDCALPHOS()) {
-		if (!fBadChannelsDCALPHOS.HasChannel(position.GetCol(), position.GetRow()))
-			fTriggerChannelsDCALPHOS.AddADC(position.GetCol(), position.GetRow(), energy);
+	FillChannelMap(eta, phi, energy, TriggerShowerModel::kElectromagnetic);
+}
+
+/**
+ * Fill trigger channel map for a particle of a given type. If the shower spreading is switched on,
+ * the energy is shared between the FastOR hit and its neighbors according to the shower model,
+ * using the impact position inside the FastOR hit. Otherwise the full energy is deposited in the
+ * FastOR hit, independent of the particle type.
+ * @param eta Track/Particle eta
+ * @param phi Track/Particle phi
+ * @param energy Track/Particle energy
+ * @param type Particle type, selecting the lateral shower profile
+ */
+void TriggerMaker::FillChannelMap(double eta, double phi, double energy, TriggerShowerModel::ParticleType type) {
+	TriggerChannel position = fMapping->GetPositionFromEtaPhi(eta, phi);
+	if(!(position.IsEMCAL() || position.IsDCALPHOS())) return;
+	TriggerChannelMap &channels = position.IsEMCAL() ? fTriggerChannelsEMCAL : fTriggerChannelsDCALPHOS;
+	const TriggerBadChannelContainer &badchannels = position.IsEMCAL() ? fBadChannelsEMCAL : fBadChannelsDCALPHOS;
+	if(fShowerSpreading){
+		fShowerModel.Deposit(channels, position.GetCol(), position.GetRow(), position.GetColFraction(), position.GetRowFraction(), energy, type, &badchannels);
+	} else if (!badchannels.HasChannel(position.GetCol(), position.GetRow())) {
+		channels.AddADC(position.GetCol(), position.GetRow(), energy);
 	}
 }
@@ -7,12 +7,25 @@
  *  (at your option) any later version. (See cxx source for full Copyright notice)
  */
 
+#include <exception>
+#include <sstream>
+#include <string>
+
 #include "GammaTriggerAlgorithm.h"
 #include "JetTriggerAlgorithm.h"
+#include "Level0TriggerAlgorithm.h"
 #include "TriggerChannelMap.h"
 #include "TriggerBadChannelContainer.h"
+#include "TriggerDigitizer.h"
+#include "TriggerFusedScan.h"
 #include "TriggerMappingEmcalSimple.h"
+#include "TriggerPatchMask.h"
+#include "TriggerPatchRange.h"
+#include "TriggerRegionMap.h"
 #include "TriggerSetup.h"
+#include "TriggerShowerModel.h"
+#include "TriggerSubregionMap.h"
+#include "TriggerSummary.h"
 
 class TriggerMaker {
 public:
@@ -22,22 +35,62 @@ public:
 		kMinEtaPHOS = 16,
 		kMaxEtaPHOS = 31
 	};
+	enum {
+		kNPatchCategories = RawPatch::kDCALpatchL0 - RawPatch::kEMCALpatchGA + 1
+	};
+
+	class InvalidCategoryException : public std::exception{
+	public:
+		InvalidCategoryException(int category):
+			exception(),
+			fMessage(""),
+			fCategory(category)
+		{
+			std::stringstream msgstream;
+			msgstream << "Invalid patch category: " << fCategory;
+			fMessage = msgstream.str();
+		}
+		virtual ~InvalidCategoryException() throw() {}
+
+		int GetCategory() const throw() { return fCategory; }
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string 			fMessage;			///< Error message
+		int						fCategory;			///< Requested category
+	};
 	
 	TriggerMaker();
 	virtual ~TriggerMaker();
 
+	void							AddAlgorithm(TriggerAlgorithm *algorithm);
+	void							AddDefaultAlgorithms();
+	void							ClearAlgorithms();
+	const TriggerAlgorithm			*GetAlgorithm(int category) const;
+	void							SetCategoryEnabled(int category, bool doEnable);
+	bool							IsCategoryEnabled(int category) const;
+
 	void 							Reset();
 	void 							FindPatches();
+	void							FindSummary(TriggerSummary &summary);
 	std::vector<RawPatch>			GetPatches(const int what = RawPatch::kAny);
+	TriggerPatchRange				GetPatchRange(const int what = RawPatch::kAny);
+	RawPatch 						GetMaxPatch(int category);
 	RawPatch 						GetMaxGammaEMCAL();
 	RawPatch 						GetMaxGammaDCALPHOS();
 	RawPatch 						GetMaxJetEMCAL();
 	RawPatch 						GetMaxJetDCALPHOS();
 	RawPatch 						GetMaxJetEMCAL8x8();
 	RawPatch 						GetMaxJetDCALPHOS8x8();
+	RawPatch 						GetMaxLevel0EMCAL();
+	RawPatch 						GetMaxLevel0DCALPHOS();
 
 	double 							GetMedian(std::vector<RawPatch> v);
+	double 							GetMedian(const std::vector<PackedRawPatch> &v) const;
 
+	double 							GetMedianADC(int category);
 	double 							GetMedianGammaEMCAL();
 	double 							GetMedianGammaDCALPHOS();
 	double 							GetMedianJetEMCAL();
@@ -46,6 +99,39 @@ public:
 	double 							GetMedianJetDCALPHOS8x8();
 
 	void FillChannelMap(double eta, double phi, double energy);
+	void FillChannelMap(double eta, double phi, double energy, TriggerShowerModel::ParticleType type);
+	void Digitize(uint64_t seed);
+
+	/**
+	 * Switch on sharing of the particle energy between neighboring FastORs according to
+	 * the shower model. If off, the full energy is deposited in the FastOR hit.
+	 * @param doSpread If true the shower spreading is applied
+	 */
+	void SetShowerSpreading(bool doSpread) { fShowerSpreading = doSpread; }
+
+	/**
+	 * Check whether the shower spreading is applied
+	 * @return True if the shower spreading is applied
+	 */
+	bool IsShowerSpreading() const { return fShowerSpreading; }
+
+	/**
+	 * Get the model of the lateral shower profile used for the shower spreading
+	 * @return Shower model
+	 */
+	TriggerShowerModel &GetShowerModel() { return fShowerModel; }
+
+	/**
+	 * Get the FastOR response emulation of the EMCAL, to be configured before calling Digitize
+	 * @return Digitizer of the EMCAL
+	 */
+	TriggerDigitizer &GetEMCALDigitizer() { return fDigitizerEMCAL; }
+
+	/**
+	 * Get the FastOR response emulation of the DCAL-PHOS, to be configured before calling Digitize
+	 * @return Digitizer of the DCAL-PHOS
+	 */
+	TriggerDigitizer &GetDCALPHOSDigitizer() { return fDigitizerDCALPHOS; }
 
 	/**
 	 * Get the map of the EMCAL trigger channels
@@ -59,11 +145,61 @@ public:
 	 */
 	const TriggerChannelMap &GetDCALPHOSChannels() const { return fTriggerChannelsDCALPHOS; }
 
+	/**
+	 * Use the vector kernels of an instruction set for the fused scan of the standard patch
+	 * finders (FindPatches, FindSummary), instead of the one selected at construction
+	 * (TriggerKernels::SelectISA). Categories evaluated on demand by their algorithm
+	 * (GetPatches before FindPatches) and other registered patch finders are not affected.
+	 * Instruction sets not supported by the CPU are replaced by the widest supported one.
+	 * @param isa Instruction set
+	 */
+	void SetKernelISA(TriggerKernels::ISA isa) { fFusedScan.SetKernels(TriggerKernels::GetKernels(isa)); }
+
+	/**
+	 * Get the instruction set of the vector kernels in use, e.g. for reporting
+	 * (name: TriggerKernels::GetISAName)
+	 * @return Instruction set
+	 */
+	TriggerKernels::ISA GetKernelISA() const { return fFusedScan.GetKernels().fISA; }
+
+	/**
+	 * Set the storage layout of the EMCAL and DCAL-PHOS channel maps (row-major or tiles of
+	 * 4x4 channels, see TriggerChannelMap). The patches found don't depend on the layout.
+	 * @param layout Layout of the channel maps
+	 */
+	void SetChannelMapLayout(TriggerChannelMap::Layout layout) {
+		fTriggerChannelsEMCAL.SetLayout(layout);
+		fTriggerChannelsDCALPHOS.SetLayout(layout);
+	}
+
+	/**
+	 * Get the supermodule / TRU partitioning of the EMCAL channel map
+	 * @return Region map of the EMCAL
+	 */
+	const TriggerRegionMap &GetEMCALRegions() const { return fRegionsEMCAL; }
+
+	/**
+	 * Get the supermodule / TRU partitioning of the DCAL-PHOS channel map
+	 * @return Region map of the DCAL-PHOS
+	 */
+	const TriggerRegionMap &GetDCALPHOSRegions() const { return fRegionsDCALPHOS; }
+
+	const TriggerSubregionMap		&GetEMCALSubregions();
+	const TriggerSubregionMap		&GetDCALPHOSSubregions();
+
 	/**
 	 * Get the mapping between eta and phi on the one side and row and col in the EMCAL / DCAL on the other side
 	 * @return Mapping for EMCAL and DCAL/PHOS trigger channels
 	 */
-	const TriggerMappingEmcalSimple &GetTriggerChannelMapping() const { return fTriggerMapping; }
+	const TriggerMapping &GetTriggerChannelMapping() const { return *fMapping; }
+
+	/**
+	 * Set the mapping between eta and phi and the trigger channels used in FillChannelMap,
+	 * e.g. a TriggerMappingGrid with the geometry including gaps. The mapping is not owned
+	 * and has to stay valid as long as it is used by the trigger maker.
+	 * @param mapping Mapping to be used (NULL: simple mapping)
+	 */
+	void SetTriggerChannelMapping(const TriggerMapping *mapping) { fMapping = mapping ? mapping : &fTriggerMapping; }
 
 	/**
 	 * Setup trigger patch finders
@@ -71,11 +207,32 @@ public:
 	 */
 	void SetTriggerSetup(TriggerSetup &setup) { fTriggerSetup = setup; }
 
+	void SetAcceptPHOSPatches(bool doAccept);
+	void AddExclusionRegionEMCAL(const TriggerRegionMap::Region &region);
+	void AddExclusionRegionDCALPHOS(const TriggerRegionMap::Region &region);
+	void ClearExclusionRegions();
+
+	/**
+	 * Get the accepted patch positions of a patch category, combining the PHOS
+	 * acceptance and the exclusion regions
+	 * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+	 * @return Patch mask of the category
+	 */
+	const TriggerPatchMask &GetPatchMask(int category) const { return fPatchMasks[GetCategoryIndex(category)]; }
+
 	/**
-	 * Accept patches 100% in PHOS
-	 * @param doAccept switch whether we accept or not
+	 * Switch on the Level0 trigger. If enabled, Level0 patches are included in FindPatches
+	 * and GetPatches(RawPatch::kAny). Level0 patches can be requested explicitly
+	 * (RawPatch::kEMCALpatchL0, RawPatch::kDCALpatchL0) also if not enabled.
+	 * @param doEnable If true the Level0 trigger is enabled
 	 */
-	void SetAcceptPHOSPatches(bool doAccept) { fAcceptPHOSPatches = doAccept; }
+	void SetLevel0Enabled(bool doEnable) { fLevel0Enabled = doEnable; }
+
+	/**
+	 * Check whether the Level0 trigger is enabled
+	 * @return True if the Level0 trigger is enabled
+	 */
+	bool IsLevel0Enabled() const { return fLevel0Enabled; }
 
 	/**
 	 * Add bad channel position in EMCAL in row and col to the list of bad channels.
@@ -93,6 +250,24 @@ public:
 	 */
 	void AddBadChannelDCALPHOS(int col, int row) { fBadChannelsDCALPHOS.AddChannel(col, row); }
 
+	/**
+	 * Replace the bad channels in EMCAL by the channels of a bitmask, e.g. when switching
+	 * to another run (see TriggerBadChannelFileReader::LoadRun)
+	 * @param mask Bitmask as obtained from TriggerBadChannelContainer::GetMask
+	 */
+	void SetBadChannelMaskEMCAL(const uint64_t *mask) { fBadChannelsEMCAL.SetMask(mask); }
+
+	/**
+	 * Replace the bad channels in DCAL-PHOS by the channels of a bitmask
+	 * @param mask Bitmask as obtained from TriggerBadChannelContainer::GetMask
+	 */
+	void SetBadChannelMaskDCALPHOS(const uint64_t *mask) { fBadChannelsDCALPHOS.SetMask(mask); }
+
+	/**
+	 * Remove all bad channels in EMCAL and DCAL-PHOS
+	 */
+	void ClearBadChannels() { fBadChannelsEMCAL.Clear(); fBadChannelsDCALPHOS.Clear(); }
+
 	/**
 	 * Get bad channels container
 	 */
@@ -118,23 +293,53 @@ public:
 	 */
 	bool IsPHOSPatch(int col, int row, int size);
 
+	static int GetCategoryIndex(int category);
+	static bool IsDCALPHOSCategory(int category);
+	static bool IsLevel0Category(int category);
+	static int GetCategoryPatchSize(int category);
+
 private:
-	JetTriggerAlgorithm				fJetTrigger;						///< Algorithm finding jet patches on a trigger channel map
-	GammaTriggerAlgorithm			fGammaTrigger;						///< Algorithm finding gamma patches on a trigger channel map
+	TriggerMaker(const TriggerMaker &);
+	TriggerMaker &operator=(const TriggerMaker &);
+
+	void							RegisterAlgorithm(TriggerAlgorithm *algorithm, bool isDefault);
+	void 							EvaluateCategory(int category);
+	void							ScanDetector(bool isDCALPHOS, TriggerSummary *summary = NULL);
+	bool 							IsCategorySelected(int category, int what) const;
+	const TriggerSubregionMap		&GetSubregions(bool isDCALPHOS);
+	std::vector<PackedRawPatch>		&GetCategoryPatches(int category);
+	const TriggerPatchMask			*GetActivePatchMask(int category) const;
+	void							UpdatePatchMasks();
+
+	std::vector<TriggerAlgorithm *>	fAlgorithms;						///< Registered patch finders (owned), in the order of evaluation
+	TriggerAlgorithm				*fCategoryAlgorithms[kNPatchCategories];	///< Patch finder per category (NULL if none registered)
+	bool							fCategoryEnabled[kNPatchCategories];	///< Flags whether patches of a category are found
+	bool							fDefaultAlgorithm[kNPatchCategories];	///< Flags whether the patch finder of a category is a standard one
+	TriggerFusedScan				fFusedScan;							///< Single-pass patch finding for the standard categories
 	TriggerChannelMap				fTriggerChannelsEMCAL;				///< Trigger channels for the EMCAL
 	TriggerChannelMap				fTriggerChannelsDCALPHOS;			///< Trigger channels for the combination DCAL-PHOS
-	TriggerMappingEmcalSimple		fTriggerMapping;					///< Mapping between trigger channels and eta and phi
+	TriggerRegionMap				fRegionsEMCAL;						///< Supermodule / TRU partitioning of the EMCAL
+	TriggerRegionMap				fRegionsDCALPHOS;					///< Supermodule / TRU partitioning of the DCAL-PHOS
+	TriggerSubregionMap				fSubregionsEMCAL;					///< 4x4 subregion amplitudes of the EMCAL
+	TriggerSubregionMap				fSubregionsDCALPHOS;				///< 4x4 subregion amplitudes of the DCAL-PHOS
+	TriggerDigitizer				fDigitizerEMCAL;					///< FastOR response emulation of the EMCAL
+	TriggerDigitizer				fDigitizerDCALPHOS;					///< FastOR response emulation of the DCAL-PHOS
+	TriggerShowerModel				fShowerModel;						///< Lateral shower profile for the shower spreading
+	TriggerMappingEmcalSimple		fTriggerMapping;					///< Default mapping between trigger channels and eta and phi
+	const TriggerMapping			*fMapping;							///< Mapping used to fill the channel maps (not owned)
 	TriggerSetup					fTriggerSetup;						///< Setup of the EMCAL / DCAL-PHOS trigger algorithms
 	TriggerBadChannelContainer		fBadChannelsEMCAL;					///< Map with bad EMCAL channels
 	TriggerBadChannelContainer		fBadChannelsDCALPHOS;				///< Map with bad DCAL-PHOS channels
-	bool							fHasRun;
 	bool 							fAcceptPHOSPatches;					///< Accept patches 100% in PHOS
-	std::vector<RawPatch>			fGammaEMCAL;
-	std::vector<RawPatch>			fGammaDCALPHOS;
-	std::vector<RawPatch>			fJetEMCAL;
-	std::vector<RawPatch>			fJetDCALPHOS;
-	std::vector<RawPatch>			fJetEMCAL8x8;
-	std::vector<RawPatch>			fJetDCALPHOS8x8;
+	bool							fShowerSpreading;					///< Share the particle energy between neighboring FastORs
+	bool 							fLevel0Enabled;						///< Find Level0 patches together with gamma patches
+	bool							fHasSubregionsEMCAL;				///< Flag whether the EMCAL subregion amplitudes are summed for this event
+	bool							fHasSubregionsDCALPHOS;				///< Flag whether the DCAL-PHOS subregion amplitudes are summed for this event
+	bool							fHasRun[kNPatchCategories];			///< Flags whether patches of a category are found for this event
+	std::vector<PackedRawPatch>		fPatches[kNPatchCategories];		///< Patches per category, sorted by amplitude
+	std::vector<TriggerRegionMap::Region>	fExclusionRegionsEMCAL;		///< User-defined regions excluded from the EMCAL patch finding
+	std::vector<TriggerRegionMap::Region>	fExclusionRegionsDCALPHOS;	///< User-defined regions excluded from the DCAL-PHOS patch finding
+	TriggerPatchMask				fPatchMasks[kNPatchCategories];		///< Accepted patch positions per category
 };
 
 #endif /* SRC_TRIGGERMAKER_H_ */
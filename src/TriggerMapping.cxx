@@ -0,0 +1,39 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include "TriggerMapping.h"
+
+/**
+ * Check whether a particle is in the EMCAL trigger active area
+ * @param eta Particle Eta
+ * @param phi Particle Phi
+ * @return True if the particle is mapped to an EMCAL trigger channel
+ */
+bool TriggerMapping::IsEMCAL(double eta, double phi) const {
+	return GetPositionFromEtaPhi(eta, phi).IsEMCAL();
+}
+
+/**
+ * Check whether a particle is in the DCAL+PHOS trigger active area
+ * @param eta Particle Eta
+ * @param phi Particle Phi
+ * @return True if the particle is mapped to a DCAL+PHOS trigger channel
+ */
+bool TriggerMapping::IsDCALPHOS(double eta, double phi) const {
+	return GetPositionFromEtaPhi(eta, phi).IsDCALPHOS();
+}
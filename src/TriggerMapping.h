@@ -0,0 +1,101 @@
+#ifndef TRIGGERMAPPING_H_
+#define TRIGGERMAPPING_H_
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+#include <exception>
+
+class TriggerChannel{
+public:
+	enum Detector{
+		kEMCAL,
+		kDCALPHOS,
+		kUndefined,
+	};
+	class TriggerChannelException : public std::exception{
+	public:
+		TriggerChannelException() {}
+		virtual ~TriggerChannelException() throw() {}
+		const char *what() const throw() {
+			return "Trigger channel not existing";
+		}
+	};
+
+	TriggerChannel():
+		fDetector(kUndefined),
+		fRow(0),
+		fCol(0),
+		fColFraction(0.5),
+		fRowFraction(0.5)
+	{}
+	~TriggerChannel() {}
+
+	void Set(int row, int col, Detector det){
+		fRow = row;
+		fCol = col;
+		fDetector = det;
+		fColFraction = fRowFraction = 0.5;
+	}
+
+	/**
+	 * Set the position of the particle inside the trigger channel
+	 * @param colfraction Position along the column direction, in units of the FastOR size (0 - 1)
+	 * @param rowfraction Position along the row direction, in units of the FastOR size (0 - 1)
+	 */
+	void SetFraction(double colfraction, double rowfraction){
+		fColFraction = colfraction;
+		fRowFraction = rowfraction;
+	}
+
+	int GetRow() const { if(fDetector == kUndefined) throw TriggerChannelException(); return fRow; }
+	int GetCol() const { if(fDetector == kUndefined) throw TriggerChannelException(); return fCol; }
+
+	double GetColFraction() const { return fColFraction; }
+	double GetRowFraction() const { return fRowFraction; }
+
+	bool IsEMCAL() const { if(fDetector == kEMCAL) return true; return false; }
+	bool IsDCALPHOS() const { if(fDetector == kDCALPHOS) return true; return false; }
+
+private:
+	Detector		fDetector;
+	int 			fRow;
+	int 			fCol;
+	double			fColFraction;		///< Position inside the channel along the column direction (0 - 1)
+	double			fRowFraction;		///< Position inside the channel along the row direction (0 - 1)
+};
+
+/**
+ * @class TriggerMapping
+ * @brief Interface for the mapping between eta and phi and the trigger channels
+ *
+ * The TriggerMaker can be configured with any implementation: the simple linear mapping
+ * (TriggerMappingEmcalSimple), the mapping including gaps (TriggerMappingEmcalGeometry),
+ * or a precomputed lookup grid of any of them (TriggerMappingGrid).
+ */
+class TriggerMapping {
+public:
+	/**
+	 * Constructor
+	 */
+	TriggerMapping() {}
+	/**
+	 * Destructor
+	 */
+	virtual ~TriggerMapping() {}
+
+	/**
+	 * Map the position of a particle to the trigger channel. Always returns a trigger channel
+	 * (also if outside the EMCAL or DCAL+PHOS acceptance), which can however be undefined.
+	 * @param eta Eta of the particle
+	 * @param phi Phi of the particle
+	 * @return The trigger channel corresponding to the Eta-Phi position of the particle.
+	 */
+	virtual TriggerChannel GetPositionFromEtaPhi(double eta, double phi) const = 0;
+	virtual bool IsEMCAL(double eta, double phi) const;
+	virtual bool IsDCALPHOS(double eta, double phi) const;
+};
+
+#endif /* TRIGGERMAPPING_H_ */
@@ -0,0 +1,83 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include "TriggerMappingEmcalGeometry.h"
+
+/**
+ * Constructor, setting the gaps in eta
+ */
+TriggerMappingEmcalGeometry::TriggerMappingEmcalGeometry():
+	TriggerMappingEmcalSimple(),
+	fEtaGapSM(0.005),
+	fEtaMinDCAL(0.22),
+	fEtaMaxPHOS(0.125)
+{
+}
+
+/**
+ * Map the position of the trigger channel including the gaps in eta. The row is
+ * obtained from the sectors in phi as in the simple mapping. Positions in gaps
+ * are mapped to an undefined trigger channel.
+ * @param eta Eta of the particle
+ * @param phi Phi of the particle
+ * @return The trigger channel corresponding to the Eta-Phi position of the particle.
+ */
+TriggerChannel TriggerMappingEmcalGeometry::GetPositionFromEtaPhi(double eta, double phi) const {
+	TriggerChannel simple = TriggerMappingEmcalSimple::GetPositionFromEtaPhi(eta, phi), result;
+	if(!(simple.IsEMCAL() || simple.IsDCALPHOS())) return result;
+	int row = simple.GetRow(), col(-1);
+	double fraction(0.5);
+	bool found(false);
+	if(simple.IsDCALPHOS() && row < kNRowsDCALFullSectors){
+		// full-size DCAL sectors: DCAL on both sides, PHOS in the center
+		found = GetColumn(eta, fEtaMinDCAL, fEtaMax, 0, kNColsDCALSide, col, fraction)
+			|| GetColumn(eta, -fEtaMaxPHOS, fEtaMaxPHOS, kNColsDCALSide, kNColsPHOS, col, fraction)
+			|| GetColumn(eta, fEtaMin, -fEtaMinDCAL, kNColsDCALSide + kNColsPHOS, kNColsDCALSide, col, fraction);
+	} else {
+		// two supermodules separated at eta = 0
+		found = GetColumn(eta, fEtaGapSM, fEtaMax, 0, 24, col, fraction)
+			|| GetColumn(eta, fEtaMin, -fEtaGapSM, 24, 24, col, fraction);
+	}
+	if(found){
+		result.Set(row, col, simple.IsEMCAL() ? TriggerChannel::kEMCAL : TriggerChannel::kDCALPHOS);
+		result.SetFraction(fraction, simple.GetRowFraction());
+	}
+	return result;
+}
+
+/**
+ * Find the column in an active region in eta with FastORs of constant size. Columns
+ * increase with decreasing eta.
+ * @param eta Eta of the particle
+ * @param etamin Min. eta of the region
+ * @param etamax Max. eta of the region
+ * @param firstcol Column at etamax
+ * @param ncols Number of columns of the region
+ * @param col Column found (output)
+ * @param fraction Position inside the column (output)
+ * @return True if the particle is in the region
+ */
+bool TriggerMappingEmcalGeometry::GetColumn(double eta, double etamin, double etamax, int firstcol, int ncols, int &col, double &fraction) const {
+	if(eta <= etamin || eta >= etamax) return false;
+	double position = (etamax - eta) / (etamax - etamin) * ncols;
+	int icol = static_cast<int>(position);
+	if(icol >= ncols) icol = ncols - 1;
+	col = firstcol + icol;
+	fraction = position - icol;
+	return true;
+}
@@ -0,0 +1,54 @@
+#ifndef TRIGGERMAPPINGEMCALGEOMETRY_H_
+#define TRIGGERMAPPINGEMCALGEOMETRY_H_
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include "TriggerMappingEmcalSimple.h"
+
+/**
+ * @class TriggerMappingEmcalGeometry
+ * @brief Mapping between eta and phi and the trigger channels including the gaps in eta
+ *
+ * Extends the simple mapping (same sectors in phi) by the gaps in eta:
+ * - the gap between the two supermodules of a sector at eta = 0
+ * - the DCAL eta hole: in the full-size DCAL sectors the DCAL covers only
+ *   0.22 < |eta| < 0.67 (cols 0-15 and 32-47), PHOS covers |eta| < 0.125 (cols 16-31)
+ *   and the region in between is not active
+ * Within each active region FastORs have a constant size in eta. The evaluation is not
+ * optimized for speed; for the event loop the mapping is meant to be precomputed into a
+ * TriggerMappingGrid.
+ */
+class TriggerMappingEmcalGeometry : public TriggerMappingEmcalSimple {
+public:
+	TriggerMappingEmcalGeometry();
+	virtual ~TriggerMappingEmcalGeometry() {}
+
+	virtual TriggerChannel GetPositionFromEtaPhi(double eta, double phi) const;
+	virtual bool IsEMCAL(double eta, double phi) const { return TriggerMapping::IsEMCAL(eta, phi); }
+	virtual bool IsDCALPHOS(double eta, double phi) const { return TriggerMapping::IsDCALPHOS(eta, phi); }
+
+	/**
+	 * Set the half width in eta of the gap between the supermodules at eta = 0
+	 * @param halfwidth Half width of the gap
+	 */
+	void SetEtaGapSupermodules(double halfwidth) { fEtaGapSM = halfwidth; }
+
+protected:
+	enum {
+		kNRowsDCALFullSectors = 36,
+		kNColsDCALSide = 16,
+		kNColsPHOS = 16
+	};
+
+	bool GetColumn(double eta, double etamin, double etamax, int firstcol, int ncols, int &col, double &fraction) const;
+
+	double						fEtaGapSM;			///< Half width in eta of the gap between the supermodules
+	double						fEtaMinDCAL;		///< Min. |eta| of the DCAL in the full-size sectors
+	double						fEtaMaxPHOS;		///< Max. |eta| of PHOS
+};
+
+#endif /* TRIGGERMAPPINGEMCALGEOMETRY_H_ */
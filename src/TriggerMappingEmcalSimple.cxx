@@ -74,9 +74,10 @@ TriggerMappingEmcalSimple::~TriggerMappingEmcalSimple() {
  * @return The trigger channel corresponding to the Eta-Phi position of the particle.
  */
 TriggerChannel TriggerMappingEmcalSimple::GetPositionFromEtaPhi(double eta, double phi) const{
-	if(IsEMCAL(eta, phi)){
+	// acceptance of the linear model, not the one of derived mappings
+	if(TriggerMappingEmcalSimple::IsEMCAL(eta, phi)){
 		return GetPositionFromEtaPhiEMCAL(eta, phi);
-	} else if(IsDCALPHOS(eta, phi)){
+	} else if(TriggerMappingEmcalSimple::IsDCALPHOS(eta, phi)){
 		return GetPositionFromEtaPhiDCALPHOS(eta, phi);
 	}
 	return TriggerChannel();
@@ -132,10 +133,10 @@ TriggerChannel TriggerMappingEmcalSimple::GetPositionFromEtaPhiEMCAL(double eta,
 	const SectorPhi *emcsec = FindSectorEMCAL(phi);
 	if(!emcsec) 		// dead area
 		return result;
+	int rowsec = emcsec->GetRowNumberInSector(phi);
 	if(emcsec->GetSectorID() == 0){
-		row = emcsec->GetRowNumberInSector(phi);
+		row = rowsec;
 	} else {
-		int rowsec = emcsec->GetRowNumberInSector(phi);
 		row = 0;
 		for(int isec = 0; isec < 6; isec++){
 			if(isec < emcsec->GetSectorID()) row += fPhiLimitsEMCAL[isec].GetNumberOfRows();
@@ -152,8 +153,10 @@ TriggerChannel TriggerMappingEmcalSimple::GetPositionFromEtaPhiEMCAL(double eta,
 		}
 	}
 
-	if(col >= 0)
+	if(col >= 0){
 		result.Set(row, col, TriggerChannel::kEMCAL);
+		result.SetFraction(GetColFraction(eta, col), emcsec->GetRowFractionInSector(phi, rowsec));
+	}
 	return result;
 }
 
@@ -172,10 +175,10 @@ TriggerChannel TriggerMappingEmcalSimple::GetPositionFromEtaPhiDCALPHOS(double e
 	const SectorPhi *emcsec = FindSectorDCALPHOS(phi);
 	if(!emcsec) 		// dead area
 		return result;
+	int rowsec = emcsec->GetRowNumberInSector(phi);
 	if(emcsec->GetSectorID() == 0){
-		row = emcsec->GetRowNumberInSector(phi);
+		row = rowsec;
 	} else {
-		int rowsec = emcsec->GetRowNumberInSector(phi);
 		row = 0;
 		for(int isec = 0; isec < 4; isec++){
 			if(isec < emcsec->GetSectorID()) row += fPhiLimitsDCALPHOS[isec].GetNumberOfRows();
@@ -192,8 +195,10 @@ TriggerChannel TriggerMappingEmcalSimple::GetPositionFromEtaPhiDCALPHOS(double e
 		}
 	}
 
-	if(col >= 0)
+	if(col >= 0){
 		result.Set(row, col, TriggerChannel::kDCALPHOS);
+		result.SetFraction(GetColFraction(eta, col), emcsec->GetRowFractionInSector(phi, rowsec));
+	}
 	return result;
 }
 
@@ -272,3 +277,26 @@ int TriggerMappingEmcalSimple::SectorPhi::GetRowNumberInSector(double phi) const
 	}
 	return rownumber;
 }
+
+/**
+ * Get the position of the particle inside the row of the sector
+ * @param phi Particle Phi
+ * @param rownumber Row number in the sector (see GetRowNumberInSector)
+ * @return Position in units of the FastOR size (0 at the edge to the previous row)
+ */
+double TriggerMappingEmcalSimple::SectorPhi::GetRowFractionInSector(double phi, int rownumber) const {
+	double phiwidth = (fMaximum - fMinimum) / fNRows;
+	double fraction = (phi - fMinimum) / phiwidth - rownumber;
+	return fraction < 0. ? 0. : (fraction > 1. ? 1. : fraction);
+}
+
+/**
+ * Get the position of the particle inside the trigger channel along the column direction
+ * @param eta Particle Eta
+ * @param col Column of the trigger channel
+ * @return Position in units of the FastOR size (0 at the edge to the previous column)
+ */
+double TriggerMappingEmcalSimple::GetColFraction(double eta, int col) const {
+	double fraction = (fEtaMax - col * fEtaSizeFOR - eta) / fEtaSizeFOR;
+	return fraction < 0. ? 0. : (fraction > 1. ? 1. : fraction);
+}
@@ -6,58 +6,22 @@
  *  the Free Software Foundation, either version 3 of the License, or
  *  (at your option) any later version. (See cxx source for full Copyright notice)
  */
-#include <exception>
 #include <vector>
 
-class TriggerChannel{
-public:
-	enum Detector{
-		kEMCAL,
-		kDCALPHOS,
-		kUndefined,
-	};
-	class TriggerChannelException : public std::exception{
-	public:
-		TriggerChannelException() {}
-		virtual ~TriggerChannelException() throw() {}
-		const char *what() const throw() {
-			return "Trigger channel not existing";
-		}
-	};
-
-	TriggerChannel():
-		fDetector(kUndefined),
-		fRow(0),
-		fCol(0)
-	{}
-	~TriggerChannel() {}
-
-	void Set(int row, int col, Detector det){
-		fRow = row;
-		fCol = col;
-		fDetector = det;
-	}
+#include "TriggerMapping.h"
 
-	int GetRow() const { if(fDetector == kUndefined) throw TriggerChannelException(); return fRow; }
-	int GetCol() const { if(fDetector == kUndefined) throw TriggerChannelException(); return fCol; }
-
-	bool IsEMCAL() const { if(fDetector == kEMCAL) return true; return false; }
-	bool IsDCALPHOS() const { if(fDetector == kDCALPHOS) return true; return false; }
-
-private:
-	Detector		fDetector;
-	int 			fRow;
-	int 			fCol;
-};
-
-class TriggerMappingEmcalSimple {
+/**
+ * @class TriggerMappingEmcalSimple
+ * @brief Linear mapping between eta and phi and the trigger channels, ignoring gaps in eta
+ */
+class TriggerMappingEmcalSimple : public TriggerMapping {
 public:
 	TriggerMappingEmcalSimple();
 	virtual ~TriggerMappingEmcalSimple();
 
-	TriggerChannel GetPositionFromEtaPhi(double eta, double phi) const;
-	bool IsEMCAL(double eta, double phi) const;
-	bool IsDCALPHOS(double eta, double phi) const;
+	virtual TriggerChannel GetPositionFromEtaPhi(double eta, double phi) const;
+	virtual bool IsEMCAL(double eta, double phi) const;
+	virtual bool IsDCALPHOS(double eta, double phi) const;
 
 protected:
 	class SectorPhi{
@@ -72,6 +36,7 @@ protected:
 
 		bool IsInSector(double phi)  const { return phi > fMinimum && phi < fMaximum; }
 		int GetRowNumberInSector(double phi) const;
+		double GetRowFractionInSector(double phi, int rownumber) const;
 
 	private:
 		int 			fSectorID;			///< ID of the sector, starting from 0 (Indices separate for EMCAL and DCAL)
@@ -85,6 +50,7 @@ protected:
 	const SectorPhi *FindSectorDCALPHOS(double phi) const;
 	TriggerChannel GetPositionFromEtaPhiEMCAL(double eta, double phi) const;
 	TriggerChannel GetPositionFromEtaPhiDCALPHOS(double eta, double phi) const;
+	double GetColFraction(double eta, int col) const;
 
 	std::vector<SectorPhi>		fPhiLimitsEMCAL;
 	std::vector<SectorPhi> 		fPhiLimitsDCALPHOS;
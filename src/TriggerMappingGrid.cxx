@@ -0,0 +1,227 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <cfloat>
+#include <cstring>
+#include <fstream>
+
+#include "TriggerMappingGrid.h"
+
+namespace {
+const char kTableMagic[8] = {'E', 'T', 'F', 'G', 'R', 'I', 'D', '\0'};
+const uint32_t kTableVersion = 1;
+const uint32_t kByteOrderMarker = 0x01020304;
+}
+
+/**
+ * Dummy constructor, creating an empty grid (all positions unmapped)
+ */
+TriggerMappingGrid::TriggerMappingGrid():
+	TriggerMapping(),
+	fNEta(0),
+	fNPhi(0),
+	fEtaMin(0),
+	fEtaMax(0),
+	fPhiMin(0),
+	fPhiMax(0),
+	fCellsPerEta(0),
+	fCellsPerPhi(0),
+	fCells(),
+	fEtaLow(),
+	fEtaHigh(),
+	fPhiLow(),
+	fPhiHigh()
+{
+}
+
+/**
+ * Constructor, building the grid from another mapping
+ * @param source Mapping evaluated at the cell centers
+ * @param etamin Min. eta of the grid
+ * @param etamax Max. eta of the grid
+ * @param neta Number of cells in eta
+ * @param phimin Min. phi of the grid
+ * @param phimax Max. phi of the grid
+ * @param nphi Number of cells in phi
+ * @throw InvalidGridException in case the number of cells or the limits are invalid
+ */
+TriggerMappingGrid::TriggerMappingGrid(const TriggerMapping &source, double etamin, double etamax, int neta, double phimin, double phimax, int nphi):
+	TriggerMapping(),
+	fNEta(0),
+	fNPhi(0),
+	fEtaMin(0),
+	fEtaMax(0),
+	fPhiMin(0),
+	fPhiMax(0),
+	fCellsPerEta(0),
+	fCellsPerPhi(0),
+	fCells(),
+	fEtaLow(),
+	fEtaHigh(),
+	fPhiLow(),
+	fPhiHigh()
+{
+	Build(source, etamin, etamax, neta, phimin, phimax, nphi);
+}
+
+/**
+ * Build the grid from another mapping, evaluating it at the cell centers
+ * @param source Mapping evaluated at the cell centers
+ * @param etamin Min. eta of the grid
+ * @param etamax Max. eta of the grid
+ * @param neta Number of cells in eta
+ * @param phimin Min. phi of the grid
+ * @param phimax Max. phi of the grid
+ * @param nphi Number of cells in phi
+ * @throw InvalidGridException in case the number of cells or the limits are invalid
+ */
+void TriggerMappingGrid::Build(const TriggerMapping &source, double etamin, double etamax, int neta, double phimin, double phimax, int nphi) {
+	if(!IsValidGrid(etamin, etamax, neta, phimin, phimax, nphi)) throw InvalidGridException(etamin, etamax, neta, phimin, phimax, nphi);
+	fNEta = neta;
+	fNPhi = nphi;
+	fEtaMin = etamin;
+	fEtaMax = etamax;
+	fPhiMin = phimin;
+	fPhiMax = phimax;
+	fCells.assign(fNEta * fNPhi, kNoChannel);
+	double etasize = (fEtaMax - fEtaMin) / fNEta, phisize = (fPhiMax - fPhiMin) / fNPhi;
+	for(int ieta = 0; ieta < fNEta; ieta++){
+		for(int iphi = 0; iphi < fNPhi; iphi++){
+			TriggerChannel channel = source.GetPositionFromEtaPhi(fEtaMin + (ieta + 0.5) * etasize, fPhiMin + (iphi + 0.5) * phisize);
+			if(!(channel.IsEMCAL() || channel.IsDCALPHOS())) continue;
+			fCells[ieta * fNPhi + iphi] = (channel.IsDCALPHOS() ? 1 << kDetectorShift : 0)
+					| ((channel.GetRow() & kRowMask) << kRowShift) | (channel.GetCol() & kColMask);
+		}
+	}
+	ComputeChannelLimits();
+}
+
+/**
+ * Write the grid to a binary table
+ * @param filename Name of the table file
+ * @throw TableIOException in case the grid is not built or the file cannot be written
+ */
+void TriggerMappingGrid::Save(const std::string &filename) const {
+	if(fCells.empty()) throw TableIOException(filename, "grid not built");
+	std::ofstream writer(filename.c_str(), std::ios::out | std::ios::binary);
+	if(!writer.good()) throw TableIOException(filename, "cannot open file for writing");
+	int32_t neta = fNEta, nphi = fNPhi;
+	double limits[4] = {fEtaMin, fEtaMax, fPhiMin, fPhiMax};
+	writer.write(kTableMagic, sizeof(kTableMagic));
+	writer.write(reinterpret_cast<const char *>(&kTableVersion), sizeof(kTableVersion));
+	writer.write(reinterpret_cast<const char *>(&kByteOrderMarker), sizeof(kByteOrderMarker));
+	writer.write(reinterpret_cast<const char *>(&neta), sizeof(neta));
+	writer.write(reinterpret_cast<const char *>(&nphi), sizeof(nphi));
+	writer.write(reinterpret_cast<const char *>(limits), sizeof(limits));
+	if(fCells.size()) writer.write(reinterpret_cast<const char *>(&fCells[0]), fCells.size() * sizeof(uint16_t));
+	if(!writer.good()) throw TableIOException(filename, "write error");
+}
+
+/**
+ * Read the grid from a binary table written with Save
+ * @param filename Name of the table file
+ * @throw TableIOException in case the file cannot be read or has an invalid format, grid size or limits
+ */
+void TriggerMappingGrid::Load(const std::string &filename) {
+	std::ifstream reader(filename.c_str(), std::ios::in | std::ios::binary);
+	if(!reader.good()) throw TableIOException(filename, "cannot open file for reading");
+	char magic[sizeof(kTableMagic)];
+	uint32_t version(0), byteorder(0);
+	int32_t neta(0), nphi(0);
+	double limits[4];
+	reader.read(magic, sizeof(magic));
+	reader.read(reinterpret_cast<char *>(&version), sizeof(version));
+	reader.read(reinterpret_cast<char *>(&byteorder), sizeof(byteorder));
+	reader.read(reinterpret_cast<char *>(&neta), sizeof(neta));
+	reader.read(reinterpret_cast<char *>(&nphi), sizeof(nphi));
+	reader.read(reinterpret_cast<char *>(limits), sizeof(limits));
+	if(!reader.good() || memcmp(magic, kTableMagic, sizeof(kTableMagic))) throw TableIOException(filename, "not a mapping table");
+	if(version != kTableVersion) throw TableIOException(filename, "unsupported version");
+	if(byteorder != kByteOrderMarker) throw TableIOException(filename, "byte order mismatch");
+	if(!IsValidGrid(limits[0], limits[1], neta, limits[2], limits[3], nphi)) throw TableIOException(filename, "invalid grid size or limits");
+	std::vector<uint16_t> cells(neta * nphi);
+	if(cells.size()) reader.read(reinterpret_cast<char *>(&cells[0]), cells.size() * sizeof(uint16_t));
+	if(!reader.good()) throw TableIOException(filename, "truncated table");
+	// cell codes index the channel limits, anything else than a channel or kNoChannel is rejected
+	for(std::vector<uint16_t>::const_iterator celliter = cells.begin(); celliter != cells.end(); ++celliter)
+		if(*celliter != kNoChannel && *celliter >= kNDetectors * kMaxRows * kMaxCols) throw TableIOException(filename, "invalid channel code");
+
+	fNEta = neta;
+	fNPhi = nphi;
+	fEtaMin = limits[0];
+	fEtaMax = limits[1];
+	fPhiMin = limits[2];
+	fPhiMax = limits[3];
+	fCells.swap(cells);
+	ComputeChannelLimits();
+}
+
+/**
+ * Map the position of the trigger channel using a lookup in the grid
+ * @param eta Eta of the particle
+ * @param phi Phi of the particle
+ * @return The trigger channel corresponding to the Eta-Phi position of the particle.
+ */
+TriggerChannel TriggerMappingGrid::GetPositionFromEtaPhi(double eta, double phi) const {
+	TriggerChannel result;
+	double etaposition = (eta - fEtaMin) * fCellsPerEta, phiposition = (phi - fPhiMin) * fCellsPerPhi;
+	if(!(etaposition >= 0. && etaposition < fNEta && phiposition >= 0. && phiposition < fNPhi)) return result;
+	uint16_t code = fCells[static_cast<int>(etaposition) * fNPhi + static_cast<int>(phiposition)];
+	if(code == kNoChannel) return result;
+	result.Set((code >> kRowShift) & kRowMask, code & kColMask, code >> kDetectorShift ? TriggerChannel::kDCALPHOS : TriggerChannel::kEMCAL);
+	// columns increase with decreasing eta
+	double colfraction = (fEtaHigh[code] - eta) / (fEtaHigh[code] - fEtaLow[code]),
+			rowfraction = (phi - fPhiLow[code]) / (fPhiHigh[code] - fPhiLow[code]);
+	result.SetFraction(colfraction < 0. ? 0. : (colfraction > 1. ? 1. : colfraction), rowfraction < 0. ? 0. : (rowfraction > 1. ? 1. : rowfraction));
+	return result;
+}
+
+/**
+ * Check the number of cells and the limits of a grid: at least one and at most
+ * kMaxCellsPerAxis cells per axis, at most kMaxCells cells in total, max. above min.
+ * @return True if the grid is valid
+ */
+bool TriggerMappingGrid::IsValidGrid(double etamin, double etamax, int64_t neta, double phimin, double phimax, int64_t nphi) {
+	if(neta <= 0 || nphi <= 0 || neta > kMaxCellsPerAxis || nphi > kMaxCellsPerAxis || neta * nphi > kMaxCells) return false;
+	return etamax > etamin && phimax > phimin;						// false for NaN limits
+}
+
+/**
+ * Determine the extent in eta and phi of all trigger channels from the cells mapped to them
+ */
+void TriggerMappingGrid::ComputeChannelLimits() {
+	fCellsPerEta = fEtaMax > fEtaMin ? fNEta / (fEtaMax - fEtaMin) : 0.;
+	fCellsPerPhi = fPhiMax > fPhiMin ? fNPhi / (fPhiMax - fPhiMin) : 0.;
+	int nchannels = kNDetectors * kMaxRows * kMaxCols;
+	fEtaLow.assign(nchannels, FLT_MAX);
+	fEtaHigh.assign(nchannels, -FLT_MAX);
+	fPhiLow.assign(nchannels, FLT_MAX);
+	fPhiHigh.assign(nchannels, -FLT_MAX);
+	double etasize = (fEtaMax - fEtaMin) / fNEta, phisize = (fPhiMax - fPhiMin) / fNPhi;
+	for(int ieta = 0; ieta < fNEta; ieta++){
+		for(int iphi = 0; iphi < fNPhi; iphi++){
+			uint16_t code = fCells[ieta * fNPhi + iphi];
+			if(code == kNoChannel) continue;
+			float etalow = fEtaMin + ieta * etasize, philow = fPhiMin + iphi * phisize;
+			if(etalow < fEtaLow[code]) fEtaLow[code] = etalow;
+			if(etalow + etasize > fEtaHigh[code]) fEtaHigh[code] = etalow + etasize;
+			if(philow < fPhiLow[code]) fPhiLow[code] = philow;
+			if(philow + phisize > fPhiHigh[code]) fPhiHigh[code] = philow + phisize;
+		}
+	}
+}
@@ -0,0 +1,125 @@
+#ifndef TRIGGERMAPPINGGRID_H_
+#define TRIGGERMAPPINGGRID_H_
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <exception>
+#include <sstream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "TriggerMapping.h"
+
+/**
+ * @class TriggerMappingGrid
+ * @brief Mapping between eta and phi and the trigger channels using a precomputed lookup grid
+ *
+ * The eta-phi plane is divided into a regular grid of cells, each storing the trigger channel
+ * at its center, so that the mapping is a constant-time lookup independent of the complexity
+ * of the geometry. The grid is built from any other mapping (e.g. TriggerMappingEmcalGeometry)
+ * and can be saved to and loaded from a binary table. The position inside the trigger channel
+ * is obtained from the extent of the channel in the grid, so its precision is limited by the
+ * cell size. Binary tables are stored in the byte order of the machine writing them.
+ */
+class TriggerMappingGrid : public TriggerMapping {
+public:
+	class TableIOException : public std::exception{
+	public:
+		TableIOException(const std::string &filename, const std::string &reason):
+			exception(),
+			fMessage("")
+		{
+			fMessage = "Mapping table " + filename + ": " + reason;
+		}
+		virtual ~TableIOException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string				fMessage;			///< Error message
+	};
+
+	/**
+	 * @class InvalidGridException
+	 * @brief Exception thrown in case the number of cells or the limits of the grid are invalid
+	 */
+	class InvalidGridException : public std::exception{
+	public:
+		InvalidGridException(double etamin, double etamax, int neta, double phimin, double phimax, int nphi):
+			exception(),
+			fMessage("")
+		{
+			std::stringstream msgbuilder;
+			msgbuilder << "Invalid grid: " << neta << " cells in eta " << etamin << " - " << etamax
+					<< ", " << nphi << " cells in phi " << phimin << " - " << phimax;
+			fMessage = msgbuilder.str();
+		}
+		virtual ~InvalidGridException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string				fMessage;			///< Error message
+	};
+
+	TriggerMappingGrid();
+	TriggerMappingGrid(const TriggerMapping &source, double etamin, double etamax, int neta, double phimin, double phimax, int nphi);
+	virtual ~TriggerMappingGrid() {}
+
+	void Build(const TriggerMapping &source, double etamin, double etamax, int neta, double phimin, double phimax, int nphi);
+	void Save(const std::string &filename) const;
+	void Load(const std::string &filename);
+
+	virtual TriggerChannel GetPositionFromEtaPhi(double eta, double phi) const;
+
+	/**
+	 * Get the number of cells in eta
+	 * @return Number of cells in eta
+	 */
+	int GetNumberOfEtaCells() const { return fNEta; }
+	/**
+	 * Get the number of cells in phi
+	 * @return Number of cells in phi
+	 */
+	int GetNumberOfPhiCells() const { return fNPhi; }
+
+private:
+	enum {
+		kNoChannel = 0xffff,
+		kColMask = 0x3f,
+		kRowShift = 6,
+		kRowMask = 0x7f,
+		kDetectorShift = 13,
+		kMaxCols = 64,
+		kMaxRows = 128,
+		kNDetectors = 2,
+		kMaxCellsPerAxis = 1 << 16,
+		kMaxCells = 1 << 26
+	};
+
+	void ComputeChannelLimits();
+	static bool IsValidGrid(double etamin, double etamax, int64_t neta, double phimin, double phimax, int64_t nphi);
+
+	int							fNEta;				///< Number of cells in eta
+	int							fNPhi;				///< Number of cells in phi
+	double						fEtaMin;			///< Min. eta of the grid
+	double						fEtaMax;			///< Max. eta of the grid
+	double						fPhiMin;			///< Min. phi of the grid
+	double						fPhiMax;			///< Max. phi of the grid
+	double						fCellsPerEta;		///< Number of cells per unit in eta
+	double						fCellsPerPhi;		///< Number of cells per unit in phi
+	std::vector<uint16_t>		fCells;				///< Encoded trigger channel per cell (detector, row, col), eta-major
+	std::vector<float>			fEtaLow;			///< Min. eta of each trigger channel in the grid, indexed by the encoded channel
+	std::vector<float>			fEtaHigh;			///< Max. eta of each trigger channel in the grid
+	std::vector<float>			fPhiLow;			///< Min. phi of each trigger channel in the grid
+	std::vector<float>			fPhiHigh;			///< Max. phi of each trigger channel in the grid
+};
+
+#endif /* TRIGGERMAPPINGGRID_H_ */
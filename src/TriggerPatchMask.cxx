@@ -0,0 +1,97 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+
+#include "TriggerPatchMask.h"
+
+/**
+ * Dummy constructor, creating an empty mask
+ */
+TriggerPatchMask::TriggerPatchMask():
+	fNCols(0),
+	fNRows(0),
+	fPatchSize(0),
+	fNRejected(0),
+	fAccepted()
+{
+}
+
+/**
+ * Constructor, creating a mask accepting all positions
+ * @param ncols Number of columns of the channel map
+ * @param nrows Number of rows of the channel map
+ * @param patchsize Size of the patches
+ */
+TriggerPatchMask::TriggerPatchMask(int ncols, int nrows, int patchsize):
+	fNCols(0),
+	fNRows(0),
+	fPatchSize(0),
+	fNRejected(0),
+	fAccepted()
+{
+	Configure(ncols, nrows, patchsize);
+}
+
+/**
+ * (Re-)initialize the mask for a channel map and patch size, accepting all positions
+ * @param ncols Number of columns of the channel map
+ * @param nrows Number of rows of the channel map
+ * @param patchsize Size of the patches
+ */
+void TriggerPatchMask::Configure(int ncols, int nrows, int patchsize) {
+	fNCols = ncols;
+	fNRows = nrows;
+	fPatchSize = patchsize;
+	fNRejected = 0;
+	fAccepted.assign(fNCols * fNRows, 1);
+}
+
+/**
+ * Reject the patch starting at a given position
+ * @param col Starting column of the patch
+ * @param row Starting row of the patch
+ */
+void TriggerPatchMask::Reject(int col, int row) {
+	if(col < 0 || col >= fNCols || row < 0 || row >= fNRows) return;
+	unsigned char &accepted = fAccepted[row * fNCols + col];
+	if(accepted) fNRejected++;
+	accepted = 0;
+}
+
+/**
+ * Reject all patches having at least one FastOR inside a region
+ * @param region Region in col-row space (limits inclusive)
+ */
+void TriggerPatchMask::RejectOverlapping(const TriggerRegionMap::Region &region) {
+	for(int row = std::max(region.fRowMin - fPatchSize + 1, 0); row <= std::min(region.fRowMax, fNRows - 1); row++)
+		for(int col = std::max(region.fColMin - fPatchSize + 1, 0); col <= std::min(region.fColMax, fNCols - 1); col++)
+			Reject(col, row);
+}
+
+/**
+ * Check whether two masks reject the same patches. Masks without rejections are
+ * equivalent independent of their dimensions.
+ * @param other Mask to compare with
+ * @return True if both masks accept all positions, or reject the same positions for the same patch size
+ */
+bool TriggerPatchMask::HasSameRejections(const TriggerPatchMask &other) const {
+	if(fNRejected != other.fNRejected) return false;
+	if(!fNRejected) return true;
+	return fNCols == other.fNCols && fNRows == other.fNRows && fPatchSize == other.fPatchSize && fAccepted == other.fAccepted;
+}
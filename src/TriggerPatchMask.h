@@ -0,0 +1,64 @@
+#ifndef TRIGGERPATCHMASK_H
+#define TRIGGERPATCHMASK_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <vector>
+
+#include "TriggerRegionMap.h"
+
+/**
+ * @class TriggerPatchMask
+ * @brief Accepted start positions of trigger patches of a given size
+ *
+ * Compiled at configuration time from rejected regions (e.g. PHOS or hot spots), so that
+ * the patch finders only need a lookup per patch position to reject patches. Positions
+ * are in units of FastORs of the channel map, independent of the step of the patch finder.
+ */
+class TriggerPatchMask {
+public:
+	TriggerPatchMask();
+	TriggerPatchMask(int ncols, int nrows, int patchsize);
+	/**
+	 * Destructor
+	 */
+	virtual ~TriggerPatchMask() {}
+
+	void Configure(int ncols, int nrows, int patchsize);
+	void Reject(int col, int row);
+	void RejectOverlapping(const TriggerRegionMap::Region &region);
+	bool HasSameRejections(const TriggerPatchMask &other) const;
+
+	/**
+	 * Check whether a patch starting at a given position is accepted (no boundary check)
+	 * @param col Starting column of the patch
+	 * @param row Starting row of the patch
+	 * @return True if the patch is accepted
+	 */
+	bool IsAccepted(int col, int row) const { return fAccepted[row * fNCols + col]; }
+
+	/**
+	 * Check whether any position is rejected
+	 * @return True if at least one position is rejected
+	 */
+	bool HasRejections() const { return fNRejected > 0; }
+
+	/**
+	 * Get the patch size the mask is built for
+	 * @return Patch size
+	 */
+	int GetPatchSize() const { return fPatchSize; }
+
+private:
+	int							fNCols;				///< Number of columns of the channel map
+	int							fNRows;				///< Number of rows of the channel map
+	int							fPatchSize;			///< Size of the patches
+	int							fNRejected;			///< Number of rejected positions
+	std::vector<unsigned char>	fAccepted;			///< Acceptance flag per patch start position, row-major
+};
+
+#endif /* TRIGGERPATCHMASK_H */
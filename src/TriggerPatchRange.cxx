@@ -0,0 +1,54 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include "TriggerPatchRange.h"
+
+/**
+ * Constructor, creating an empty range
+ */
+TriggerPatchRange::TriggerPatchRange():
+	fNSegments(0)
+{
+	for(int iseg = 0; iseg < kMaxSegments; iseg++){
+		fBegin[iseg] = NULL;
+		fEnd[iseg] = NULL;
+	}
+}
+
+/**
+ * Append a contiguous list of patches to the range. Empty segments are
+ * ignored, as well as segments beyond the max. number of segments.
+ * @param begin Pointer to the first patch of the segment
+ * @param end Pointer behind the last patch of the segment
+ */
+void TriggerPatchRange::AddSegment(const PackedRawPatch *begin, const PackedRawPatch *end) {
+	if(begin == end || fNSegments >= kMaxSegments) return;
+	fBegin[fNSegments] = begin;
+	fEnd[fNSegments] = end;
+	fNSegments++;
+}
+
+/**
+ * Get the number of patches in the range
+ * @return Number of patches
+ */
+size_t TriggerPatchRange::size() const {
+	size_t result(0);
+	for(int iseg = 0; iseg < fNSegments; iseg++) result += fEnd[iseg] - fBegin[iseg];
+	return result;
+}
@@ -0,0 +1,124 @@
+#ifndef TRIGGERPATCHRANGE_H
+#define TRIGGERPATCHRANGE_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <cstddef>
+#include <iterator>
+
+#include "TriggerAlgorithm.h"
+
+/**
+ * @class TriggerPatchRange
+ * @brief Read-only view on the patches of one or several patch categories
+ *
+ * The range does not own the patches, it only refers to the patch lists stored
+ * in the TriggerMaker. Iterating over the range visits the patches of all selected
+ * categories one after the other, without copying. The range becomes invalid as
+ * soon as the patch lists are modified, i.e. when the trigger maker is reset or
+ * the patches are found again. Iterators carry the segment limits of their range,
+ * so they stay valid when the range object itself goes out of scope (e.g. when
+ * iterating over a range returned by value).
+ */
+class TriggerPatchRange {
+public:
+	enum {
+		kMaxSegments = 16
+	};
+
+	/**
+	 * @class const_iterator
+	 * @brief Forward iterator over all patches in the range
+	 */
+	class const_iterator {
+	public:
+		typedef std::forward_iterator_tag		iterator_category;
+		typedef PackedRawPatch					value_type;
+		typedef std::ptrdiff_t					difference_type;
+		typedef const PackedRawPatch *			pointer;
+		typedef const PackedRawPatch &			reference;
+
+		/**
+		 * Default constructor, creating an end iterator
+		 */
+		const_iterator(): fSegment(0), fNSegments(0), fCurrent(NULL) {
+			for(int iseg = 0; iseg < kMaxSegments; iseg++){
+				fBegin[iseg] = NULL;
+				fEnd[iseg] = NULL;
+			}
+		}
+
+		/**
+		 * Constructor, pointing to the first patch of the range
+		 * @param range Range to iterate over, its segment limits are copied
+		 */
+		explicit const_iterator(const TriggerPatchRange &range): fSegment(0), fNSegments(range.fNSegments), fCurrent(NULL) {
+			for(int iseg = 0; iseg < kMaxSegments; iseg++){
+				fBegin[iseg] = range.fBegin[iseg];
+				fEnd[iseg] = range.fEnd[iseg];
+			}
+			if(fNSegments) fCurrent = fBegin[0];
+		}
+
+		reference operator*() const { return *fCurrent; }
+		pointer operator->() const { return fCurrent; }
+
+		/**
+		 * Move to the next patch, switching to the next segment at the end of a segment
+		 * @return This iterator
+		 */
+		const_iterator &operator++() {
+			if(++fCurrent == fEnd[fSegment]){
+				if(++fSegment < fNSegments) fCurrent = fBegin[fSegment];
+				else fCurrent = NULL;
+			}
+			return *this;
+		}
+		const_iterator operator++(int) { const_iterator tmp(*this); ++(*this); return tmp; }
+
+		bool operator==(const const_iterator &other) const { return fCurrent == other.fCurrent; }
+		bool operator!=(const const_iterator &other) const { return fCurrent != other.fCurrent; }
+
+	private:
+		const PackedRawPatch			*fBegin[kMaxSegments];	///< Start of the patch segments of the range
+		const PackedRawPatch			*fEnd[kMaxSegments];	///< End of the patch segments of the range
+		int								fSegment;			///< Current segment
+		int								fNSegments;			///< Number of segments of the range
+		const PackedRawPatch			*fCurrent;			///< Current patch (NULL at the end of the range)
+	};
+
+	TriggerPatchRange();
+	~TriggerPatchRange() {}
+
+	void AddSegment(const PackedRawPatch *begin, const PackedRawPatch *end);
+	size_t size() const;
+
+	/**
+	 * Check whether the range contains patches
+	 * @return True if the range doesn't contain any patch
+	 */
+	bool empty() const { return fNSegments == 0; }
+
+	/**
+	 * Get iterator to the first patch in the range
+	 * @return Iterator to the first patch
+	 */
+	const_iterator begin() const { return const_iterator(*this); }
+
+	/**
+	 * Get iterator behind the last patch in the range
+	 * @return End iterator
+	 */
+	const_iterator end() const { return const_iterator(); }
+
+private:
+	const PackedRawPatch			*fBegin[kMaxSegments];			///< Start of the patch segments
+	const PackedRawPatch			*fEnd[kMaxSegments];			///< End of the patch segments
+	int								fNSegments;						///< Number of (non-empty) segments
+};
+
+#endif /* TRIGGERPATCHRANGE_H */
@@ -0,0 +1,41 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include "TriggerRandom.h"
+
+const double TriggerRandom::kTwoPi = 6.28318530717958647692528676655900577;
+
+/**
+ * Constructor
+ * @param seed Seed, e.g. the event number
+ * @param stream Index of the stream, separating independent random sequences for the same seed
+ */
+TriggerRandom::TriggerRandom(uint64_t seed, uint64_t stream):
+	fKey(0)
+{
+	SetSeed(seed, stream);
+}
+
+/**
+ * Set seed and stream of the generator
+ * @param seed Seed, e.g. the event number
+ * @param stream Index of the stream, separating independent random sequences for the same seed
+ */
+void TriggerRandom::SetSeed(uint64_t seed, uint64_t stream) {
+	fKey = Mix(Mix(seed + kGoldenGamma) ^ (stream * kGoldenGamma + 1));
+}
@@ -0,0 +1,83 @@
+#ifndef TRIGGERRANDOM_H
+#define TRIGGERRANDOM_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <cmath>
+#include <stdint.h>
+
+/**
+ * @class TriggerRandom
+ * @brief Counter-based random number generator
+ *
+ * Random numbers are a pure function of a key (derived from seed and stream) and a
+ * counter, so they don't depend on the order in which they are drawn: the n-th number
+ * of a stream is always the same, independent of how many numbers were drawn before
+ * or in other streams. Loops drawing one number per channel therefore have no
+ * dependency between iterations and are reproducible for a given seed.
+ * The counter is mixed with the key using the SplitMix64 finalizer.
+ */
+class TriggerRandom {
+public:
+	static const double kTwoPi;			///< 2 pi
+
+	TriggerRandom(uint64_t seed = 0, uint64_t stream = 0);
+	/**
+	 * Destructor
+	 */
+	virtual ~TriggerRandom() {}
+
+	void SetSeed(uint64_t seed, uint64_t stream = 0);
+
+	/**
+	 * Get the key of the generator
+	 * @return Key derived from seed and stream
+	 */
+	uint64_t GetKey() const { return fKey; }
+
+	/**
+	 * Get a 64 bit random number
+	 * @param counter Position in the stream
+	 * @return Random number
+	 */
+	uint64_t Integer(uint64_t counter) const { return Mix(fKey + counter * kGoldenGamma); }
+
+	/**
+	 * Get a uniformly distributed random number in the open interval (0,1)
+	 * @param counter Position in the stream
+	 * @return Random number
+	 */
+	double Uniform(uint64_t counter) const { return (double(Integer(counter) >> 11) + 0.5) * (1. / 9007199254740992.); }
+
+	/**
+	 * Get a random number from the normal distribution with mean 0 and width 1 (Box-Muller).
+	 * Uses the counters 2 * counter and 2 * counter + 1 of the stream.
+	 * @param counter Position in the stream
+	 * @return Random number
+	 */
+	double Gaus(uint64_t counter) const {
+		return std::sqrt(-2. * std::log(Uniform(2 * counter))) * std::cos(kTwoPi * Uniform(2 * counter + 1));
+	}
+
+	/**
+	 * SplitMix64 finalizer
+	 * @param value Input value
+	 * @return Mixed value
+	 */
+	static uint64_t Mix(uint64_t value) {
+		value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+		return value ^ (value >> 31);
+	}
+
+private:
+	static const uint64_t kGoldenGamma = 0x9e3779b97f4a7c15ULL;
+
+	uint64_t					fKey;				///< Key of the stream, derived from seed and stream
+};
+
+#endif /* TRIGGERRANDOM_H */
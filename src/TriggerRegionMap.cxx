@@ -0,0 +1,104 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+#include <cfloat>
+
+#include "TriggerChannelMap.h"
+#include "TriggerRegionMap.h"
+
+/**
+ * Constructor, building the region layout for a channel map of the given dimensions
+ * @param ncols Number of columns of the channel map
+ * @param nrows Number of rows of the channel map
+ */
+TriggerRegionMap::TriggerRegionMap(int ncols, int nrows):
+	fNCols(ncols),
+	fNRows(nrows),
+	fSupermoduleIndex(ncols * nrows, -1),
+	fTRUIndex(ncols * nrows, -1),
+	fSupermoduleOfTRU(),
+	fSupermodules(),
+	fTRUs()
+{
+	int ncolsSM = ncols / 2;
+	for(int rowmin = 0; rowmin < nrows; rowmin += kNRowsSector){
+		int rowmax = std::min(rowmin + kNRowsSector, nrows) - 1;
+		bool isFullSector = rowmax - rowmin + 1 == kNRowsSector;
+		int ncolsTRU = isFullSector ? kNColsTRU : kNColsTRUSmall;
+		for(int colminSM = 0; colminSM < ncols; colminSM += ncolsSM){
+			int ism = fSupermodules.size();
+			fSupermodules.push_back(Region(colminSM, std::min(colminSM + ncolsSM, ncols) - 1, rowmin, rowmax));
+			for(int colmin = colminSM; colmin <= fSupermodules.back().fColMax; colmin += ncolsTRU){
+				int itru = fTRUs.size();
+				fTRUs.push_back(Region(colmin, std::min(colmin + ncolsTRU - 1, fSupermodules.back().fColMax), rowmin, rowmax));
+				fSupermoduleOfTRU.push_back(ism);
+				for(int irow = rowmin; irow <= rowmax; irow++){
+					for(int icol = colmin; icol <= fTRUs.back().fColMax; icol++){
+						fSupermoduleIndex[irow * fNCols + icol] = ism;
+						fTRUIndex[irow * fNCols + icol] = itru;
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Check whether a square window is fully contained in one TRU
+ * @param col Starting column of the window
+ * @param row Starting row of the window
+ * @param size Size of the window
+ * @return True if all positions of the window belong to the same TRU (false for windows
+ *         not fully inside the channel map)
+ */
+bool TriggerRegionMap::IsWithinTRU(int col, int row, int size) const {
+	if(col < 0 || row < 0 || size < 1 || col + size > fNCols || row + size > fNRows) return false;
+	return fTRUs[GetTRUIndex(col, row)].Contains(col + size - 1, row + size - 1);
+}
+
+/**
+ * Calculate amplitude sum and max. amplitude of a single position for all TRUs and
+ * supermodules in one pass over the channel map.
+ * @param channels Input channel map (same dimensions as the region map)
+ * @param trusum Output: Amplitude sum per TRU
+ * @param trumax Output: Max. amplitude per TRU
+ * @param smsum Output: Amplitude sum per supermodule
+ * @param smmax Output: Max. amplitude per supermodule
+ */
+void TriggerRegionMap::ComputeAmplitudes(const TriggerChannelMap &channels, std::vector<double> &trusum, std::vector<double> &trumax,
+		std::vector<double> &smsum, std::vector<double> &smmax) const {
+	trusum.assign(fTRUs.size(), 0.);
+	trumax.assign(fTRUs.size(), -DBL_MAX);
+	for(int irow = 0; irow < fNRows; irow++){
+		for(int icol = 0; icol < fNCols; icol++){
+			double adc = channels.GetADC(icol, irow);
+			int itru = fTRUIndex[irow * fNCols + icol];
+			trusum[itru] += adc;
+			if(adc > trumax[itru]) trumax[itru] = adc;
+		}
+	}
+	// Supermodule amplitudes from the TRU amplitudes
+	smsum.assign(fSupermodules.size(), 0.);
+	smmax.assign(fSupermodules.size(), -DBL_MAX);
+	for(size_t itru = 0; itru < fTRUs.size(); itru++){
+		int ism = fSupermoduleOfTRU[itru];
+		smsum[ism] += trusum[itru];
+		if(trumax[itru] > smmax[ism]) smmax[ism] = trumax[itru];
+	}
+}
@@ -0,0 +1,153 @@
+#ifndef TRIGGERREGIONMAP_H
+#define TRIGGERREGIONMAP_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <vector>
+
+class TriggerChannelMap;
+
+/**
+ * @class TriggerRegionMap
+ * @brief Partitioning of a trigger channel map into supermodules and TRUs
+ *
+ * Maps each position (col, row) of a channel map to the supermodule and the trigger
+ * region unit (TRU) it belongs to. The layout follows the simple trigger mapping:
+ * - In phi the channel map is divided in sectors of 12 rows (full supermodules), the
+ *   remaining rows forming a sector of small supermodules
+ * - Each sector consists of two supermodules in eta (A and C side), each covering half
+ *   of the columns
+ * - A full supermodule is read out by 3 TRUs of 8 columns, a small supermodule by one
+ *   TRU covering the full supermodule
+ * As in the simple mapping, DCAL supermodules are treated like EMCAL supermodules
+ * and PHOS is part of the DCAL supermodules.
+ *
+ * Region indices run first in eta, then in phi. Bounding boxes of all regions are
+ * precomputed, and amplitude sums and maxima for all regions can be obtained in a
+ * single pass over the channel map.
+ *
+ * Empty regions are not skipped on TRU or supermodule level: the patch finders skip
+ * untouched 4x4 subregions using the occupancy of the channel map (TriggerChannelMap),
+ * which is finer than the TRUs.
+ */
+class TriggerRegionMap {
+public:
+	enum {
+		kNRowsSector = 12,
+		kNColsTRU = 8,
+		kNColsTRUSmall = 24
+	};
+
+	/**
+	 * @struct Region
+	 * @brief Bounding box of a region in col-row space (limits inclusive)
+	 */
+	struct Region {
+		Region(): fColMin(0), fColMax(-1), fRowMin(0), fRowMax(-1) {}
+		Region(int colmin, int colmax, int rowmin, int rowmax): fColMin(colmin), fColMax(colmax), fRowMin(rowmin), fRowMax(rowmax) {}
+
+		bool Contains(int col, int row) const { return col >= fColMin && col <= fColMax && row >= fRowMin && row <= fRowMax; }
+
+		int				fColMin;			///< First column of the region
+		int				fColMax;			///< Last column of the region
+		int				fRowMin;			///< First row of the region
+		int				fRowMax;			///< Last row of the region
+	};
+
+	TriggerRegionMap(int ncols, int nrows);
+	virtual ~TriggerRegionMap() {}
+
+	/**
+	 * Get the number of columns of the channel map
+	 * @return Number of columns
+	 */
+	int GetNumberOfCols() const { return fNCols; }
+	/**
+	 * Get the number of rows of the channel map
+	 * @return Number of rows
+	 */
+	int GetNumberOfRows() const { return fNRows; }
+
+	/**
+	 * Get the number of supermodules
+	 * @return Number of supermodules
+	 */
+	int GetNumberOfSupermodules() const { return fSupermodules.size(); }
+	/**
+	 * Get the number of TRUs
+	 * @return Number of TRUs
+	 */
+	int GetNumberOfTRUs() const { return fTRUs.size(); }
+
+	/**
+	 * Get the supermodule index of a position
+	 * @param col Column of the position
+	 * @param row Row of the position
+	 * @return Index of the supermodule
+	 */
+	int GetSupermoduleIndex(int col, int row) const { return fSupermoduleIndex[row * fNCols + col]; }
+	/**
+	 * Get the TRU index of a position
+	 * @param col Column of the position
+	 * @param row Row of the position
+	 * @return Index of the TRU
+	 */
+	int GetTRUIndex(int col, int row) const { return fTRUIndex[row * fNCols + col]; }
+
+	/**
+	 * Get the bounding box of a supermodule
+	 * @param ism Index of the supermodule
+	 * @return Bounding box of the supermodule
+	 */
+	const Region &GetSupermodule(int ism) const { return fSupermodules[ism]; }
+	/**
+	 * Get the bounding box of a TRU
+	 * @param itru Index of the TRU
+	 * @return Bounding box of the TRU
+	 */
+	const Region &GetTRU(int itru) const { return fTRUs[itru]; }
+
+	/**
+	 * Get the supermodule a TRU belongs to
+	 * @param itru Index of the TRU
+	 * @return Index of the supermodule
+	 */
+	int GetSupermoduleOfTRU(int itru) const { return fSupermoduleOfTRU[itru]; }
+
+	bool IsWithinTRU(int col, int row, int size) const;
+
+	void ComputeAmplitudes(const TriggerChannelMap &channels, std::vector<double> &trusum, std::vector<double> &trumax,
+			std::vector<double> &smsum, std::vector<double> &smmax) const;
+
+	/**
+	 * Check whether a 2x2 window is fully contained in one TRU, using only the
+	 * layout rules (no lookup), for the inner loops of the Level0 finders. The rule
+	 * agrees with IsWithinTRU(col, row, 2) of the region map of a channel map with
+	 * nrows rows and 48 columns.
+	 * @param col Starting column of the window
+	 * @param row Starting row of the window
+	 * @param nrows Number of rows of the channel map
+	 * @return True if all positions of the window belong to the same TRU
+	 */
+	static bool IsWindow2x2WithinTRU(int col, int row, int nrows) {
+		int sector = row / kNRowsSector;
+		if(sector != (row + 1) / kNRowsSector) return false;
+		int ncolsTRU = ((sector + 1) * kNRowsSector <= nrows) ? kNColsTRU : kNColsTRUSmall;
+		return col / ncolsTRU == (col + 1) / ncolsTRU;
+	}
+
+private:
+	int								fNCols;					///< Number of columns of the channel map
+	int								fNRows;					///< Number of rows of the channel map
+	std::vector<int>				fSupermoduleIndex;		///< Supermodule index per position
+	std::vector<int>				fTRUIndex;				///< TRU index per position
+	std::vector<int>				fSupermoduleOfTRU;		///< Supermodule index per TRU
+	std::vector<Region>				fSupermodules;			///< Bounding boxes of the supermodules
+	std::vector<Region>				fTRUs;					///< Bounding boxes of the TRUs
+};
+
+#endif /* TRIGGERREGIONMAP_H */
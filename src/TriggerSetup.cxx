@@ -23,9 +23,12 @@
  */
 TriggerSetup::TriggerSetup() :
   fThresholds(),
-  fTriggerBitConfig()
+  fThresholdL0(-1),
+  fTriggerBitConfig(),
+  fTriggerClasses()
 {
   for( int i = 0; i < 4; i++) fThresholds[i] = -1;
+  BuildThresholdTables();
 }
 
 /**
@@ -33,11 +36,12 @@ TriggerSetup::TriggerSetup() :
  * \param p Reference for the copy
  */
 TriggerSetup::TriggerSetup(const TriggerSetup &p) :
-  fTriggerBitConfig()
+  fThresholdL0(-1),
+  fTriggerBitConfig(),
+  fTriggerClasses()
 {
   // Copy constructor.
-  for( int i = 0; i < 4; i++ ) fThresholds[i] = p.fThresholds[i];
-  fTriggerBitConfig.Initialise(p.fTriggerBitConfig);
+  CopyTriggerMenu(p);
 }
 
 /**
@@ -46,19 +50,145 @@ TriggerSetup::TriggerSetup(const TriggerSetup &p) :
  * @return This object
  */
 TriggerSetup &TriggerSetup::operator=(const TriggerSetup &p){
-  if (this != &p) {
-    for( int i = 0; i < 4; i++ )
-      fThresholds[i] = p.fThresholds[i];
-    fTriggerBitConfig.Initialise(p.fTriggerBitConfig);
-  }
+  if (this != &p) CopyTriggerMenu(p);
 
   return *this;
 }
 
+/**
+ * Copy thresholds, trigger bits and trigger classes from another setup and rebuild the
+ * threshold tables. The trigger bit configuration is validated as in SetTriggerBitConfig
+ * unless named trigger classes are defined, which don't use it.
+ * @param p Setup to copy
+ * @throw TriggerBitConfig::InvalidConfigurationException in case the legacy thresholds are used without valid trigger bits
+ */
+void TriggerSetup::CopyTriggerMenu(const TriggerSetup &p){
+  if(p.fTriggerClasses.size()) fTriggerBitConfig = p.fTriggerBitConfig;
+  else fTriggerBitConfig.Initialise(p.fTriggerBitConfig);
+  for( int i = 0; i < 4; i++ )
+    fThresholds[i] = p.fThresholds[i];
+  fThresholdL0 = p.fThresholdL0;
+  fTriggerClasses = p.fTriggerClasses;
+  BuildThresholdTables();
+}
+
 /**
  * Cleaning function, resets all arrays to 0
  */
 void TriggerSetup::Clean(){
   for( int i = 0; i < 4; i++ )
     fThresholds[i] = -1;
+  fThresholdL0 = -1;
+  fTriggerClasses.clear();
+  BuildThresholdTables();
+}
+
+/**
+ * Add a named trigger class. Once trigger classes are defined, the patch finders
+ * use only the trigger classes and ignore the legacy thresholds.
+ * @param name Name of the trigger class, has to be unique
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @param threshold Threshold in ADC counts
+ * @param bit Trigger bit set for patches above threshold
+ * @throw InvalidTriggerClassException in case the name is already used, or category or bit are invalid
+ */
+void TriggerSetup::AddTriggerClass(const std::string &name, int category, double threshold, int bit) {
+  if(FindTriggerClass(name))
+    throw InvalidTriggerClassException(name, "name already used");
+  if(category < RawPatch::kEMCALpatchGA || category > RawPatch::kDCALpatchL0)
+    throw InvalidTriggerClassException(name, "invalid patch category");
+  if(bit < 0 || bit >= PackedRawPatch::kNTriggerBits)
+    throw InvalidTriggerClassException(name, "trigger bit out of range");
+  TriggerClass triggerclass;
+  triggerclass.fName = name;
+  triggerclass.fCategory = category;
+  triggerclass.fThreshold = threshold;
+  triggerclass.fBit = bit;
+  fTriggerClasses.push_back(triggerclass);
+  BuildThresholdTables();
+}
+
+/**
+ * Remove all named trigger classes, the patch finders use the legacy thresholds again
+ */
+void TriggerSetup::ClearTriggerClasses() {
+  fTriggerClasses.clear();
+  BuildThresholdTables();
+}
+
+/**
+ * Find a named trigger class
+ * @param name Name of the trigger class
+ * @return Trigger class (NULL if not found)
+ */
+const TriggerSetup::TriggerClass *TriggerSetup::FindTriggerClass(const std::string &name) const {
+  for(std::vector<TriggerClass>::const_iterator classiter = fTriggerClasses.begin(); classiter != fTriggerClasses.end(); ++classiter)
+    if(classiter->fName == name) return &(*classiter);
+  return NULL;
+}
+
+/**
+ * Get the threshold table of a patch category, containing either all named trigger
+ * classes of the category or, if no trigger classes are defined, the legacy thresholds
+ * of the category. The tables are built when the setup changes.
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Threshold table of the category
+ * @throw TriggerBitConfig::InvalidConfigurationException in case the legacy thresholds are used without valid trigger bit
+ */
+const TriggerThresholdTable &TriggerSetup::GetThresholdTable(int category) const {
+  int index = category - RawPatch::kEMCALpatchGA;
+  if(!fHasThresholdTable[index]){
+    // throws the exception of the missing trigger bit
+    TriggerThresholdTable table;
+    BuildThresholdTable(category, table);
+  }
+  return fThresholdTables[index];
+}
+
+/**
+ * Build the threshold tables of all categories. Tables of categories for which a
+ * trigger bit is missing are marked invalid, the error is reported when they are requested.
+ */
+void TriggerSetup::BuildThresholdTables() {
+  for(int icat = 0; icat < kNCategories; icat++){
+    try {
+      BuildThresholdTable(icat + RawPatch::kEMCALpatchGA, fThresholdTables[icat]);
+      fHasThresholdTable[icat] = true;
+    } catch(TriggerBitConfig::InvalidConfigurationException &) {
+      fThresholdTables[icat].Clear();
+      fHasThresholdTable[icat] = false;
+    }
+  }
+}
+
+/**
+ * Fill the threshold table of a patch category
+ * @param category Patch category
+ * @param table Table to be filled
+ */
+void TriggerSetup::BuildThresholdTable(int category, TriggerThresholdTable &table) const {
+  table.Clear();
+  if(fTriggerClasses.size()){
+    for(std::vector<TriggerClass>::const_iterator classiter = fTriggerClasses.begin(); classiter != fTriggerClasses.end(); ++classiter)
+      if(classiter->fCategory == category) table.AddThreshold(classiter->fThreshold, classiter->fBit);
+    return;
+  }
+  switch(category){
+  case RawPatch::kEMCALpatchGA:
+  case RawPatch::kDCALpatchGA:
+    table.AddThreshold(GetThresholdGammaHigh(), fTriggerBitConfig.GetGammaHighBit());
+    table.AddThreshold(GetThresholdGammaLow(), fTriggerBitConfig.GetGammaLowBit());
+    break;
+  case RawPatch::kEMCALpatchJE:
+  case RawPatch::kDCALpatchJE:
+  case RawPatch::kEMCALpatchJE8x8:
+  case RawPatch::kDCALpatchJE8x8:
+    table.AddThreshold(GetThresholdJetHigh(), fTriggerBitConfig.GetJetHighBit());
+    table.AddThreshold(GetThresholdJetLow(), fTriggerBitConfig.GetJetLowBit());
+    break;
+  case RawPatch::kEMCALpatchL0:
+  case RawPatch::kDCALpatchL0:
+    table.AddThreshold(GetThresholdL0(), fTriggerBitConfig.GetLevel0Bit());
+    break;
+  };
 }
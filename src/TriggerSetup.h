@@ -7,13 +7,62 @@
  *  (at your option) any later version. (See cxx source for full Copyright notice)
  */
 
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "TriggerAlgorithm.h"
 #include "TriggerBitConfig.h"
+#include "TriggerThresholdTable.h"
 
 /**
  * @class TriggerSetup
+ * @brief Thresholds and trigger bits of the trigger patch finders
+ *
+ * The trigger menu is given either by the legacy thresholds (jet and gamma high and low,
+ * Level0) together with the trigger bit configuration, or by an arbitrary number of named
+ * trigger classes, each defined by patch category, threshold and trigger bit. Several menus
+ * can be emulated at the same time by defining their trigger classes with different bits.
+ * Once named trigger classes are defined, they replace the legacy thresholds for the
+ * patch finders. For each patch category the finders use a threshold table
+ * (see TriggerThresholdTable) evaluating all trigger classes of the category at once.
+ * The tables are rebuilt whenever the setup changes, so a const setup can be shared
+ * between threads.
  */
 class TriggerSetup {
 public:
+	enum {
+		kNCategories = RawPatch::kDCALpatchL0 - RawPatch::kEMCALpatchGA + 1
+	};
+
+	/**
+	 * @struct TriggerClass
+	 * @brief Named trigger class
+	 */
+	struct TriggerClass {
+		std::string				fName;				///< Name of the trigger class
+		int						fCategory;			///< Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+		double					fThreshold;			///< Threshold in ADC counts
+		int						fBit;				///< Trigger bit
+	};
+
+	class InvalidTriggerClassException : public std::exception{
+	public:
+		InvalidTriggerClassException(const std::string &name, const std::string &reason):
+			exception(),
+			fMessage("")
+		{
+			fMessage = "Invalid trigger class " + name + ": " + reason;
+		}
+		virtual ~InvalidTriggerClassException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string				fMessage;			///< Error message
+	};
+
 	TriggerSetup();
 	TriggerSetup(const TriggerSetup &p);
 	TriggerSetup &operator=(const TriggerSetup &p);
@@ -28,18 +77,49 @@ public:
 	double GetThresholdGammaLow() const { return fThresholds[3]; }
 	double GetThresholdGammaHigh() const { return fThresholds[1]; }
 
+	double GetThresholdL0() const { return fThresholdL0; }
+
 	const TriggerBitConfig &GetTriggerBitConfiguration() const { return fTriggerBitConfig; }
 
 	void SetThresholds( double i0, double i1, double i2, double i3 ) {
-		fThresholds[0] = i0; fThresholds[1] = i1; fThresholds[2] = i2; fThresholds[3] = i3;}
+		fThresholds[0] = i0; fThresholds[1] = i1; fThresholds[2] = i2; fThresholds[3] = i3;
+		BuildThresholdTables();
+	}
+	void SetThresholdL0(double threshold) { fThresholdL0 = threshold; BuildThresholdTables(); }
 	void SetTriggerBitConfig(const TriggerBitConfig &ref){
 		fTriggerBitConfig.Initialise(ref);
+		BuildThresholdTables();
 	}
 
+	void AddTriggerClass(const std::string &name, int category, double threshold, int bit);
+	void ClearTriggerClasses();
+	/**
+	 * Get the number of named trigger classes
+	 * @return Number of trigger classes
+	 */
+	int GetNumberOfTriggerClasses() const { return fTriggerClasses.size(); }
+	/**
+	 * Get a named trigger class (no boundary check)
+	 * @param index Index of the trigger class, in the order the classes were added
+	 * @return Trigger class
+	 */
+	const TriggerClass &GetTriggerClass(int index) const { return fTriggerClasses[index]; }
+	const TriggerClass *FindTriggerClass(const std::string &name) const;
+
+	const TriggerThresholdTable &GetThresholdTable(int category) const;
+
 	void Clean();
 
 protected:
+	void BuildThresholdTables();
+	void BuildThresholdTable(int category, TriggerThresholdTable &table) const;
+	void CopyTriggerMenu(const TriggerSetup &p);
+
 	double                                  fThresholds[4];                 ///< per event L1 online thresholds in ADC counts
+	double                                  fThresholdL0;                   ///< L0 threshold in ADC counts
 	TriggerBitConfig                		fTriggerBitConfig;              ///< Trigger bit configuration
+	std::vector<TriggerClass>				fTriggerClasses;				///< Named trigger classes
+	TriggerThresholdTable					fThresholdTables[kNCategories];	///< Threshold tables per patch category
+	bool									fHasThresholdTable[kNCategories];	///< Flags whether the threshold table of a category is valid (false if trigger bits are missing)
 };
 #endif
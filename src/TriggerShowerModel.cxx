@@ -0,0 +1,143 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+#include <math.h>
+
+#include "TriggerBadChannelContainer.h"
+#include "TriggerChannelMap.h"
+#include "TriggerShowerModel.h"
+
+namespace {
+const double kSqrt2 = 1.41421356237309504880168872420969808;		// sqrt(2)
+}
+
+/**
+ * Constructor, building the kernels with the default shower widths: 0.25 FastORs for
+ * electromagnetic showers (Moliere radius relative to the FastOR size of 12 cm) and
+ * 0.6 FastORs for hadronic showers
+ * @param kernelsize Number of FastORs of the kernel in col and row direction (positive, odd)
+ * @param nbins Number of impact position bins per FastOR and direction
+ * @throw InvalidKernelSizeException if the kernel size is not a positive odd number
+ */
+TriggerShowerModel::TriggerShowerModel(int kernelsize, int nbins):
+	fKernelSize(kernelsize),
+	fNBins(nbins > 0 ? nbins : 1),
+	fKernels()
+{
+	if(kernelsize <= 0 || kernelsize % 2 == 0) throw InvalidKernelSizeException(kernelsize);
+	fKernels.assign(kNParticleTypes * fNBins * fNBins * fKernelSize * fKernelSize, 0.);
+	fWidth[kElectromagnetic] = 0.25;
+	fWidth[kHadronic] = 0.6;
+	for(int itype = 0; itype < kNParticleTypes; itype++) BuildKernels(static_cast<ParticleType>(itype));
+}
+
+/**
+ * Set the width of the lateral shower profile of a particle type and rebuild its kernels
+ * @param type Particle type
+ * @param width Width in units of the FastOR size (0: all energy in the FastOR hit)
+ */
+void TriggerShowerModel::SetShowerWidth(ParticleType type, double width) {
+	fWidth[type] = width;
+	BuildKernels(type);
+}
+
+/**
+ * Get the kernel for a particle type and impact position
+ * @param type Particle type
+ * @param colfraction Impact position along the column direction inside the FastOR (0 - 1)
+ * @param rowfraction Impact position along the row direction inside the FastOR (0 - 1)
+ * @return Weights of the kernel (row-major, kernel size x kernel size)
+ */
+const double *TriggerShowerModel::GetKernel(ParticleType type, double colfraction, double rowfraction) const {
+	return &fKernels[((type * fNBins + GetBin(rowfraction)) * fNBins + GetBin(colfraction)) * fKernelSize * fKernelSize];
+}
+
+/**
+ * Deposit the energy of a particle in the channel map, shared between the FastORs of
+ * the kernel around the FastOR hit. Energy shared to positions outside the channel map
+ * or to bad channels is lost.
+ * @param channels Channel map
+ * @param col Column of the FastOR hit
+ * @param row Row of the FastOR hit
+ * @param colfraction Impact position along the column direction inside the FastOR (0 - 1)
+ * @param rowfraction Impact position along the row direction inside the FastOR (0 - 1)
+ * @param energy Energy of the particle
+ * @param type Particle type
+ * @param badchannels Optional list of bad channels
+ */
+void TriggerShowerModel::Deposit(TriggerChannelMap &channels, int col, int row, double colfraction, double rowfraction, double energy,
+		ParticleType type, const TriggerBadChannelContainer *badchannels) const {
+	const double *kernel = GetKernel(type, colfraction, rowfraction);
+	int half = fKernelSize / 2;
+	int rowmin = std::max(half - row, 0), rowmax = std::min(channels.GetNumberOfRows() - 1 - row + half, fKernelSize - 1),
+		colmin = std::max(half - col, 0), colmax = std::min(channels.GetNumberOfCols() - 1 - col + half, fKernelSize - 1);
+	for(int krow = rowmin; krow <= rowmax; krow++){
+		for(int kcol = colmin; kcol <= colmax; kcol++){
+			double weight = kernel[krow * fKernelSize + kcol];
+			if(weight == 0.) continue;
+			int channelcol = col + kcol - half, channelrow = row + krow - half;
+			if(badchannels && badchannels->HasChannel(channelcol, channelrow)) continue;
+			channels.AddADC(channelcol, channelrow, energy * weight);
+		}
+	}
+}
+
+/**
+ * Compute the kernels of a particle type for all impact position bins. The weight of a
+ * FastOR is the product of the integrals of the Gaussian profile over the FastOR in
+ * col and row direction, for an impact position at the bin center.
+ * @param type Particle type
+ */
+void TriggerShowerModel::BuildKernels(ParticleType type) {
+	int half = fKernelSize / 2;
+	double width = fWidth[type];
+	std::vector<double> shares(fNBins * fKernelSize);
+	for(int ibin = 0; ibin < fNBins; ibin++){
+		double position = (ibin + 0.5) / fNBins, sum(0);
+		for(int ik = 0; ik < fKernelSize; ik++){
+			double lower = ik - half - position, upper = lower + 1., share(0);
+			if(width > 0.)
+				share = 0.5 * (erf(upper / (width * kSqrt2)) - erf(lower / (width * kSqrt2)));
+			else
+				share = ik == half ? 1. : 0.;
+			shares[ibin * fKernelSize + ik] = share;
+			sum += share;
+		}
+		for(int ik = 0; ik < fKernelSize; ik++) shares[ibin * fKernelSize + ik] /= sum;
+	}
+
+	for(int rowbin = 0; rowbin < fNBins; rowbin++){
+		for(int colbin = 0; colbin < fNBins; colbin++){
+			double *kernel = &fKernels[((type * fNBins + rowbin) * fNBins + colbin) * fKernelSize * fKernelSize];
+			for(int krow = 0; krow < fKernelSize; krow++)
+				for(int kcol = 0; kcol < fKernelSize; kcol++)
+					kernel[krow * fKernelSize + kcol] = shares[rowbin * fKernelSize + krow] * shares[colbin * fKernelSize + kcol];
+		}
+	}
+}
+
+/**
+ * Get the impact position bin
+ * @param fraction Impact position inside the FastOR (0 - 1)
+ * @return Bin index
+ */
+int TriggerShowerModel::GetBin(double fraction) const {
+	int bin = static_cast<int>(fraction * fNBins);
+	return bin < 0 ? 0 : (bin >= fNBins ? fNBins - 1 : bin);
+}
@@ -0,0 +1,100 @@
+#ifndef TRIGGERSHOWERMODEL_H
+#define TRIGGERSHOWERMODEL_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class TriggerBadChannelContainer;
+class TriggerChannelMap;
+
+/**
+ * @class TriggerShowerModel
+ * @brief Sharing of the particle energy between neighboring FastORs
+ *
+ * The lateral shower profile is approximated by a Gaussian of a given width (in units
+ * of the FastOR size) for each particle type. The fraction of the energy deposited in
+ * the FastORs of a square kernel (3x3 or 5x5) around the FastOR hit by the particle is
+ * precomputed for a grid of impact positions inside the FastOR, so that the deposition
+ * only needs a table lookup and a multiply-add per FastOR. Energy outside the kernel
+ * is assigned to the kernel (the weights are normalized).
+ */
+class TriggerShowerModel {
+public:
+	enum ParticleType {
+		kElectromagnetic = 0,
+		kHadronic = 1,
+		kNParticleTypes = 2
+	};
+
+	/**
+	 * @class InvalidKernelSizeException
+	 * @brief Exception thrown for a kernel size which is not a positive odd number
+	 */
+	class InvalidKernelSizeException : public std::exception{
+	public:
+		InvalidKernelSizeException(int kernelsize):
+			exception(),
+			fMessage("")
+		{
+			std::stringstream msgbuilder;
+			msgbuilder << "Invalid kernel size " << kernelsize << ": must be a positive odd number";
+			fMessage = msgbuilder.str();
+		}
+		virtual ~InvalidKernelSizeException() throw() {}
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string				fMessage;			///< Error message
+	};
+
+	TriggerShowerModel(int kernelsize = 3, int nbins = 8);
+	/**
+	 * Destructor
+	 */
+	virtual ~TriggerShowerModel() {}
+
+	void SetShowerWidth(ParticleType type, double width);
+	/**
+	 * Get the width of the lateral shower profile
+	 * @param type Particle type
+	 * @return Width in units of the FastOR size
+	 */
+	double GetShowerWidth(ParticleType type) const { return fWidth[type]; }
+
+	/**
+	 * Get the size of the kernel
+	 * @return Number of FastORs in col and row direction
+	 */
+	int GetKernelSize() const { return fKernelSize; }
+	/**
+	 * Get the number of impact position bins per FastOR and direction
+	 * @return Number of bins
+	 */
+	int GetNumberOfBins() const { return fNBins; }
+
+	const double *GetKernel(ParticleType type, double colfraction, double rowfraction) const;
+
+	void Deposit(TriggerChannelMap &channels, int col, int row, double colfraction, double rowfraction, double energy,
+			ParticleType type, const TriggerBadChannelContainer *badchannels = NULL) const;
+
+private:
+	void BuildKernels(ParticleType type);
+	int GetBin(double fraction) const;
+
+	int							fKernelSize;					///< Number of FastORs of the kernel in col and row direction
+	int							fNBins;							///< Number of impact position bins per FastOR and direction
+	double						fWidth[kNParticleTypes];		///< Width of the lateral shower profile per particle type, in FastOR units
+	std::vector<double>			fKernels;						///< Weights, indexed by particle type, row bin, col bin, row and col in kernel
+};
+
+#endif /* TRIGGERSHOWERMODEL_H */
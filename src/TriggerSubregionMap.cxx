@@ -0,0 +1,87 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+
+#include "TriggerChannelMap.h"
+#include "TriggerSubregionMap.h"
+
+/**
+ * Constructor, initializing the subregion map for a channel map of the given size
+ * @param ncols Number of FastOR columns of the channel map
+ * @param nrows Number of FastOR rows of the channel map
+ */
+TriggerSubregionMap::TriggerSubregionMap(int ncols, int nrows):
+	fNCols((ncols + kSubregionSize - 1) / kSubregionSize),
+	fNRows((nrows + kSubregionSize - 1) / kSubregionSize),
+	fADC(fNCols * fNRows, 0.)
+{
+}
+
+/**
+ * Set all subregion amplitudes to 0
+ */
+void TriggerSubregionMap::Reset() {
+	std::fill(fADC.begin(), fADC.end(), 0.);
+}
+
+/**
+ * Sum the FastOR amplitudes of the channel map in each subregion. Subregions not
+ * touched since the last reset of the channel map (see TriggerChannelMap::GetOccupancyMask)
+ * are set to 0 without reading the channel map. For channel maps in the tiled layout each
+ * subregion is summed from its contiguous tile.
+ * @param channels Input channel map
+ */
+void TriggerSubregionMap::Fill(const TriggerChannelMap &channels) {
+	for(int srow = 0; srow < fNRows; srow++){
+		int rowmin = srow * kSubregionSize, rowmax = std::min(rowmin + kSubregionSize, channels.GetNumberOfRows()) - 1;
+		unsigned long long occupancy = channels.GetOccupancyMask(rowmin, rowmax);
+		for(int scol = 0; scol < fNCols; scol++){
+			double adcsum(0);
+			int colmin = scol * kSubregionSize, colmax = std::min(colmin + kSubregionSize, channels.GetNumberOfCols()) - 1;
+			if(TriggerChannelMap::IsOccupied(occupancy, colmin, colmax)){
+				if(channels.GetLayout() == TriggerChannelMap::kTiled){
+					// same summation order, channels outside the map are 0
+					const double *tile = channels.GetTileData(scol, srow);
+					for(int ichannel = 0; ichannel < TriggerChannelMap::kTileSize; ichannel++) adcsum += tile[ichannel];
+				} else {
+					for(int irow = rowmin; irow <= rowmax; irow++)
+						for(int icol = colmin; icol <= colmax; icol++)
+							adcsum += channels.GetADC(icol, irow);
+				}
+			}
+			fADC[srow * fNCols + scol] = adcsum;
+		}
+	}
+}
+
+/**
+ * Get the amplitude of a square window of subregions (no boundary check)
+ * @param col First subregion column of the window
+ * @param row First subregion row of the window
+ * @param size Size of the window in subregions
+ * @return Sum of the subregion amplitudes in the window
+ */
+double TriggerSubregionMap::GetWindowADC(int col, int row, int size) const {
+	double adcsum(0);
+	for(int irow = row; irow < row + size; irow++){
+		const double *subregions = &fADC[irow * fNCols + col];
+		for(int icol = 0; icol < size; icol++) adcsum += subregions[icol];
+	}
+	return adcsum;
+}
@@ -0,0 +1,72 @@
+#ifndef TRIGGERSUBREGIONMAP_H
+#define TRIGGERSUBREGIONMAP_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <vector>
+
+class TriggerChannelMap;
+
+/**
+ * @class TriggerSubregionMap
+ * @brief Map of 4x4 FastOR subregion amplitudes
+ *
+ * Reduces a trigger channel map to the amplitude sums of the 4x4 FastOR subregions,
+ * as done in the STU before the jet patch finding (12x16 subregions for the EMCAL,
+ * 12x10 for the DCAL-PHOS). Jet patches aligned to the subregion grid are then sums
+ * of 4x4 (16x16 FastOR patches) or 2x2 (8x8 FastOR patches) subregions. Subregion
+ * amplitudes can also be used directly, e.g. for the estimation of the underlying
+ * event density.
+ */
+class TriggerSubregionMap {
+public:
+	enum {
+		kSubregionSize = 4
+	};
+
+	TriggerSubregionMap(int ncols, int nrows);
+	virtual ~TriggerSubregionMap() {}
+
+	void Fill(const TriggerChannelMap &channels);
+	void Reset();
+
+	/**
+	 * Get the number of subregion columns
+	 * @return Number of subregion columns
+	 */
+	int GetNumberOfCols() const { return fNCols; }
+	/**
+	 * Get the number of subregion rows
+	 * @return Number of subregion rows
+	 */
+	int GetNumberOfRows() const { return fNRows; }
+
+	/**
+	 * Get the amplitude of a subregion (no boundary check)
+	 * @param col Subregion column
+	 * @param row Subregion row
+	 * @return Sum of the amplitudes of the FastORs in the subregion
+	 */
+	double GetADC(int col, int row) const { return fADC[row * fNCols + col]; }
+
+	/**
+	 * Set the amplitude of a subregion (no boundary check)
+	 * @param col Subregion column
+	 * @param row Subregion row
+	 * @param adc Sum of the amplitudes of the FastORs in the subregion
+	 */
+	void SetADC(int col, int row, double adc) { fADC[row * fNCols + col] = adc; }
+
+	double GetWindowADC(int col, int row, int size) const;
+
+private:
+	int						fNCols;				///< Number of subregion columns
+	int						fNRows;				///< Number of subregion rows
+	std::vector<double>		fADC;				///< Subregion amplitudes, row-major
+};
+
+#endif /* TRIGGERSUBREGIONMAP_H */
@@ -0,0 +1,173 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <istream>
+#include <ostream>
+
+#include "TriggerMaker.h"
+#include "TriggerSummary.h"
+
+/**
+ * Set the summary to the state of a category without patches
+ */
+void TriggerSummary::CategorySummary::Reset() {
+	fNPatches = 0;
+	fTriggerBits = 0;
+	fMaxTriggerBits = 0;
+	fMaxADC = -1.f;
+	fMaxCol = 0;
+	fMaxRow = 0;
+	fPatchSize = 0;
+	fPatchType = RawPatch::kUndefPatch;
+	fMedianADC = 0.;
+}
+
+/**
+ * Constructor, initializing all categories without patches
+ */
+TriggerSummary::TriggerSummary() {
+	Reset();
+}
+
+/**
+ * Reset all categories to the state without patches
+ */
+void TriggerSummary::Reset() {
+	for(int icat = 0; icat < kNCategories; icat++) fCategories[icat].Reset();
+}
+
+/**
+ * Summarize a patch list of a category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @param patches Patches of the category, sorted by amplitude
+ */
+void TriggerSummary::Fill(int category, const std::vector<PackedRawPatch> &patches) {
+	CategorySummary &summary = GetCategorySummary(category);
+	summary.Reset();
+	if(patches.empty()) return;
+	summary.fNPatches = patches.size();
+	for(std::vector<PackedRawPatch>::const_iterator patchiter = patches.begin(); patchiter != patches.end(); ++patchiter)
+		summary.fTriggerBits |= patchiter->GetTriggerBits();
+	const PackedRawPatch &maxpatch = PackedRawPatch::GetMaxPatch(patches);
+	summary.fMaxTriggerBits = maxpatch.GetTriggerBits();
+	summary.fMaxADC = maxpatch.GetADC();
+	summary.fMaxCol = maxpatch.GetColStart();
+	summary.fMaxRow = maxpatch.GetRowStart();
+	summary.fPatchSize = maxpatch.GetPatchSize();
+	summary.fPatchType = maxpatch.GetPatchType();
+	size_t halfsize = patches.size() / 2;
+	summary.fMedianADC = patches.size() % 2 ? patches[halfsize].GetADC() : (patches[halfsize - 1].GetADC() + patches[halfsize].GetADC()) / 2;
+}
+
+/**
+ * Get the trigger bits fired in any category
+ * @return Trigger bits of the event
+ */
+int TriggerSummary::GetTriggerBits() const {
+	int result(0);
+	for(int icat = 0; icat < kNCategories; icat++) result |= fCategories[icat].fTriggerBits;
+	return result;
+}
+
+/**
+ * Get the trigger bits fired in a category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Trigger bits of all patches of the category
+ */
+int TriggerSummary::GetTriggerBits(int category) const {
+	return GetCategorySummary(category).fTriggerBits;
+}
+
+/**
+ * Get the number of patches in a category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Number of patches
+ */
+unsigned int TriggerSummary::GetNumberOfPatches(int category) const {
+	return GetCategorySummary(category).fNPatches;
+}
+
+/**
+ * Get the amplitude of the max. patch in a category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Max. patch amplitude (-1 if no patch was found)
+ */
+double TriggerSummary::GetMaxADC(int category) const {
+	return GetCategorySummary(category).fMaxADC;
+}
+
+/**
+ * Get the median patch amplitude in a category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Median amplitude (0 if no patch was found)
+ */
+double TriggerSummary::GetMedianADC(int category) const {
+	return GetCategorySummary(category).fMedianADC;
+}
+
+/**
+ * Get the max. patch of a category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Patch with the highest amplitude (default patch if no patch was found)
+ */
+RawPatch TriggerSummary::GetMaxPatch(int category) const {
+	const CategorySummary &summary = GetCategorySummary(category);
+	if(!summary.fNPatches) return RawPatch();
+	RawPatch result(summary.fMaxCol, summary.fMaxRow, summary.fMaxADC, summary.fMaxTriggerBits);
+	result.SetPatchSize(summary.fPatchSize);
+	result.SetPatchType(static_cast<RawPatch::Patchtype>(summary.fPatchType));
+	return result;
+}
+
+/**
+ * Get the summary of a category
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Summary of the category
+ * @throw TriggerMaker::InvalidCategoryException in case the category is not a gamma, jet or Level0 category
+ */
+const TriggerSummary::CategorySummary &TriggerSummary::GetCategorySummary(int category) const {
+	return fCategories[TriggerMaker::GetCategoryIndex(category)];
+}
+
+/**
+ * Get the summary of a category for modification
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Summary of the category
+ * @throw TriggerMaker::InvalidCategoryException in case the category is not a gamma, jet or Level0 category
+ */
+TriggerSummary::CategorySummary &TriggerSummary::GetCategorySummary(int category) {
+	return fCategories[TriggerMaker::GetCategoryIndex(category)];
+}
+
+/**
+ * Write the summary as binary record (native byte order)
+ * @param writer Output stream
+ */
+void TriggerSummary::Write(std::ostream &writer) const {
+	writer.write(reinterpret_cast<const char *>(fCategories), sizeof(fCategories));
+}
+
+/**
+ * Read a summary written with Write
+ * @param reader Input stream
+ * @return True if a complete record was read, false otherwise (e.g. end of file)
+ */
+bool TriggerSummary::Read(std::istream &reader) {
+	reader.read(reinterpret_cast<char *>(fCategories), sizeof(fCategories));
+	return reader.gcount() == static_cast<std::streamsize>(sizeof(fCategories));
+}
@@ -0,0 +1,73 @@
+#ifndef TRIGGERSUMMARY_H
+#define TRIGGERSUMMARY_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <iosfwd>
+#include <stdint.h>
+#include <vector>
+
+#include "TriggerAlgorithm.h"
+
+/**
+ * @class TriggerSummary
+ * @brief Event-level trigger result per patch category
+ *
+ * Holds for each patch category the trigger bits fired, the number of patches and the
+ * max. and median patch amplitude, with the position of the max. patch. Values are the
+ * same as obtained from the patch lists of the TriggerMaker (GetMaxPatch, GetMedianADC), also
+ * the max. patch among patches with the same amplitude (PackedRawPatch::GetMaxPatch), but the summary can be produced without building patch lists (TriggerMaker::FindSummary).
+ * The summary has a fixed size and is stored as plain binary record (Write, Read).
+ */
+class TriggerSummary {
+public:
+	enum {
+		kNCategories = RawPatch::kDCALpatchL0 - RawPatch::kEMCALpatchGA + 1
+	};
+
+	/**
+	 * @struct CategorySummary
+	 * @brief Summary of the patches of one category
+	 */
+	struct CategorySummary {
+		uint32_t			fNPatches;			///< Number of patches
+		uint16_t			fTriggerBits;		///< Trigger bits of all patches
+		uint16_t			fMaxTriggerBits;	///< Trigger bits of the max. patch
+		float				fMaxADC;			///< Amplitude of the max. patch (-1 if no patch)
+		uint8_t				fMaxCol;			///< Starting column of the max. patch
+		uint8_t				fMaxRow;			///< Starting row of the max. patch
+		uint8_t				fPatchSize;			///< Size of the patches
+		uint8_t				fPatchType;			///< Type of the patches (EMCAL or DCAL-PHOS)
+		double				fMedianADC;			///< Median amplitude (0 if no patch)
+
+		void Reset();
+	};
+
+	TriggerSummary();
+	virtual ~TriggerSummary() {}
+
+	void Reset();
+	void Fill(int category, const std::vector<PackedRawPatch> &patches);
+
+	int GetTriggerBits() const;
+	int GetTriggerBits(int category) const;
+	unsigned int GetNumberOfPatches(int category) const;
+	double GetMaxADC(int category) const;
+	double GetMedianADC(int category) const;
+	RawPatch GetMaxPatch(int category) const;
+
+	const CategorySummary &GetCategorySummary(int category) const;
+	CategorySummary &GetCategorySummary(int category);
+
+	void Write(std::ostream &writer) const;
+	bool Read(std::istream &reader);
+
+private:
+	CategorySummary				fCategories[kNCategories];		///< Summaries per patch category
+};
+
+#endif /* TRIGGERSUMMARY_H */
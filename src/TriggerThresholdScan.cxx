@@ -0,0 +1,187 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <algorithm>
+#include <cfloat>
+
+#include "TriggerChannelMap.h"
+#include "TriggerMaker.h"
+#include "TriggerPatchMask.h"
+#include "TriggerThresholdScan.h"
+
+/**
+ * Constructor, initializing the threshold list. Thresholds are sorted in
+ * ascending order.
+ * @param thresholds List of thresholds to be evaluated
+ */
+TriggerThresholdScan::TriggerThresholdScan(const std::vector<double> &thresholds):
+	fGammaTrigger(),
+	fJetTrigger(),
+	fLevel0Trigger(),
+	fThresholds(thresholds),
+	fNEvents(0)
+{
+	std::sort(fThresholds.begin(), fThresholds.end());
+	for(int icat = 0; icat < kNCategories; icat++){
+		fNFired[icat].resize(fThresholds.size() + 1, 0);
+		fMaxADC[icat] = -DBL_MAX;
+	}
+}
+
+/**
+ * Destructor
+ */
+TriggerThresholdScan::~TriggerThresholdScan() {
+}
+
+/**
+ * Process one event: Determine the max. window amplitude for all categories
+ * and count for each threshold whether the event fired. All window positions
+ * are accepted.
+ * @param emcal Channel map of the EMCAL
+ * @param dcalphos Channel map of the DCAL-PHOS
+ */
+void TriggerThresholdScan::ProcessEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos) {
+	ScanEvent(emcal, dcalphos, NULL);
+}
+
+/**
+ * Process the event currently stored in the channel maps of the trigger maker.
+ * Windows rejected by the patch masks of the maker (PHOS acceptance, exclusion
+ * regions) are skipped, as in the patch finding of the maker.
+ * @param maker Trigger maker with filled channel maps
+ */
+void TriggerThresholdScan::ProcessEvent(const TriggerMaker &maker) {
+	ScanEvent(maker.GetEMCALChannels(), maker.GetDCALPHOSChannels(), &maker);
+}
+
+/**
+ * Reset the fire counters and the event counter. Thresholds are kept.
+ */
+void TriggerThresholdScan::Reset() {
+	for(int icat = 0; icat < kNCategories; icat++){
+		std::fill(fNFired[icat].begin(), fNFired[icat].end(), 0);
+		fMaxADC[icat] = -DBL_MAX;
+	}
+	fNEvents = 0;
+}
+
+/**
+ * Get the max. window amplitude of the last processed event
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Max. window amplitude (-DBL_MAX if no event was processed)
+ */
+double TriggerThresholdScan::GetMaxADC(int category) const {
+	return fMaxADC[GetCategoryIndex(category)];
+}
+
+/**
+ * Get the number of events in which a threshold was fired
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @param ithreshold Index of the threshold in the sorted threshold list
+ * @return Number of events with at least one window above the threshold
+ */
+unsigned long TriggerThresholdScan::GetFireCount(int category, int ithreshold) const {
+	const std::vector<unsigned long> &nfired = fNFired[GetCategoryIndex(category)];
+	if(ithreshold < 0 || ithreshold >= static_cast<int>(fThresholds.size())) return 0;
+	// Events firing the n lowest thresholds fired threshold i if n > i
+	unsigned long result(0);
+	for(size_t ifired = ithreshold + 1; ifired < nfired.size(); ifired++) result += nfired[ifired];
+	return result;
+}
+
+/**
+ * Get the number of fired events for all thresholds
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @return Fire counts, in the order of the sorted threshold list
+ */
+std::vector<unsigned long> TriggerThresholdScan::GetFireCounts(int category) const {
+	const std::vector<unsigned long> &nfired = fNFired[GetCategoryIndex(category)];
+	std::vector<unsigned long> result(fThresholds.size(), 0);
+	unsigned long cumulated(0);
+	for(size_t ithreshold = fThresholds.size(); ithreshold > 0; ithreshold--){
+		cumulated += nfired[ithreshold];
+		result[ithreshold - 1] = cumulated;
+	}
+	return result;
+}
+
+/**
+ * Get the fraction of processed events in which a threshold was fired
+ * @param category Patch category (RawPatch::kEMCALpatchGA to RawPatch::kDCALpatchL0)
+ * @param ithreshold Index of the threshold in the sorted threshold list
+ * @return Trigger efficiency (0 if no event was processed)
+ */
+double TriggerThresholdScan::GetEfficiency(int category, int ithreshold) const {
+	if(!fNEvents) return 0.;
+	return static_cast<double>(GetFireCount(category, ithreshold)) / static_cast<double>(fNEvents);
+}
+
+/**
+ * Map the patch category to the index in the internal arrays
+ * @param category Patch category
+ * @return Index of the category
+ * @throw InvalidCategoryException in case the category is not a gamma, jet or Level0 category
+ */
+int TriggerThresholdScan::GetCategoryIndex(int category) const {
+	if(category < RawPatch::kEMCALpatchGA || category > RawPatch::kDCALpatchL0)
+		throw InvalidCategoryException(category);
+	return category - RawPatch::kEMCALpatchGA;
+}
+
+/**
+ * Determine the max. window amplitude of all categories and count the event
+ * @param emcal Channel map of the EMCAL
+ * @param dcalphos Channel map of the DCAL-PHOS
+ * @param maker Trigger maker providing the patch masks (all positions accepted if NULL)
+ */
+void TriggerThresholdScan::ScanEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos, const TriggerMaker *maker) {
+	Fill(GetCategoryIndex(RawPatch::kEMCALpatchGA), 		fGammaTrigger.FindMaxPatchADC(&emcal, GetActivePatchMask(maker, RawPatch::kEMCALpatchGA)));
+	Fill(GetCategoryIndex(RawPatch::kDCALpatchGA), 			fGammaTrigger.FindMaxPatchADC(&dcalphos, GetActivePatchMask(maker, RawPatch::kDCALpatchGA)));
+	Fill(GetCategoryIndex(RawPatch::kEMCALpatchJE), 		fJetTrigger.FindMaxPatchADC(&emcal, GetActivePatchMask(maker, RawPatch::kEMCALpatchJE)));
+	Fill(GetCategoryIndex(RawPatch::kDCALpatchJE), 			fJetTrigger.FindMaxPatchADC(&dcalphos, GetActivePatchMask(maker, RawPatch::kDCALpatchJE)));
+	Fill(GetCategoryIndex(RawPatch::kEMCALpatchJE8x8), 		fJetTrigger.FindMaxPatchADC8x8(&emcal, GetActivePatchMask(maker, RawPatch::kEMCALpatchJE8x8)));
+	Fill(GetCategoryIndex(RawPatch::kDCALpatchJE8x8), 		fJetTrigger.FindMaxPatchADC8x8(&dcalphos, GetActivePatchMask(maker, RawPatch::kDCALpatchJE8x8)));
+	Fill(GetCategoryIndex(RawPatch::kEMCALpatchL0), 		fLevel0Trigger.FindMaxPatchADC(&emcal, GetActivePatchMask(maker, RawPatch::kEMCALpatchL0)));
+	Fill(GetCategoryIndex(RawPatch::kDCALpatchL0), 		fLevel0Trigger.FindMaxPatchADC(&dcalphos, GetActivePatchMask(maker, RawPatch::kDCALpatchL0)));
+	fNEvents++;
+}
+
+/**
+ * Get the patch mask of a category of the trigger maker, if it rejects any position
+ * @param maker Trigger maker (NULL if no mask is applied)
+ * @param category Patch category
+ * @return Patch mask of the maker, NULL if all positions are accepted
+ */
+const TriggerPatchMask *TriggerThresholdScan::GetActivePatchMask(const TriggerMaker *maker, int category) {
+	if(!maker) return NULL;
+	const TriggerPatchMask &mask = maker->GetPatchMask(category);
+	return mask.HasRejections() ? &mask : NULL;
+}
+
+/**
+ * Count the event for the given category. The number of fired thresholds is
+ * the number of thresholds below the max. amplitude, found via binary search.
+ * @param categoryIndex Index of the category
+ * @param maxadc Max. window amplitude of the event
+ */
+void TriggerThresholdScan::Fill(int categoryIndex, double maxadc) {
+	fMaxADC[categoryIndex] = maxadc;
+	size_t nfired = std::lower_bound(fThresholds.begin(), fThresholds.end(), maxadc) - fThresholds.begin();
+	fNFired[categoryIndex][nfired]++;
+}
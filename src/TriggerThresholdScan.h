@@ -0,0 +1,113 @@
+#ifndef TRIGGERTHRESHOLDSCAN_H
+#define TRIGGERTHRESHOLDSCAN_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "GammaTriggerAlgorithm.h"
+#include "JetTriggerAlgorithm.h"
+#include "Level0TriggerAlgorithm.h"
+
+class TriggerChannelMap;
+class TriggerMaker;
+class TriggerPatchMask;
+
+/**
+ * @class TriggerThresholdScan
+ * @brief Evaluation of many trigger thresholds on the same event in one pass
+ *
+ * Instead of running the patch finders once per threshold, the scan determines
+ * for each patch category (EMCAL/DCAL-PHOS gamma, jet, jet 8x8 and Level0) the highest
+ * window amplitude of the event once. An event fires a threshold if the max.
+ * amplitude is above the threshold, so all thresholds are evaluated with a single
+ * binary search in the sorted threshold list. Fire counts are accumulated over
+ * all processed events and can be used to build trigger efficiency (turn-on) curves.
+ *
+ * Categories are addressed with the patch types RawPatch::kEMCALpatchGA to
+ * RawPatch::kDCALpatchL0, the same selectors as in TriggerMaker::GetPatches.
+ * Events given as channel maps are scanned on the full channel maps, patches in the
+ * PHOS region are accepted. Events taken from a TriggerMaker are scanned with the patch
+ * masks of the maker (PHOS acceptance and exclusion regions), so the thresholds fire
+ * as for the patches found by the maker.
+ */
+class TriggerThresholdScan {
+public:
+	class InvalidCategoryException : public std::exception{
+	public:
+		InvalidCategoryException(int category):
+			exception(),
+			fMessage(""),
+			fCategory(category)
+		{
+			std::stringstream msgstream;
+			msgstream << "Invalid patch category for threshold scan: " << fCategory;
+			fMessage = msgstream.str();
+		}
+		virtual ~InvalidCategoryException() throw() {}
+
+		int GetCategory() const throw() { return fCategory; }
+
+		const char *what() const throw(){
+			return fMessage.c_str();
+		}
+	private:
+		std::string 			fMessage;			///< Error message
+		int						fCategory;			///< Requested category
+	};
+
+	TriggerThresholdScan(const std::vector<double> &thresholds);
+	virtual ~TriggerThresholdScan();
+
+	void ProcessEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos);
+	void ProcessEvent(const TriggerMaker &maker);
+	void Reset();
+
+	/**
+	 * Get the thresholds of the scan, sorted in ascending order. Threshold indices
+	 * used in the getters refer to this list.
+	 * @return Sorted list of thresholds
+	 */
+	const std::vector<double> &GetThresholds() const { return fThresholds; }
+
+	/**
+	 * Get the number of events processed since construction or the last reset
+	 * @return Number of processed events
+	 */
+	unsigned long GetNumberOfEvents() const { return fNEvents; }
+
+	double GetMaxADC(int category) const;
+	unsigned long GetFireCount(int category, int ithreshold) const;
+	std::vector<unsigned long> GetFireCounts(int category) const;
+	double GetEfficiency(int category, int ithreshold) const;
+
+private:
+	enum {
+		kNCategories = RawPatch::kDCALpatchL0 - RawPatch::kEMCALpatchGA + 1
+	};
+
+	int GetCategoryIndex(int category) const;
+	void ScanEvent(const TriggerChannelMap &emcal, const TriggerChannelMap &dcalphos, const TriggerMaker *maker);
+	void Fill(int categoryIndex, double maxadc);
+	static const TriggerPatchMask *GetActivePatchMask(const TriggerMaker *maker, int category);
+
+	TriggerThresholdScan(const TriggerThresholdScan &);
+	TriggerThresholdScan &operator=(const TriggerThresholdScan &);
+
+	GammaTriggerAlgorithm			fGammaTrigger;						///< Gamma algorithm providing the max. 2x2 amplitude
+	JetTriggerAlgorithm				fJetTrigger;						///< Jet algorithm providing the max. 16x16 and 8x8 amplitude
+	Level0TriggerAlgorithm			fLevel0Trigger;						///< Level0 algorithm providing the max. 2x2 amplitude within a TRU
+	std::vector<double>				fThresholds;						///< Thresholds, sorted in ascending order
+	std::vector<unsigned long>		fNFired[kNCategories];				///< Number of events firing exactly the n lowest thresholds
+	double							fMaxADC[kNCategories];				///< Max. amplitude per category in the last event
+	unsigned long					fNEvents;							///< Number of processed events
+};
+
+#endif /* TRIGGERTHRESHOLDSCAN_H */
@@ -0,0 +1,63 @@
+/********************************************************************************
+ *  Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL       *
+ *  Detector system                                                             *
+ *  Copyright (C) 2015  Markus Fasel, ALICE Collaboration                       *
+ *                                                                              *
+ *  This program is free software: you can redistribute it and/or modify        *
+ *  it under the terms of the GNU General Public License as published by        *
+ *  the Free Software Foundation, either version 3 of the License, or           *
+ *  (at your option) any later version.                                         *
+ *                                                                              *
+ *  This program is distributed in the hope that it will be useful,	            *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of              *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the               *
+ *  GNU General Public License for more details.                                *
+ *                                                                              *
+ *  You should have received a copy of the GNU General Public License           *
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ ********************************************************************************/
+#include <cfloat>
+
+#include "TriggerThresholdTable.h"
+
+/**
+ * Constructor, creating an empty table
+ */
+TriggerThresholdTable::TriggerThresholdTable():
+	fThresholds(),
+	fBits(),
+	fCumulativeBits(1, 0)
+{
+}
+
+/**
+ * Insert a threshold into the table, keeping the thresholds sorted, and update
+ * the cumulative trigger bit masks
+ * @param threshold Threshold in ADC counts
+ * @param bit Trigger bit set if the threshold is fired
+ */
+void TriggerThresholdTable::AddThreshold(double threshold, int bit) {
+	int position = std::upper_bound(fThresholds.begin(), fThresholds.end(), threshold) - fThresholds.begin();
+	fThresholds.insert(fThresholds.begin() + position, threshold);
+	fBits.insert(fBits.begin() + position, bit);
+	fCumulativeBits.resize(fThresholds.size() + 1);
+	for(size_t ithresh = position; ithresh < fThresholds.size(); ithresh++)
+		fCumulativeBits[ithresh + 1] = fCumulativeBits[ithresh] | (1 << fBits[ithresh]);
+}
+
+/**
+ * Remove all thresholds from the table
+ */
+void TriggerThresholdTable::Clear() {
+	fThresholds.clear();
+	fBits.clear();
+	fCumulativeBits.assign(1, 0);
+}
+
+/**
+ * Get the lowest threshold in the table
+ * @return Lowest threshold (DBL_MAX if the table is empty)
+ */
+double TriggerThresholdTable::GetMinThreshold() const {
+	return fThresholds.empty() ? DBL_MAX : fThresholds.front();
+}
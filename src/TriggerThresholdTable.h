@@ -0,0 +1,63 @@
+#ifndef TRIGGERTHRESHOLDTABLE_H
+#define TRIGGERTHRESHOLDTABLE_H
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version. (See cxx source for full Copyright notice)
+ */
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * @class TriggerThresholdTable
+ * @brief Sorted thresholds of one patch category with cumulative trigger bit masks
+ *
+ * The thresholds are kept in ascending order, and for each number n of thresholds
+ * fired the table stores the trigger bits of the n lowest thresholds. The trigger
+ * bits of a patch amplitude are then obtained with a single binary search,
+ * independent of the number of thresholds. As for the single thresholds a patch
+ * fires a threshold if the amplitude is above (not equal to) it.
+ */
+class TriggerThresholdTable {
+public:
+	TriggerThresholdTable();
+	/**
+	 * Destructor
+	 */
+	virtual ~TriggerThresholdTable() {}
+
+	void AddThreshold(double threshold, int bit);
+	void Clear();
+
+	/**
+	 * Get the trigger bits of all thresholds fired by a patch amplitude
+	 * @param adc Patch amplitude
+	 * @return Trigger bits of the thresholds below the amplitude
+	 */
+	int GetTriggerBits(double adc) const {
+		return fCumulativeBits[std::lower_bound(fThresholds.begin(), fThresholds.end(), adc) - fThresholds.begin()];
+	}
+
+	/**
+	 * Get the number of thresholds in the table
+	 * @return Number of thresholds
+	 */
+	int GetNumberOfThresholds() const { return fThresholds.size(); }
+
+	/**
+	 * Check whether the table has no threshold (nothing can fire)
+	 * @return True if the table is empty
+	 */
+	bool IsEmpty() const { return fThresholds.empty(); }
+
+	double GetMinThreshold() const;
+
+private:
+	std::vector<double>			fThresholds;			///< Thresholds, in ascending order
+	std::vector<int>			fBits;					///< Trigger bit of each threshold
+	std::vector<int>			fCumulativeBits;		///< Trigger bits of the n lowest thresholds, for n = 0 to the number of thresholds
+};
+
+#endif /* TRIGGERTHRESHOLDTABLE_H */
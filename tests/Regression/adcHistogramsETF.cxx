@@ -0,0 +1,224 @@
+#include "TriggerADCHistograms.h"
+#include "TriggerChannelMap.h"
+#include "TriggerEventGenerator.h"
+#include "TriggerKernels.h"
+#include "TriggerMaker.h"
+#include "TriggerRandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Test of the amplitude histograms (TriggerADCHistograms) against a naive fill, which
+// computes the amplitude of every position of every grid from single channels
+// (TriggerChannelMap::GetADC) and its bin with scalar code.
+//
+// Usage: adcHistogramsETF [nevents] [seed]
+//
+// Events of the event generator, in the row-major and the tiled channel map layout, are
+// mixed with adversarial events: amplitudes exactly at bin edges, below and above the
+// range, infinite and NaN amplitudes. Histograms filled in two halves and merged have
+// to be identical to the histograms filled in one go. The vector kernels are selected
+// as in the library (environment variable ETF_KERNEL_ISA). Entries of the naive fill
+// within rounding of a bin edge may be in the neighbouring bin, since the summation
+// order of subregions and jet windows differs.
+
+namespace {
+
+const int kNBins = 60;
+const double kMin = -2., kMax = 58.;
+const double kEdgeTolerance = 1e-9;			// relative, rounding of sums in different order
+
+/**
+ * Naive histograms of one grid, with the number of entries close to a bin edge per position
+ */
+struct NaiveGrid {
+	int fNCols;
+	int fNRows;
+	int fWindowSize;						// window size in channels (1 for channels)
+	int fStep;								// distance between window positions in channels
+	std::vector<uint32_t> fCounts;			// position-major (row, col, bin)
+	std::vector<uint32_t> fNearEdge;		// per position
+};
+
+int GetNaiveBin(double value, bool &nearedge) {
+	double position = (value - kMin) * (kNBins / (kMax - kMin));
+	nearedge = std::fabs(position - std::floor(position + 0.5)) <= kEdgeTolerance * std::max(1., std::fabs(position));
+	double bin = std::floor(position);
+	if(!(bin > -1.)) bin = -1.;
+	if(!(bin < kNBins)) bin = kNBins;
+	return static_cast<int>(bin) + 1;
+}
+
+void InitNaiveGrid(NaiveGrid &grid, const TriggerADCHistograms &histograms, TriggerADCHistograms::GridType type, bool isDCALPHOS) {
+	const int windowsizes[TriggerADCHistograms::kNGridTypes] = {1, 2, 4, 8, 16}, steps[TriggerADCHistograms::kNGridTypes] = {1, 1, 4, 4, 4};
+	grid.fNCols = histograms.GetNumberOfCols(type, isDCALPHOS);
+	grid.fNRows = histograms.GetNumberOfRows(type, isDCALPHOS);
+	grid.fWindowSize = windowsizes[type];
+	grid.fStep = steps[type];
+	grid.fCounts.assign(grid.fNCols * grid.fNRows * (kNBins + 2), 0);
+	grid.fNearEdge.assign(grid.fNCols * grid.fNRows, 0);
+}
+
+void FillNaiveGrid(NaiveGrid &grid, const TriggerChannelMap &channels) {
+	for(int row = 0; row < grid.fNRows; row++){
+		for(int col = 0; col < grid.fNCols; col++){
+			double adcsum(0);
+			for(int jrow = 0; jrow < grid.fWindowSize; jrow++)
+				for(int jcol = 0; jcol < grid.fWindowSize; jcol++)
+					adcsum += channels.GetADC(col * grid.fStep + jcol, row * grid.fStep + jrow);
+			bool nearedge(false);
+			int bin = GetNaiveBin(adcsum, nearedge);
+			grid.fCounts[(row * grid.fNCols + col) * (kNBins + 2) + bin]++;
+			if(nearedge) grid.fNearEdge[row * grid.fNCols + col]++;
+		}
+	}
+}
+
+/**
+ * Compare the histograms of a grid with the naive histograms
+ * @return Number of positions with differences beyond the entries close to a bin edge
+ */
+int CompareGrid(const NaiveGrid &grid, const TriggerADCHistograms &histograms, TriggerADCHistograms::GridType type, bool isDCALPHOS, const std::string &context) {
+	int nmismatches(0);
+	if(histograms.GetNumberOfCols(type, isDCALPHOS) != grid.fNCols || histograms.GetNumberOfRows(type, isDCALPHOS) != grid.fNRows) return 1;
+	for(int row = 0; row < grid.fNRows; row++){
+		for(int col = 0; col < grid.fNCols; col++){
+			const uint32_t *counts = histograms.GetHistogram(type, isDCALPHOS, col, row), *naive = &grid.fCounts[(row * grid.fNCols + col) * (kNBins + 2)];
+			uint32_t ndiff(0), nentries(0), nnaive(0);
+			for(int bin = 0; bin < kNBins + 2; bin++){
+				ndiff += counts[bin] > naive[bin] ? counts[bin] - naive[bin] : naive[bin] - counts[bin];
+				nentries += counts[bin];
+				nnaive += naive[bin];
+			}
+			if(nentries == nnaive && ndiff <= 2 * grid.fNearEdge[row * grid.fNCols + col]) continue;
+			if(++nmismatches <= 5)
+				std::cout << "[e] Mismatch in " << context << " grid " << type << (isDCALPHOS ? " DCAL-PHOS" : " EMCAL") << " col " << col << " row " << row
+						<< ": entries " << nentries << " vs " << nnaive << ", differences " << ndiff << std::endl;
+		}
+	}
+	return nmismatches;
+}
+
+/**
+ * Fill the channel maps with amplitudes at bin edges, outside of the range, infinite and NaN
+ */
+void FillAdversarial(TriggerChannelMap &channels, const TriggerRandom &random, uint64_t &counter) {
+	const double specials[4] = {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(),
+			std::numeric_limits<double>::quiet_NaN(), kMax};
+	channels.Reset();
+	for(int row = 0; row < channels.GetNumberOfRows(); row++){
+		for(int col = 0; col < channels.GetNumberOfCols(); col++, counter += 2){
+			uint64_t choice = random.Integer(counter) % 100;
+			if(choice < 2) channels.SetADC(col, row, specials[random.Integer(counter + 1) % 4]);
+			else if(choice < 60) channels.SetADC(col, row, kMin + (static_cast<int>(random.Integer(counter + 1) % (kNBins + 10)) - 5) * (kMax - kMin) / kNBins);
+			else channels.SetADC(col, row, 100. * random.Uniform(counter + 1) - 20.);
+		}
+	}
+}
+
+}
+
+int main(int argc, char **argv) {
+	int nevents = argc > 1 ? atoi(argv[1]) : 200;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+	int nerrors(0);
+
+	std::cout << "[i] Vector kernels: " << TriggerKernels::GetISAName(TriggerKernels::SelectISA()) << std::endl;
+	TriggerADCHistograms histograms(kNBins, kMin, kMax), firsthalf(kNBins, kMin, kMax), secondhalf(kNBins, kMin, kMax);
+	NaiveGrid naive[TriggerADCHistograms::kNGridTypes][2];
+	for(int itype = 0; itype < TriggerADCHistograms::kNGridTypes; itype++)
+		for(int idet = 0; idet < 2; idet++)
+			InitNaiveGrid(naive[itype][idet], histograms, static_cast<TriggerADCHistograms::GridType>(itype), idet == 1);
+
+	TriggerEventGenerator generator(seed);
+	generator.SetMultiplicity(0, 1500);
+	generator.SetEnergyRange(0., 20.);
+	TriggerMaker maker;
+	TriggerRandom random(seed, 1);
+	uint64_t counter(0);
+	TriggerChannelMap emcal(48, 64), dcalphos(48, 40), emcaltiled(48, 64, TriggerChannelMap::kTiled), dcalphostiled(48, 40, TriggerChannelMap::kTiled);
+	for(int iev = 0; iev < nevents; iev++){
+		TriggerChannelMap &emcalmap = iev % 2 ? emcaltiled : emcal, &dcalphosmap = iev % 2 ? dcalphostiled : dcalphos;
+		if(iev % 5 == 4){
+			FillAdversarial(emcalmap, random, counter);
+			FillAdversarial(dcalphosmap, random, counter);
+		} else {
+			generator.FillEvent(iev, maker);
+			for(int idet = 0; idet < 2; idet++){
+				const TriggerChannelMap &source = idet ? maker.GetDCALPHOSChannels() : maker.GetEMCALChannels();
+				TriggerChannelMap &target = idet ? dcalphosmap : emcalmap;
+				target.Reset();
+				for(int row = 0; row < source.GetNumberOfRows(); row++)
+					for(int col = 0; col < source.GetNumberOfCols(); col++) target.SetADC(col, row, source.GetADC(col, row));
+			}
+		}
+		histograms.AddEvent(emcalmap, dcalphosmap);
+		(iev < nevents / 2 ? firsthalf : secondhalf).AddEvent(emcalmap, dcalphosmap);
+		for(int itype = 0; itype < TriggerADCHistograms::kNGridTypes; itype++){
+			FillNaiveGrid(naive[itype][0], emcalmap);
+			FillNaiveGrid(naive[itype][1], dcalphosmap);
+		}
+	}
+
+	// comparison with the naive fill
+	for(int itype = 0; itype < TriggerADCHistograms::kNGridTypes; itype++)
+		for(int idet = 0; idet < 2; idet++)
+			nerrors += CompareGrid(naive[itype][idet], histograms, static_cast<TriggerADCHistograms::GridType>(itype), idet == 1, "histograms");
+
+	// merged halves identical to the histograms filled at once
+	firsthalf.Merge(secondhalf);
+	if(firsthalf.GetNumberOfEvents() != histograms.GetNumberOfEvents() || histograms.GetNumberOfEvents() != static_cast<unsigned long>(nevents)){
+		std::cout << "[e] Number of events " << histograms.GetNumberOfEvents() << ", merged " << firsthalf.GetNumberOfEvents() << ", expected " << nevents << std::endl;
+		nerrors++;
+	}
+	for(int itype = 0; itype < TriggerADCHistograms::kNGridTypes; itype++){
+		for(int idet = 0; idet < 2; idet++){
+			TriggerADCHistograms::GridType type = static_cast<TriggerADCHistograms::GridType>(itype);
+			for(int row = 0; row < histograms.GetNumberOfRows(type, idet == 1); row++)
+				for(int col = 0; col < histograms.GetNumberOfCols(type, idet == 1); col++)
+					for(int bin = 0; bin < kNBins + 2; bin++)
+						if(firsthalf.GetCount(type, idet == 1, col, row, bin) != histograms.GetCount(type, idet == 1, col, row, bin)){
+							if(++nerrors <= 5) std::cout << "[e] Merged histograms differ in grid " << itype << " col " << col << " row " << row << " bin " << bin << std::endl;
+						}
+		}
+	}
+
+	// invalid binning and channel maps
+	const int badnbins[3] = {0, 10, 10};
+	const double badmax[3] = {kMax, kMin, std::numeric_limits<double>::quiet_NaN()};
+	for(int ibinning = 0; ibinning < 3; ibinning++){
+		try {
+			TriggerADCHistograms invalid(badnbins[ibinning], kMin, badmax[ibinning]);
+			std::cout << "[e] Invalid binning " << badnbins[ibinning] << " bins up to " << badmax[ibinning] << " accepted" << std::endl;
+			nerrors++;
+		} catch(TriggerADCHistograms::InvalidBinningException &) {
+		}
+	}
+	try {
+		TriggerChannelMap small(40, 40);
+		histograms.AddEvent(emcal, small);
+		std::cout << "[e] Channel map of wrong size accepted" << std::endl;
+		nerrors++;
+	} catch(TriggerADCHistograms::GridSizeMismatchException &) {
+		if(histograms.GetNumberOfEvents() != static_cast<unsigned long>(nevents) || CompareGrid(naive[TriggerADCHistograms::kChannels][0], histograms, TriggerADCHistograms::kChannels, false, "rejected event")){
+			std::cout << "[e] Histograms modified by a rejected event" << std::endl;
+			nerrors++;
+		}
+	}
+	try {
+		TriggerADCHistograms other(kNBins + 1, kMin, kMax);
+		histograms.Merge(other);
+		std::cout << "[e] Merge with different binning accepted" << std::endl;
+		nerrors++;
+	} catch(TriggerADCHistograms::BinningMismatchException &) {
+	}
+
+	std::cout << "[i] Errors: " << nerrors << std::endl;
+	return nerrors ? 1 : 0;
+}
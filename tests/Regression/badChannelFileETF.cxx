@@ -0,0 +1,260 @@
+#include "TriggerBadChannelContainer.h"
+#include "TriggerBadChannelFile.h"
+#include "TriggerMaker.h"
+#include "TriggerRandom.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Test of the bad channel files (TriggerBadChannelFile): run ranges added in any order
+// are written sorted, with identical masks stored once; empty and overlapping run ranges
+// are rejected by the writer. Runs inside, between and outside of the run ranges are
+// looked up in the reader, and LoadRun switches the bad channels of containers and of
+// a trigger maker between runs. Truncated and corrupt files are rejected in
+// TriggerBadChannelFileReader::Open with a FileIOException.
+//
+// Usage: badChannelFileETF [seed]
+
+namespace {
+
+// offsets in the file layout of TriggerBadChannelFile
+const size_t kHeaderSize = 24;
+const size_t kVersionOffset = 8;
+const size_t kByteOrderOffset = 12;
+const size_t kNRunRangesOffset = 16;
+const size_t kRunRangeSize = 16;
+const size_t kMaskSize = TriggerBadChannelContainer::kNMaskWords * sizeof(uint64_t);
+
+/**
+ * Run range with the bad channels of EMCAL and DCAL-PHOS
+ */
+struct RunRangeDefinition {
+	uint32_t fFirstRun;
+	uint32_t fLastRun;
+	int fMaskEMCAL;				// index of the bad channel set of the EMCAL
+	int fMaskDCALPHOS;			// index of the bad channel set of the DCAL-PHOS
+};
+
+uint32_t GetWord(const std::string &content, size_t offset) {
+	uint32_t value(0);
+	memcpy(&value, content.data() + offset, sizeof(value));
+	return value;
+}
+
+void SetWord(std::string &content, size_t offset, uint32_t value) {
+	memcpy(&content[offset], &value, sizeof(value));
+}
+
+std::string ReadFile(const std::string &filename) {
+	std::ifstream reader(filename.c_str(), std::ios::in | std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string &filename, const std::string &content) {
+	std::ofstream writer(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	writer.write(content.data(), content.size());
+}
+
+/**
+ * Check that adding a run range to the writer is rejected
+ * @return True if AddRunRange throws a RunRangeException and the writer is unchanged
+ */
+bool IsRangeRejected(TriggerBadChannelFileWriter &writer, uint32_t firstrun, uint32_t lastrun, const TriggerBadChannelContainer &channels, const std::string &description) {
+	size_t nranges = writer.GetNumberOfRunRanges(), nmasks = writer.GetNumberOfMasks();
+	try {
+		writer.AddRunRange(firstrun, lastrun, channels, channels);
+	} catch(TriggerBadChannelFile::RunRangeException &e) {
+		std::cout << "[i] " << description << ": " << e.what() << std::endl;
+		if(writer.GetNumberOfRunRanges() == nranges && writer.GetNumberOfMasks() == nmasks) return true;
+		std::cout << "[e] " << description << ": writer modified by a rejected run range" << std::endl;
+		return false;
+	}
+	std::cout << "[e] " << description << ": run range accepted" << std::endl;
+	return false;
+}
+
+/**
+ * Check that a file content is rejected when opened
+ * @return True if Open throws a FileIOException
+ */
+bool IsFileRejected(const std::string &filename, const std::string &content, const std::string &description) {
+	WriteFile(filename, content);
+	TriggerBadChannelFileReader reader;
+	try {
+		reader.Open(filename);
+	} catch(TriggerBadChannelFile::FileIOException &e) {
+		std::cout << "[i] " << description << ": " << e.what() << std::endl;
+		return true;
+	}
+	std::cout << "[e] " << description << ": file accepted" << std::endl;
+	return false;
+}
+
+/**
+ * Compare a bad channel container with the expected bad channels at all positions
+ * @return Number of differing positions
+ */
+int CompareChannels(const TriggerBadChannelContainer &channels, const TriggerBadChannelContainer &expected, int ncols, int nrows) {
+	int ndiff(0);
+	for(int row = 0; row < nrows; row++)
+		for(int col = 0; col < ncols; col++)
+			if(channels.HasChannel(col, row) != expected.HasChannel(col, row)) ndiff++;
+	return ndiff;
+}
+
+}
+
+int main(int argc, char **argv) {
+	uint64_t seed = argc > 1 ? strtoull(argv[1], NULL, 10) : 1;
+	const std::string filename = "badChannelFileETF.bin", corruptname = "badChannelFileETF_corrupt.bin";
+	int nerrors(0);
+
+	// three distinct bad channel sets, the first one empty
+	const int kNSets = 3;
+	TriggerBadChannelContainer sets[kNSets];
+	TriggerRandom random(seed, 4);
+	uint64_t counter(0);
+	for(int iset = 1; iset < kNSets; iset++)
+		for(int ichannel = 0; ichannel < 20 * iset; ichannel++, counter += 2)
+			sets[iset].AddChannel(random.Integer(counter) % 48, random.Integer(counter + 1) % 64);
+
+	// run ranges added out of order, with gaps between 120 and 199 and between 301 and 399
+	const RunRangeDefinition ranges[4] = {{200, 300, 1, 2}, {100, 119, 0, 1}, {400, 400, 2, 2}, {301, 301, 1, 2}};
+	const RunRangeDefinition sorted[4] = {ranges[1], ranges[0], ranges[3], ranges[2]};
+	TriggerBadChannelFileWriter writer;
+	for(int irange = 0; irange < 4; irange++)
+		writer.AddRunRange(ranges[irange].fFirstRun, ranges[irange].fLastRun, sets[ranges[irange].fMaskEMCAL], sets[ranges[irange].fMaskDCALPHOS]);
+	if(writer.GetNumberOfRunRanges() != 4 || writer.GetNumberOfMasks() != static_cast<size_t>(kNSets)){
+		std::cout << "[e] Writer has " << writer.GetNumberOfRunRanges() << " run ranges and " << writer.GetNumberOfMasks() << " masks, expected 4 and " << kNSets << std::endl;
+		nerrors++;
+	}
+
+	// empty and overlapping run ranges
+	if(!IsRangeRejected(writer, 150, 149, sets[1], "last run before first run")) nerrors++;
+	if(!IsRangeRejected(writer, 200, 300, sets[1], "identical run range")) nerrors++;
+	if(!IsRangeRejected(writer, 250, 260, sets[1], "run range inside another")) nerrors++;
+	if(!IsRangeRejected(writer, 150, 210, sets[1], "run range overlapping the beginning of another")) nerrors++;
+	if(!IsRangeRejected(writer, 300, 350, sets[1], "run range overlapping the end of another")) nerrors++;
+	if(!IsRangeRejected(writer, 0, 1000, sets[1], "run range containing others")) nerrors++;
+	if(!IsRangeRejected(writer, 400, 400, sets[1], "single run range added twice")) nerrors++;
+	writer.Write(filename);
+
+	// file size: distinct masks stored once
+	const std::string content = ReadFile(filename);
+	if(content.size() != kHeaderSize + 4 * kRunRangeSize + kNSets * kMaskSize){
+		std::cout << "[e] File size " << content.size() << ", expected " << kHeaderSize + 4 * kRunRangeSize + kNSets * kMaskSize << std::endl;
+		nerrors++;
+	}
+
+	TriggerBadChannelFileReader reader;
+	reader.Open(filename);
+	if(reader.GetNumberOfRunRanges() != 4){
+		std::cout << "[e] Number of run ranges " << reader.GetNumberOfRunRanges() << ", expected 4" << std::endl;
+		nerrors++;
+	}
+	for(uint32_t irange = 0; irange < reader.GetNumberOfRunRanges() && irange < 4; irange++){
+		uint32_t firstrun(0), lastrun(0);
+		reader.GetRunRange(irange, firstrun, lastrun);
+		if(firstrun != sorted[irange].fFirstRun || lastrun != sorted[irange].fLastRun){
+			std::cout << "[e] Run range " << irange << ": " << firstrun << "-" << lastrun << ", expected " << sorted[irange].fFirstRun << "-" << sorted[irange].fLastRun << std::endl;
+			nerrors++;
+		}
+	}
+	try {
+		uint32_t firstrun(0), lastrun(0);
+		reader.GetRunRange(4, firstrun, lastrun);
+		std::cout << "[e] Run range index beyond the last run range accepted" << std::endl;
+		nerrors++;
+	} catch(TriggerBadChannelFile::FileIOException &) {
+	}
+
+	// runs before, between, at the limits of and after the run ranges
+	const uint32_t runs[] = {0, 99, 100, 119, 120, 199, 200, 250, 300, 301, 302, 399, 400, 401, 0xffffffffu};
+	const int nruns = sizeof(runs) / sizeof(runs[0]);
+	TriggerBadChannelContainer emcal, dcalphos;
+	TriggerMaker maker;
+	for(int irun = 0; irun < nruns; irun++){
+		const RunRangeDefinition *expected(NULL);
+		for(int irange = 0; irange < 4; irange++)
+			if(runs[irun] >= sorted[irange].fFirstRun && runs[irun] <= sorted[irange].fLastRun) expected = sorted + irange;
+		if(reader.HasRun(runs[irun]) != (expected != NULL)){
+			std::cout << "[e] Run " << runs[irun] << (expected ? " not found" : " found") << std::endl;
+			nerrors++;
+		}
+		if(!expected){
+			try {
+				reader.LoadRun(runs[irun], emcal, dcalphos);
+				std::cout << "[e] Bad channels loaded for run " << runs[irun] << " outside of the run ranges" << std::endl;
+				nerrors++;
+			} catch(TriggerBadChannelFile::RunRangeException &) {
+			}
+			continue;
+		}
+
+		// switching between runs replaces the bad channels of the previous run
+		reader.LoadRun(runs[irun], emcal, dcalphos);
+		reader.LoadRun(runs[irun], maker);
+		int ndiff = CompareChannels(emcal, sets[expected->fMaskEMCAL], 48, 64) + CompareChannels(dcalphos, sets[expected->fMaskDCALPHOS], 48, 40)
+				+ CompareChannels(maker.GetBadChannelContainerEMCAL(), sets[expected->fMaskEMCAL], 48, 64)
+				+ CompareChannels(maker.GetBadChannelContainerDCALPHOS(), sets[expected->fMaskDCALPHOS], 48, 40);
+		if(ndiff || emcal.GetNumberOfChannels() != sets[expected->fMaskEMCAL].GetNumberOfChannels()
+				|| dcalphos.GetNumberOfChannels() != sets[expected->fMaskDCALPHOS].GetNumberOfChannels()){
+			std::cout << "[e] Bad channels of run " << runs[irun] << " differ at " << ndiff << " positions" << std::endl;
+			nerrors++;
+		}
+	}
+	reader.Close();
+	if(reader.GetNumberOfRunRanges() || reader.HasRun(200)){
+		std::cout << "[e] Run ranges available after closing the file" << std::endl;
+		nerrors++;
+	}
+
+	// truncated and corrupt files
+	const size_t rangeoffset = kHeaderSize;
+	std::string corrupt;
+	if(!IsFileRejected(corruptname, content.substr(0, kHeaderSize - 1), "short header")) nerrors++;
+	if(!IsFileRejected(corruptname, content.substr(0, content.size() - 8), "truncated mask")) nerrors++;
+	if(!IsFileRejected(corruptname, content + std::string(8, '\0'), "trailing data")) nerrors++;
+	corrupt = content;
+	corrupt[0] = 'X';
+	if(!IsFileRejected(corruptname, corrupt, "wrong magic")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, kVersionOffset, GetWord(content, kVersionOffset) + 1);
+	if(!IsFileRejected(corruptname, corrupt, "unsupported version")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, kByteOrderOffset, 0x04030201);
+	if(!IsFileRejected(corruptname, corrupt, "byte order mismatch")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, kNRunRangesOffset, 0xffffffffu);
+	if(!IsFileRejected(corruptname, corrupt, "max. number of run ranges")) nerrors++;
+
+	// run range table: empty range, overlapping and unsorted ranges, mask index out of range
+	corrupt = content;
+	SetWord(corrupt, rangeoffset + 4, sorted[0].fFirstRun - 1);
+	if(!IsFileRejected(corruptname, corrupt, "empty run range")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, rangeoffset + kRunRangeSize, sorted[0].fLastRun);
+	if(!IsFileRejected(corruptname, corrupt, "overlapping run ranges")) nerrors++;
+	corrupt = content;
+	corrupt.replace(rangeoffset, kRunRangeSize, content, rangeoffset + kRunRangeSize, kRunRangeSize);
+	corrupt.replace(rangeoffset + kRunRangeSize, kRunRangeSize, content, rangeoffset, kRunRangeSize);
+	if(!IsFileRejected(corruptname, corrupt, "unsorted run ranges")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, rangeoffset + 8, kNSets);
+	if(!IsFileRejected(corruptname, corrupt, "EMCAL mask index out of range")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, rangeoffset + 3 * kRunRangeSize + 12, kNSets);
+	if(!IsFileRejected(corruptname, corrupt, "DCAL-PHOS mask index out of range")) nerrors++;
+
+	std::remove(filename.c_str());
+	std::remove(corruptname.c_str());
+	std::cout << "[i] Errors: " << nerrors << std::endl;
+	return nerrors ? 1 : 0;
+}
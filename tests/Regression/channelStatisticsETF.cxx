@@ -0,0 +1,166 @@
+#include "TriggerBadChannelContainer.h"
+#include "TriggerChannelMap.h"
+#include "TriggerChannelStatistics.h"
+#include "TriggerMaker.h"
+#include "TriggerRandom.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Test of the channel statistics (TriggerChannelStatistics): in events with a uniform
+// background a noisy channel (high occupancy) and a channel with high mean amplitude are
+// injected per detector, and FindHotChannels has to return exactly these channels.
+//
+// Usage: channelStatisticsETF [nevents] [seed]
+//
+// Statistics of the events split into several parts and merged have to agree with the
+// statistics filled in one go, and AddHotChannels has to mark exactly the injected
+// channels as bad channels in the trigger maker.
+
+namespace {
+
+const int kNParts = 3;
+const double kTolerance = 1e-12;				// relative, sums added in different order
+
+/**
+ * Channels injected into the background of one detector
+ */
+struct InjectedChannels {
+	int fNoisyCol;
+	int fNoisyRow;
+	int fHighMeanCol;
+	int fHighMeanRow;
+};
+
+/**
+ * Fill a channel map with background: channels occupied with probability 0.1 and
+ * amplitudes between 0.5 and 2.5. The noisy channel is occupied with probability 0.9,
+ * the high-mean channel has an amplitude of 40 when occupied.
+ */
+void FillEvent(TriggerChannelMap &channels, const InjectedChannels &injected, const TriggerRandom &random, uint64_t &counter) {
+	channels.Reset();
+	for(int row = 0; row < channels.GetNumberOfRows(); row++){
+		for(int col = 0; col < channels.GetNumberOfCols(); col++, counter += 2){
+			double probability = (col == injected.fNoisyCol && row == injected.fNoisyRow) ? 0.9 : 0.1;
+			if(random.Uniform(counter) >= probability) continue;
+			double amplitude = (col == injected.fHighMeanCol && row == injected.fHighMeanRow) ? 40. : 0.5 + 2. * random.Uniform(counter + 1);
+			channels.SetADC(col, row, amplitude);
+		}
+	}
+}
+
+bool IsInjected(const InjectedChannels &injected, int col, int row) {
+	return (col == injected.fNoisyCol && row == injected.fNoisyRow) || (col == injected.fHighMeanCol && row == injected.fHighMeanRow);
+}
+
+bool IsClose(double value, double reference) {
+	return std::fabs(value - reference) <= kTolerance * std::max(1., std::fabs(reference));
+}
+
+/**
+ * Check that the hot channels of a detector are exactly the injected channels
+ * @return Number of errors
+ */
+int CheckHotChannels(const TriggerChannelStatistics &statistics, bool isDCALPHOS, const InjectedChannels &injected, const std::string &context) {
+	const char *detector = isDCALPHOS ? "DCAL-PHOS" : "EMCAL";
+	std::vector<TriggerBadChannelContainer::TriggerChannelPosition> hot = statistics.FindHotChannels(isDCALPHOS);
+	int nerrors(0), nfound(0);
+	for(std::vector<TriggerBadChannelContainer::TriggerChannelPosition>::const_iterator it = hot.begin(); it != hot.end(); ++it){
+		if(IsInjected(injected, it->GetCol(), it->GetRow())){
+			nfound++;
+		} else {
+			std::cout << "[e] " << context << ": " << detector << " channel col " << it->GetCol() << " row " << it->GetRow()
+					<< " found hot, occupancy " << statistics.GetOccupancy(isDCALPHOS, it->GetCol(), it->GetRow())
+					<< ", mean " << statistics.GetMeanADC(isDCALPHOS, it->GetCol(), it->GetRow()) << std::endl;
+			nerrors++;
+		}
+	}
+	if(nfound != 2){
+		std::cout << "[e] " << context << ": " << nfound << " of 2 injected " << detector << " channels found hot" << std::endl;
+		nerrors++;
+	}
+	return nerrors;
+}
+
+/**
+ * Compare occupancy, mean and RMS of all channels of a detector
+ * @return Number of channels with differences
+ */
+int CompareStatistics(const TriggerChannelStatistics &statistics, const TriggerChannelStatistics &reference, bool isDCALPHOS, int ncols, int nrows) {
+	int nmismatches(0);
+	for(int row = 0; row < nrows; row++){
+		for(int col = 0; col < ncols; col++){
+			if(IsClose(statistics.GetOccupancy(isDCALPHOS, col, row), reference.GetOccupancy(isDCALPHOS, col, row))
+					&& IsClose(statistics.GetMeanADC(isDCALPHOS, col, row), reference.GetMeanADC(isDCALPHOS, col, row))
+					&& IsClose(statistics.GetRMSADC(isDCALPHOS, col, row), reference.GetRMSADC(isDCALPHOS, col, row))) continue;
+			if(++nmismatches <= 5)
+				std::cout << "[e] Merged statistics differ for " << (isDCALPHOS ? "DCAL-PHOS" : "EMCAL") << " col " << col << " row " << row << std::endl;
+		}
+	}
+	return nmismatches;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int nevents = argc > 1 ? atoi(argv[1]) : 400;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+	int nerrors(0);
+
+	const InjectedChannels injectedEMCAL = {5, 7, 30, 50}, injectedDCALPHOS = {40, 3, 12, 33};
+	TriggerChannelMap emcal(48, 64), dcalphos(48, 40);
+	TriggerChannelStatistics statistics, parts[kNParts];
+	TriggerRandom random(seed, 2);
+	uint64_t counter(0);
+
+	if(!statistics.FindHotChannels(false).empty() || !statistics.FindHotChannels(true).empty()){
+		std::cout << "[e] Hot channels found without events" << std::endl;
+		nerrors++;
+	}
+
+	for(int iev = 0; iev < nevents; iev++){
+		FillEvent(emcal, injectedEMCAL, random, counter);
+		FillEvent(dcalphos, injectedDCALPHOS, random, counter);
+		statistics.AddEvent(emcal, dcalphos);
+		parts[iev * kNParts / nevents].AddEvent(emcal, dcalphos);
+	}
+
+	nerrors += CheckHotChannels(statistics, false, injectedEMCAL, "statistics");
+	nerrors += CheckHotChannels(statistics, true, injectedDCALPHOS, "statistics");
+
+	// merged parts identical to the statistics filled at once
+	for(int ipart = 1; ipart < kNParts; ipart++) parts[0].Merge(parts[ipart]);
+	if(parts[0].GetNumberOfEvents() != statistics.GetNumberOfEvents() || statistics.GetNumberOfEvents() != static_cast<unsigned long>(nevents)){
+		std::cout << "[e] Number of events " << statistics.GetNumberOfEvents() << ", merged " << parts[0].GetNumberOfEvents() << ", expected " << nevents << std::endl;
+		nerrors++;
+	}
+	nerrors += CompareStatistics(parts[0], statistics, false, emcal.GetNumberOfCols(), emcal.GetNumberOfRows());
+	nerrors += CompareStatistics(parts[0], statistics, true, dcalphos.GetNumberOfCols(), dcalphos.GetNumberOfRows());
+	nerrors += CheckHotChannels(parts[0], false, injectedEMCAL, "merged statistics");
+	nerrors += CheckHotChannels(parts[0], true, injectedDCALPHOS, "merged statistics");
+
+	// hot channels marked as bad channels in the trigger maker
+	TriggerMaker maker;
+	statistics.AddHotChannels(maker);
+	for(int idet = 0; idet < 2; idet++){
+		const TriggerChannelMap &channels = idet ? dcalphos : emcal;
+		const InjectedChannels &injected = idet ? injectedDCALPHOS : injectedEMCAL;
+		TriggerBadChannelContainer badchannels = idet ? maker.GetBadChannelContainerDCALPHOS() : maker.GetBadChannelContainerEMCAL();
+		for(int row = 0; row < channels.GetNumberOfRows(); row++){
+			for(int col = 0; col < channels.GetNumberOfCols(); col++){
+				if(badchannels.HasChannel(col, row) == IsInjected(injected, col, row)) continue;
+				std::cout << "[e] " << (idet ? "DCAL-PHOS" : "EMCAL") << " channel col " << col << " row " << row
+						<< (badchannels.HasChannel(col, row) ? " marked bad" : " not marked bad") << " in the trigger maker" << std::endl;
+				nerrors++;
+			}
+		}
+	}
+
+	std::cout << "[i] Errors: " << nerrors << std::endl;
+	return nerrors ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+#include "TriggerBadChannelContainer.h"
+#include "TriggerChannelMap.h"
+#include "TriggerDigitizer.h"
+#include "TriggerEventGenerator.h"
+#include "TriggerMaker.h"
+#include "TriggerRandom.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Test of the FastOR response emulation (TriggerDigitizer): the amplitudes are reproducible
+// for a given seed and stream and differ between streams and seeds, the amplitude of a FastOR
+// doesn't depend on the energies of the other FastORs, and bad channels are not modified.
+//
+// Usage: digitizerETF [nevents] [seed]
+//
+// Events generated with digitization switched on (TriggerEventGenerator::SetDigitize) have
+// to be identical when processed in reverse order with the same trigger maker, and the bad
+// channels of the trigger maker have to stay empty.
+
+namespace {
+
+/**
+ * Configure a digitizer with FastOR-dependent gain, pedestal and noise and energy smearing
+ */
+void Configure(TriggerDigitizer &digitizer, bool doRound) {
+	for(int row = 0; row < digitizer.GetNumberOfRows(); row++){
+		for(int col = 0; col < digitizer.GetNumberOfCols(); col++){
+			digitizer.SetGain(col, row, 0.9 + 0.005 * ((col + 3 * row) % 40));
+			digitizer.SetPedestal(col, row, (col + row) % 3);
+			digitizer.SetNoise(col, row, 0.5 + 0.1 * (row % 5));
+		}
+	}
+	digitizer.SetResolution(0.1, 0.02);
+	digitizer.SetRoundToInteger(doRound);
+}
+
+/**
+ * Fill a channel map with energies, leaving most channels empty
+ */
+void FillChannels(TriggerChannelMap &channels, const TriggerRandom &random, uint64_t &counter) {
+	channels.Reset();
+	for(int row = 0; row < channels.GetNumberOfRows(); row++){
+		for(int col = 0; col < channels.GetNumberOfCols(); col++, counter += 2){
+			if(random.Uniform(counter) >= 0.2) continue;
+			channels.SetADC(col, row, 20. * random.Uniform(counter + 1));
+		}
+	}
+}
+
+void GetAmplitudes(const TriggerChannelMap &channels, std::vector<double> &amplitudes) {
+	amplitudes.clear();
+	for(int row = 0; row < channels.GetNumberOfRows(); row++)
+		for(int col = 0; col < channels.GetNumberOfCols(); col++)
+			amplitudes.push_back(channels.GetADC(col, row));
+}
+
+void SetAmplitudes(TriggerChannelMap &channels, const std::vector<double> &amplitudes) {
+	for(int row = 0; row < channels.GetNumberOfRows(); row++)
+		for(int col = 0; col < channels.GetNumberOfCols(); col++)
+			channels.SetADC(col, row, amplitudes[row * channels.GetNumberOfCols() + col]);
+}
+
+/**
+ * Count the channels with different amplitudes
+ * @return Number of different channels
+ */
+int CountDifferences(const std::vector<double> &amplitudes, const std::vector<double> &reference) {
+	int ndifferences(0);
+	for(size_t ich = 0; ich < amplitudes.size(); ich++)
+		if(amplitudes[ich] != reference[ich]) ndifferences++;
+	return ndifferences;
+}
+
+/**
+ * Check reproducibility, stream and seed dependence, independence of the FastORs
+ * and bad channels of a single digitizer
+ * @return Number of errors
+ */
+int CheckDigitizer(const TriggerDigitizer &digitizer, const TriggerBadChannelContainer &badchannels, int nevents,
+		const TriggerRandom &random, uint64_t &counter, const std::string &context) {
+	int nerrors(0);
+	TriggerChannelMap channels(digitizer.GetNumberOfCols(), digitizer.GetNumberOfRows());
+	std::vector<double> energies, reference, amplitudes;
+	for(int iev = 0; iev < nevents; iev++){
+		FillChannels(channels, random, counter);
+		GetAmplitudes(channels, energies);
+		uint64_t seed = random.Integer(counter++);
+
+		digitizer.Digitize(channels, seed, 1, &badchannels);
+		GetAmplitudes(channels, reference);
+
+		// same seed and stream
+		SetAmplitudes(channels, energies);
+		digitizer.Digitize(channels, seed, 1, &badchannels);
+		GetAmplitudes(channels, amplitudes);
+		if(CountDifferences(amplitudes, reference)){
+			std::cout << "[e] " << context << ", event " << iev << ": " << CountDifferences(amplitudes, reference)
+					<< " channels differ for the same seed and stream" << std::endl;
+			nerrors++;
+		}
+
+		// other stream and other seed: noise on all good channels, so most channels differ
+		for(int ivariant = 0; ivariant < 2; ivariant++){
+			SetAmplitudes(channels, energies);
+			digitizer.Digitize(channels, ivariant ? seed + 1 : seed, ivariant ? 1 : 0, &badchannels);
+			GetAmplitudes(channels, amplitudes);
+			if(CountDifferences(amplitudes, reference) < static_cast<int>(amplitudes.size()) / 2){
+				std::cout << "[e] " << context << ", event " << iev << ": only " << CountDifferences(amplitudes, reference)
+						<< " channels differ for another " << (ivariant ? "seed" : "stream") << std::endl;
+				nerrors++;
+			}
+		}
+
+		// emptying or filling one FastOR changes only its amplitude
+		int changed = random.Integer(counter++) % static_cast<uint64_t>(energies.size());
+		SetAmplitudes(channels, energies);
+		channels.SetADC(changed % channels.GetNumberOfCols(), changed / channels.GetNumberOfCols(), energies[changed] != 0. ? 0. : 5.);
+		digitizer.Digitize(channels, seed, 1, &badchannels);
+		GetAmplitudes(channels, amplitudes);
+		amplitudes[changed] = reference[changed];
+		if(CountDifferences(amplitudes, reference)){
+			std::cout << "[e] " << context << ", event " << iev << ": " << CountDifferences(amplitudes, reference)
+					<< " other channels differ after changing the energy of channel " << changed << std::endl;
+			nerrors++;
+		}
+
+		// bad channels keep their content
+		for(int row = 0; row < channels.GetNumberOfRows(); row++){
+			for(int col = 0; col < channels.GetNumberOfCols(); col++){
+				int index = row * channels.GetNumberOfCols() + col;
+				if(badchannels.HasChannel(col, row) && reference[index] != energies[index]){
+					std::cout << "[e] " << context << ", event " << iev << ": bad channel col " << col << " row " << row
+							<< " modified from " << energies[index] << " to " << reference[index] << std::endl;
+					nerrors++;
+				}
+			}
+		}
+	}
+	return nerrors;
+}
+
+/**
+ * Process events digitized by the event generator in forward and reverse order with the
+ * same trigger maker and compare the channel maps. Bad channels have to stay empty.
+ * @return Number of errors
+ */
+int CheckEventOrder(int nevents, uint64_t seed) {
+	int nerrors(0);
+	TriggerMaker maker;
+	Configure(maker.GetEMCALDigitizer(), true);
+	Configure(maker.GetDCALPHOSDigitizer(), false);
+	maker.AddBadChannelEMCAL(10, 20);
+	maker.AddBadChannelEMCAL(30, 60);
+	maker.AddBadChannelDCALPHOS(5, 5);
+	maker.AddBadChannelDCALPHOS(40, 35);
+	TriggerEventGenerator generator(seed);
+	generator.SetMultiplicity(20, 60);
+	generator.SetHadronFraction(0.3);
+	generator.SetDigitize(true);
+
+	std::vector<std::vector<double> > forward(2 * nevents);
+	for(int iev = 0; iev < nevents; iev++){
+		generator.FillEvent(iev, maker);
+		GetAmplitudes(maker.GetEMCALChannels(), forward[2 * iev]);
+		GetAmplitudes(maker.GetDCALPHOSChannels(), forward[2 * iev + 1]);
+	}
+
+	std::vector<double> amplitudes;
+	for(int iev = nevents - 1; iev >= 0; iev--){
+		generator.FillEvent(iev, maker);
+		for(int idet = 0; idet < 2; idet++){
+			const TriggerChannelMap &channels = idet ? maker.GetDCALPHOSChannels() : maker.GetEMCALChannels();
+			TriggerBadChannelContainer badchannels = idet ? maker.GetBadChannelContainerDCALPHOS() : maker.GetBadChannelContainerEMCAL();
+			const char *detector = idet ? "DCAL-PHOS" : "EMCAL";
+			GetAmplitudes(channels, amplitudes);
+			if(CountDifferences(amplitudes, forward[2 * iev + idet])){
+				std::cout << "[e] Event " << iev << ": " << CountDifferences(amplitudes, forward[2 * iev + idet]) << " " << detector
+						<< " channels differ in reverse order" << std::endl;
+				nerrors++;
+			}
+			int nempty(0);
+			for(int row = 0; row < channels.GetNumberOfRows(); row++){
+				for(int col = 0; col < channels.GetNumberOfCols(); col++){
+					if(channels.GetADC(col, row) == 0.) nempty++;
+					if(badchannels.HasChannel(col, row) && channels.GetADC(col, row) != 0.){
+						std::cout << "[e] Event " << iev << ": " << detector << " bad channel col " << col << " row " << row
+								<< " has amplitude " << channels.GetADC(col, row) << std::endl;
+						nerrors++;
+					}
+				}
+			}
+			// noise on all good channels: only bad channels and channels rounded to 0 are empty
+			if(nempty > static_cast<int>(amplitudes.size()) / 2){
+				std::cout << "[e] Event " << iev << ": " << nempty << " " << detector << " channels empty after digitization" << std::endl;
+				nerrors++;
+			}
+		}
+	}
+	return nerrors;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int nevents = argc > 1 ? atoi(argv[1]) : 20;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+	int nerrors(0);
+
+	TriggerRandom random(seed, 5);
+	uint64_t counter(0);
+	TriggerBadChannelContainer badchannels;
+	badchannels.AddChannel(0, 0);
+	badchannels.AddChannel(17, 23);
+	badchannels.AddChannel(47, 39);
+	for(int iround = 0; iround < 2; iround++){
+		TriggerDigitizer digitizer(48, 40);
+		Configure(digitizer, iround == 1);
+		nerrors += CheckDigitizer(digitizer, badchannels, nevents, random, counter, iround ? "rounded" : "not rounded");
+	}
+
+	// default parameters: channel map not modified
+	TriggerDigitizer defaultdigitizer(48, 40);
+	TriggerChannelMap channels(48, 40);
+	std::vector<double> energies, amplitudes;
+	FillChannels(channels, random, counter);
+	GetAmplitudes(channels, energies);
+	defaultdigitizer.Digitize(channels, seed);
+	GetAmplitudes(channels, amplitudes);
+	if(CountDifferences(amplitudes, energies)){
+		std::cout << "[e] " << CountDifferences(amplitudes, energies) << " channels modified with the default parameters" << std::endl;
+		nerrors++;
+	}
+
+	nerrors += CheckEventOrder(nevents, seed);
+
+	std::cout << "[i] Errors: " << nerrors << std::endl;
+	return nerrors ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+#include "TriggerEventFile.h"
+#include "TriggerEventGenerator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Test of the event files (TriggerEventFile): events written with TriggerEventFileWriter
+// are read back identical with TriggerEventFileReader, and truncated or corrupt files
+// are rejected in TriggerEventFileReader::Open with a FileIOException.
+//
+// Usage: eventFileETF [nevents] [seed]
+//
+// Corrupt files are derived from a valid file: truncated or extended files, event and
+// particle counts in the header whose size computation overflows 64 bit, and event
+// indices not starting at 0, decreasing, or not ending at the number of particles.
+
+namespace {
+
+// offsets in the file layout of TriggerEventFile
+const size_t kHeaderSize = 32;
+const size_t kNEventsOffset = 16;
+const size_t kNParticlesOffset = 24;
+const size_t kParticleRecordSize = 32;
+
+uint64_t GetWord(const std::string &content, size_t offset) {
+	uint64_t value(0);
+	memcpy(&value, content.data() + offset, sizeof(value));
+	return value;
+}
+
+void SetWord(std::string &content, size_t offset, uint64_t value) {
+	memcpy(&content[offset], &value, sizeof(value));
+}
+
+std::string ReadFile(const std::string &filename) {
+	std::ifstream reader(filename.c_str(), std::ios::in | std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(reader), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::string &filename, const std::string &content) {
+	std::ofstream writer(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	writer.write(content.data(), content.size());
+}
+
+/**
+ * Check that a file content is rejected when opened
+ * @return True if Open throws a FileIOException
+ */
+bool IsRejected(const std::string &filename, const std::string &content, const std::string &description) {
+	WriteFile(filename, content);
+	TriggerEventFileReader reader;
+	try {
+		reader.Open(filename);
+	} catch(TriggerEventFile::FileIOException &e) {
+		std::cout << "[i] " << description << ": " << e.what() << std::endl;
+		return true;
+	}
+	std::cout << "[e] " << description << ": file accepted" << std::endl;
+	return false;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int nevents = argc > 1 ? atoi(argv[1]) : 50;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+	const std::string filename = "eventFileETF.etf", corruptname = "eventFileETF_corrupt.etf";
+	int nerrors(0);
+
+	// write and read back
+	TriggerEventGenerator generator(seed);
+	std::vector<TriggerEventGenerator::Particle> particles, readparticles;
+	TriggerEventFileWriter writer;
+	writer.Open(filename);
+	for(int iev = 0; iev < nevents; iev++){
+		generator.GenerateEvent(iev, particles);
+		writer.AddEvent(particles);
+	}
+	writer.AddEvent(std::vector<TriggerEventGenerator::Particle>());
+	writer.Close();
+
+	TriggerEventFileReader reader;
+	reader.Open(filename);
+	if(reader.GetNumberOfEvents() != static_cast<uint64_t>(nevents + 1)){
+		std::cout << "[e] Number of events " << reader.GetNumberOfEvents() << ", expected " << nevents + 1 << std::endl;
+		nerrors++;
+	}
+	for(int iev = 0; iev < nevents; iev++){
+		generator.GenerateEvent(iev, particles);
+		reader.GetEvent(iev, readparticles);
+		bool same = particles.size() == readparticles.size();
+		for(size_t ipart = 0; same && ipart < particles.size(); ipart++)
+			same = particles[ipart].fEta == readparticles[ipart].fEta && particles[ipart].fPhi == readparticles[ipart].fPhi
+				&& particles[ipart].fEnergy == readparticles[ipart].fEnergy && particles[ipart].fType == readparticles[ipart].fType;
+		if(!same){
+			std::cout << "[e] Event " << iev << " differs after reading" << std::endl;
+			nerrors++;
+		}
+	}
+	reader.GetEvent(nevents, readparticles);
+	if(!readparticles.empty()){
+		std::cout << "[e] Empty event has " << readparticles.size() << " particles" << std::endl;
+		nerrors++;
+	}
+	reader.Close();
+
+	// corrupt files
+	const std::string content = ReadFile(filename);
+	const uint64_t nfileevents = GetWord(content, kNEventsOffset), nparticles = GetWord(content, kNParticlesOffset);
+	const size_t indexoffset = kHeaderSize + nparticles * kParticleRecordSize;
+	std::string corrupt;
+
+	if(!IsRejected(corruptname, content.substr(0, kHeaderSize - 1), "short header")) nerrors++;
+	if(!IsRejected(corruptname, content.substr(0, content.size() - 8), "truncated index")) nerrors++;
+	if(!IsRejected(corruptname, content + std::string(8, '\0'), "trailing data")) nerrors++;
+
+	// counts for which the size computation wraps around to the size of the file
+	corrupt = content;
+	SetWord(corrupt, kNParticlesOffset, nparticles + (uint64_t(1) << 59));
+	if(!IsRejected(corruptname, corrupt, "overflowing number of particles")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, kNEventsOffset, nfileevents + (uint64_t(1) << 61));
+	if(!IsRejected(corruptname, corrupt, "overflowing number of events")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, kNEventsOffset, ~uint64_t(0));
+	if(!IsRejected(corruptname, corrupt, "max. number of events")) nerrors++;
+
+	// event index
+	corrupt = content;
+	SetWord(corrupt, indexoffset, 1);
+	if(!IsRejected(corruptname, corrupt, "index not starting at 0")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, indexoffset + nfileevents * 8, nparticles - 1);
+	if(!IsRejected(corruptname, corrupt, "index not ending at the number of particles")) nerrors++;
+	corrupt = content;
+	SetWord(corrupt, indexoffset + 8, nparticles + 1);
+	if(!IsRejected(corruptname, corrupt, "decreasing index")) nerrors++;
+
+	std::remove(filename.c_str());
+	std::remove(corruptname.c_str());
+	std::cout << "[i] Errors: " << nerrors << std::endl;
+	return nerrors ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+#include "TriggerMapping.h"
+#include "TriggerMappingEmcalGeometry.h"
+#include "TriggerMappingEmcalSimple.h"
+#include "TriggerMappingGrid.h"
+#include "TriggerRandom.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdint.h>
+#include <string>
+
+// Test of the lookup grid (TriggerMappingGrid): a grid built from the simple mapping and from
+// the mapping including the eta gaps (TriggerMappingEmcalGeometry) has to reproduce its source
+// mapping at the cell centers, also after writing it to a table and reading it back. Grids with
+// invalid number of cells or limits are rejected by Build and Load.
+//
+// Usage: mappingGridETF [npoints] [seed]
+
+namespace {
+
+const double kEtaMin = -1., kEtaMax = 1., kPhiMin = 0., kPhiMax = 6.283185307179586;
+const int kNEta = 350, kNPhi = 900;
+
+// position of the limits in the table: magic, version, byte order, number of cells in eta and phi
+const size_t kNEtaOffset = 16, kLimitsOffset = 24;
+
+bool IsSameChannel(const TriggerChannel &channel, const TriggerChannel &reference) {
+	if(!(reference.IsEMCAL() || reference.IsDCALPHOS())) return !(channel.IsEMCAL() || channel.IsDCALPHOS());
+	return channel.IsEMCAL() == reference.IsEMCAL() && channel.IsDCALPHOS() == reference.IsDCALPHOS()
+			&& channel.GetCol() == reference.GetCol() && channel.GetRow() == reference.GetRow();
+}
+
+/**
+ * Compare the grid with the source mapping at all cell centers
+ * @return Number of cells with a different channel
+ */
+int CheckCellCenters(const TriggerMappingGrid &grid, const TriggerMapping &source, const std::string &context) {
+	int nerrors(0), nmapped(0);
+	double etasize = (kEtaMax - kEtaMin) / kNEta, phisize = (kPhiMax - kPhiMin) / kNPhi;
+	for(int ieta = 0; ieta < kNEta; ieta++){
+		for(int iphi = 0; iphi < kNPhi; iphi++){
+			double eta = kEtaMin + (ieta + 0.5) * etasize, phi = kPhiMin + (iphi + 0.5) * phisize;
+			TriggerChannel reference = source.GetPositionFromEtaPhi(eta, phi), channel = grid.GetPositionFromEtaPhi(eta, phi);
+			if(reference.IsEMCAL() || reference.IsDCALPHOS()) nmapped++;
+			if(IsSameChannel(channel, reference)) continue;
+			if(++nerrors <= 5) std::cout << "[e] " << context << ": different channel at eta " << eta << " phi " << phi << std::endl;
+		}
+	}
+	// the grid covers the EMCAL and DCAL-PHOS acceptance
+	if(nmapped < kNEta * kNPhi / 10){
+		std::cout << "[e] " << context << ": only " << nmapped << " cells mapped" << std::endl;
+		nerrors++;
+	}
+	return nerrors;
+}
+
+/**
+ * Compare two grids at random positions, including positions outside of the grid
+ * @return Number of positions with a different channel
+ */
+int CheckSameGrid(const TriggerMappingGrid &grid, const TriggerMappingGrid &reference, int npoints, const TriggerRandom &random, uint64_t &counter) {
+	int nerrors(0);
+	if(grid.GetNumberOfEtaCells() != reference.GetNumberOfEtaCells() || grid.GetNumberOfPhiCells() != reference.GetNumberOfPhiCells()){
+		std::cout << "[e] Grid with " << grid.GetNumberOfEtaCells() << "x" << grid.GetNumberOfPhiCells() << " cells, expected "
+				<< reference.GetNumberOfEtaCells() << "x" << reference.GetNumberOfPhiCells() << std::endl;
+		return 1;
+	}
+	for(int ipoint = 0; ipoint < npoints; ipoint++, counter += 2){
+		double eta = kEtaMin - 0.1 + (kEtaMax - kEtaMin + 0.2) * random.Uniform(counter),
+				phi = kPhiMin - 0.1 + (kPhiMax - kPhiMin + 0.2) * random.Uniform(counter + 1);
+		TriggerChannel channel = grid.GetPositionFromEtaPhi(eta, phi), expected = reference.GetPositionFromEtaPhi(eta, phi);
+		if(IsSameChannel(channel, expected) && channel.GetColFraction() == expected.GetColFraction()
+				&& channel.GetRowFraction() == expected.GetRowFraction()) continue;
+		if(++nerrors <= 5) std::cout << "[e] Grid read back differs at eta " << eta << " phi " << phi << std::endl;
+	}
+	return nerrors;
+}
+
+/**
+ * Check that Build rejects an invalid grid and leaves the grid unchanged
+ * @return 1 if the grid was accepted or modified, 0 otherwise
+ */
+int CheckBuildRejected(TriggerMappingGrid &grid, const TriggerMapping &source, double etamin, double etamax, int neta,
+		double phimin, double phimax, int nphi) {
+	try {
+		grid.Build(source, etamin, etamax, neta, phimin, phimax, nphi);
+	} catch(TriggerMappingGrid::InvalidGridException &e) {
+		if(grid.GetNumberOfEtaCells() != kNEta || grid.GetNumberOfPhiCells() != kNPhi){
+			std::cout << "[e] Grid modified by rejected Build: " << e.what() << std::endl;
+			return 1;
+		}
+		std::cout << "[i] Rejected: " << e.what() << std::endl;
+		return 0;
+	}
+	std::cout << "[e] Build accepted " << neta << " cells in eta " << etamin << " - " << etamax
+			<< ", " << nphi << " cells in phi " << phimin << " - " << phimax << std::endl;
+	return 1;
+}
+
+/**
+ * Write a modified table and check that Load rejects it
+ * @return 1 if the table was accepted, 0 otherwise
+ */
+int CheckLoadRejected(const std::string &filename, std::string content, size_t offset, const void *value, size_t size, const std::string &description) {
+	memcpy(&content[offset], value, size);
+	std::ofstream writer(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	writer.write(content.data(), content.size());
+	writer.close();
+	TriggerMappingGrid grid;
+	try {
+		grid.Load(filename);
+	} catch(TriggerMappingGrid::TableIOException &e) {
+		std::cout << "[i] Rejected " << description << ": " << e.what() << std::endl;
+		return 0;
+	}
+	std::cout << "[e] Table with " << description << " accepted" << std::endl;
+	return 1;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int npoints = argc > 1 ? atoi(argv[1]) : 200000;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+	int nerrors(0);
+
+	const std::string filename = "mappingGridETF.bin", corruptname = "mappingGridETF_corrupt.bin";
+	TriggerMappingEmcalSimple simple;
+	TriggerMappingEmcalGeometry geometry;
+	TriggerRandom random(seed, 6);
+	uint64_t counter(0);
+
+	for(int isource = 0; isource < 2; isource++){
+		const TriggerMapping &source = isource ? static_cast<const TriggerMapping &>(geometry) : static_cast<const TriggerMapping &>(simple);
+		const char *sourcename = isource ? "geometry mapping" : "simple mapping";
+		TriggerMappingGrid grid(source, kEtaMin, kEtaMax, kNEta, kPhiMin, kPhiMax, kNPhi), readback;
+		nerrors += CheckCellCenters(grid, source, std::string("grid of the ") + sourcename);
+
+		grid.Save(filename);
+		readback.Load(filename);
+		nerrors += CheckCellCenters(readback, source, std::string("table of the ") + sourcename);
+		nerrors += CheckSameGrid(readback, grid, npoints, random, counter);
+	}
+
+	// invalid number of cells and limits
+	TriggerMappingGrid grid(simple, kEtaMin, kEtaMax, kNEta, kPhiMin, kPhiMax, kNPhi);
+	nerrors += CheckBuildRejected(grid, simple, kEtaMin, kEtaMax, 0, kPhiMin, kPhiMax, kNPhi);
+	nerrors += CheckBuildRejected(grid, simple, kEtaMin, kEtaMax, kNEta, kPhiMin, kPhiMax, -5);
+	nerrors += CheckBuildRejected(grid, simple, kEtaMin, kEtaMax, -kNEta, kPhiMin, kPhiMax, -kNPhi);
+	nerrors += CheckBuildRejected(grid, simple, kEtaMin, kEtaMax, 100000, kPhiMin, kPhiMax, kNPhi);
+	nerrors += CheckBuildRejected(grid, simple, kEtaMax, kEtaMax, kNEta, kPhiMin, kPhiMax, kNPhi);
+	nerrors += CheckBuildRejected(grid, simple, kEtaMin, kEtaMax, kNEta, kPhiMax, kPhiMin, kNPhi);
+
+	try {
+		TriggerMappingGrid empty;
+		empty.Save(corruptname);
+		std::cout << "[e] Empty grid saved" << std::endl;
+		nerrors++;
+	} catch(TriggerMappingGrid::TableIOException &e) {
+		std::cout << "[i] Rejected: " << e.what() << std::endl;
+	}
+
+	grid.Save(filename);
+	std::ifstream reader(filename.c_str(), std::ios::in | std::ios::binary);
+	std::string content((std::istreambuf_iterator<char>(reader)), std::istreambuf_iterator<char>());
+	reader.close();
+	const int32_t negativecells = -kNEta;
+	const double degenerate[4] = {kEtaMin, kEtaMin, kPhiMin, kPhiMax}, inverted[4] = {kEtaMin, kEtaMax, kPhiMax, kPhiMin};
+	nerrors += CheckLoadRejected(corruptname, content, kNEtaOffset, &negativecells, sizeof(negativecells), "negative number of cells");
+	nerrors += CheckLoadRejected(corruptname, content, kLimitsOffset, degenerate, sizeof(degenerate), "degenerate eta limits");
+	nerrors += CheckLoadRejected(corruptname, content, kLimitsOffset, inverted, sizeof(inverted), "inverted phi limits");
+
+	std::remove(filename.c_str());
+	std::remove(corruptname.c_str());
+
+	std::cout << "[i] Errors: " << nerrors << std::endl;
+	return nerrors ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+#include "TriggerChannelMap.h"
+#include "TriggerRandom.h"
+#include "TriggerRegionMap.h"
+
+#include <cfloat>
+#include <cstdlib>
+#include <iostream>
+#include <stdint.h>
+#include <vector>
+
+// Test of the region map (TriggerRegionMap) for the EMCAL and DCAL-PHOS channel maps:
+// the TRUs partition the channel map and lie inside their supermodule, IsWithinTRU
+// agrees with a brute-force scan of the TRU indices of a window and with the layout rule
+// IsWindow2x2WithinTRU, and ComputeAmplitudes agrees with sums and maxima over the
+// bounding boxes of the regions.
+//
+// Usage: regionMapETF [nevents] [seed]
+
+namespace {
+
+/**
+ * Check that TRUs and supermodules partition the channel map consistently with the lookup
+ * @return Number of errors
+ */
+int CheckPartition(const TriggerRegionMap &regions, int expectedTRUs, int expectedSupermodules) {
+	int nerrors(0);
+	if(regions.GetNumberOfTRUs() != expectedTRUs || regions.GetNumberOfSupermodules() != expectedSupermodules){
+		std::cout << "[e] " << regions.GetNumberOfTRUs() << " TRUs and " << regions.GetNumberOfSupermodules() << " supermodules, expected "
+				<< expectedTRUs << " and " << expectedSupermodules << std::endl;
+		nerrors++;
+	}
+	for(int row = 0; row < regions.GetNumberOfRows(); row++){
+		for(int col = 0; col < regions.GetNumberOfCols(); col++){
+			int ncontaining(0), itru = regions.GetTRUIndex(col, row);
+			for(int jtru = 0; jtru < regions.GetNumberOfTRUs(); jtru++)
+				if(regions.GetTRU(jtru).Contains(col, row)) ncontaining++;
+			if(ncontaining != 1 || itru < 0 || itru >= regions.GetNumberOfTRUs() || !regions.GetTRU(itru).Contains(col, row)
+					|| regions.GetSupermoduleIndex(col, row) != regions.GetSupermoduleOfTRU(itru)
+					|| !regions.GetSupermodule(regions.GetSupermoduleIndex(col, row)).Contains(col, row)){
+				if(++nerrors <= 5) std::cout << "[e] Inconsistent regions at col " << col << " row " << row << std::endl;
+			}
+		}
+	}
+	return nerrors;
+}
+
+/**
+ * Compare IsWithinTRU with the TRU indices of all positions of the window and with
+ * IsWindow2x2WithinTRU, including windows reaching outside of the channel map
+ * @return Number of errors
+ */
+int CheckWithinTRU(const TriggerRegionMap &regions) {
+	int nerrors(0);
+	const int ncols = regions.GetNumberOfCols(), nrows = regions.GetNumberOfRows();
+	for(int size = 1; size <= 16; size *= 2){
+		for(int row = -size; row < nrows + 1; row++){
+			for(int col = -size; col < ncols + 1; col++){
+				bool within = col >= 0 && row >= 0 && col + size <= ncols && row + size <= nrows;
+				for(int jrow = 0; within && jrow < size; jrow++)
+					for(int jcol = 0; within && jcol < size; jcol++)
+						within = regions.GetTRUIndex(col + jcol, row + jrow) == regions.GetTRUIndex(col, row);
+				if(regions.IsWithinTRU(col, row, size) != within){
+					if(++nerrors <= 5) std::cout << "[e] IsWithinTRU of size " << size << " at col " << col << " row " << row << " differs from the scan" << std::endl;
+				}
+				if(size == 2 && col >= 0 && row >= 0 && col < ncols - 1 && row < nrows - 1
+						&& TriggerRegionMap::IsWindow2x2WithinTRU(col, row, nrows) != within){
+					if(++nerrors <= 5) std::cout << "[e] IsWindow2x2WithinTRU at col " << col << " row " << row << " differs from the region table" << std::endl;
+				}
+			}
+		}
+	}
+	return nerrors;
+}
+
+/**
+ * Compare ComputeAmplitudes with sums and maxima over the bounding boxes
+ * @return Number of errors
+ */
+int CheckAmplitudes(const TriggerRegionMap &regions, const TriggerChannelMap &channels) {
+	int nerrors(0);
+	std::vector<double> trusum, trumax, smsum, smmax;
+	regions.ComputeAmplitudes(channels, trusum, trumax, smsum, smmax);
+	if(static_cast<int>(trusum.size()) != regions.GetNumberOfTRUs() || static_cast<int>(trumax.size()) != regions.GetNumberOfTRUs()
+			|| static_cast<int>(smsum.size()) != regions.GetNumberOfSupermodules() || static_cast<int>(smmax.size()) != regions.GetNumberOfSupermodules()){
+		std::cout << "[e] Wrong number of region amplitudes" << std::endl;
+		return 1;
+	}
+	for(int iregion = 0; iregion < regions.GetNumberOfTRUs() + regions.GetNumberOfSupermodules(); iregion++){
+		bool isTRU = iregion < regions.GetNumberOfTRUs();
+		int index = isTRU ? iregion : iregion - regions.GetNumberOfTRUs();
+		const TriggerRegionMap::Region &region = isTRU ? regions.GetTRU(index) : regions.GetSupermodule(index);
+		// sums of integer amplitudes, exact in any order
+		double sum(0), max(-DBL_MAX);
+		for(int row = region.fRowMin; row <= region.fRowMax; row++){
+			for(int col = region.fColMin; col <= region.fColMax; col++){
+				sum += channels.GetADC(col, row);
+				if(channels.GetADC(col, row) > max) max = channels.GetADC(col, row);
+			}
+		}
+		double computedsum = isTRU ? trusum[index] : smsum[index], computedmax = isTRU ? trumax[index] : smmax[index];
+		if(computedsum != sum || computedmax != max){
+			if(++nerrors <= 5)
+				std::cout << "[e] " << (isTRU ? "TRU " : "Supermodule ") << index << ": sum " << computedsum << ", max " << computedmax
+						<< ", expected " << sum << " and " << max << std::endl;
+		}
+	}
+	return nerrors;
+}
+
+/**
+ * Fill a channel map with integer amplitudes, leaving most channels and some regions empty
+ */
+void FillChannels(TriggerChannelMap &channels, const TriggerRandom &random, uint64_t &counter) {
+	int emptysector = random.Integer(counter++) % (channels.GetNumberOfRows() / TriggerRegionMap::kNRowsSector + 1);
+	channels.Reset();
+	for(int row = 0; row < channels.GetNumberOfRows(); row++){
+		for(int col = 0; col < channels.GetNumberOfCols(); col++, counter += 2){
+			if(row / TriggerRegionMap::kNRowsSector == emptysector || random.Integer(counter) % 10) continue;
+			channels.SetADC(col, row, static_cast<double>(random.Integer(counter + 1) % 200) - 20.);
+		}
+	}
+}
+
+}
+
+int main(int argc, char **argv) {
+	int nevents = argc > 1 ? atoi(argv[1]) : 50;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+	int nerrors(0);
+
+	// EMCAL: 5 full sectors with 3 TRUs per supermodule, 1 sector of small supermodules with 1 TRU;
+	// DCAL-PHOS: 3 full sectors, 1 sector of small supermodules
+	const int ncols = 48, nrows[2] = {64, 40}, expectedTRUs[2] = {32, 20}, expectedSupermodules[2] = {12, 8};
+	TriggerRandom random(seed, 3);
+	uint64_t counter(0);
+	for(int idet = 0; idet < 2; idet++){
+		TriggerRegionMap regions(ncols, nrows[idet]);
+		TriggerChannelMap channels(ncols, nrows[idet]);
+		nerrors += CheckPartition(regions, expectedTRUs[idet], expectedSupermodules[idet]);
+		nerrors += CheckWithinTRU(regions);
+		nerrors += CheckAmplitudes(regions, channels);
+		for(int iev = 0; iev < nevents; iev++){
+			FillChannels(channels, random, counter);
+			nerrors += CheckAmplitudes(regions, channels);
+		}
+	}
+
+	std::cout << "[i] Errors: " << nerrors << std::endl;
+	return nerrors ? 1 : 0;
+}
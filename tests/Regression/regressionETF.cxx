@@ -0,0 +1,675 @@
+#include "GammaTriggerAlgorithm.h"
+#include "JetTriggerAlgorithm.h"
+#include "Level0TriggerAlgorithm.h"
+#include "TriggerBatchEngine.h"
+#include "TriggerBitConfig.h"
+#include "TriggerChannelMap.h"
+#include "TriggerEventGenerator.h"
+#include "TriggerFusedScan.h"
+#include "TriggerKernels.h"
+#include "TriggerMaker.h"
+#include "TriggerRandom.h"
+#include "TriggerRegionMap.h"
+#include "TriggerSetup.h"
+#include "TriggerSubregionMap.h"
+#include "TriggerSummary.h"
+#include "TriggerThresholdScan.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Differential test of the optimized patch finders against the reference finders
+// (GammaTriggerAlgorithm::FindPatches, JetTriggerAlgorithm::FindPatches and FindPatches8x8,
+// Level0TriggerAlgorithm::FindPatches), including their loop bounds.
+//
+// Usage: regressionETF [nmaps] [seed] [nevents]
+//
+// Random and adversarial channel maps are processed by the reference finders and by
+// - the packed finders of the single algorithms (on the channel map or the subregion map)
+// - the fused scan (TriggerFusedScan), on the row-major and on the tiled channel map layout
+// - the fused scan with summary output, compared with the patch list of the fused scan
+//   including the max. patch position for equal amplitudes (PackedRawPatch::GetMaxPatch)
+// Events of the event generator are processed by the reference finders and by the
+// TriggerMaker (FindPatches and lazy evaluation per category), comparing also max. and
+// median amplitude, and the event summary (FindSummary) with the patch lists of the maker.
+// The makers are configured with random exclusion regions, PHOS acceptance and bad channels,
+// the reference patches are filtered with the same patch masks. The max. amplitudes and
+// trigger bits of the batch engine (TriggerBatchEngine, including a partially filled last
+// batch) and of the threshold scan (TriggerThresholdScan), both using the patch masks of
+// the maker, are compared with the filtered reference patches on the same events, and the
+// fire counts of the scan with the batch engine. Events of a maker with other patch masks
+// than the batch engine are rejected.
+// The vector kernels are selected as in the library (environment variable ETF_KERNEL_ISA).
+// Amplitudes have to agree within the single precision of the packed patches. Patches
+// only found by one engine, or with different trigger bits, are tolerated if the amplitude
+// is within rounding of a threshold, since the summation order of jet windows differs.
+
+namespace {
+
+const double kADCTolerance = 1e-6;				// relative, packed patches store single precision amplitudes
+const double kThresholdTolerance = 1e-9;		// relative, rounding of sums in different order
+const int kNPositions = 64 * 128;				// patch start positions (col < 64, row < 128)
+
+enum FinderType {
+	kGamma = 0,
+	kJet,
+	kJet8x8,
+	kLevel0,
+	kNFinderTypes
+};
+
+const char *kFinderNames[kNFinderTypes] = {"gamma", "jet", "jet8x8", "level0"};
+
+struct Statistics {
+	Statistics(): fNComparisons(0), fNPatches(0), fNTolerated(0), fNMismatches(0) {}
+	unsigned long fNComparisons;
+	unsigned long fNPatches;
+	unsigned long fNTolerated;
+	unsigned long fNMismatches;
+};
+
+int GetPositionKey(const RawPatch &patch) {
+	return patch.GetColStart() * 128 + patch.GetRowStart();
+}
+
+bool IsClose(double a, double b, double tolerance) {
+	return std::fabs(a - b) <= tolerance * std::max(1., std::max(std::fabs(a), std::fabs(b)));
+}
+
+bool IsNearThreshold(double adc, const std::vector<double> &thresholds) {
+	for(std::vector<double>::const_iterator thriter = thresholds.begin(); thriter != thresholds.end(); ++thriter)
+		if(IsClose(adc, *thriter, kThresholdTolerance)) return true;
+	return false;
+}
+
+double GetMedian(const std::vector<RawPatch> &patches) {
+	if(patches.empty()) return 0;
+	size_t halfsize = patches.size() / 2;
+	if(patches.size() % 2 == 0) return (patches[halfsize - 1].GetADC() + patches[halfsize].GetADC()) / 2;
+	return patches[halfsize].GetADC();
+}
+
+std::vector<double> GetThresholds(const TriggerSetup &setup, FinderType type) {
+	std::vector<double> thresholds;
+	switch(type){
+	case kGamma:
+		thresholds.push_back(setup.GetThresholdGammaHigh());
+		thresholds.push_back(setup.GetThresholdGammaLow());
+		break;
+	case kJet:
+	case kJet8x8:
+		thresholds.push_back(setup.GetThresholdJetHigh());
+		thresholds.push_back(setup.GetThresholdJetLow());
+		break;
+	case kLevel0:
+		thresholds.push_back(setup.GetThresholdL0());
+		break;
+	default:
+		break;
+	};
+	return thresholds;
+}
+
+int GetCategory(FinderType type, bool isDCALPHOS) {
+	switch(type){
+	case kGamma: return isDCALPHOS ? RawPatch::kDCALpatchGA : RawPatch::kEMCALpatchGA;
+	case kJet: return isDCALPHOS ? RawPatch::kDCALpatchJE : RawPatch::kEMCALpatchJE;
+	case kJet8x8: return isDCALPHOS ? RawPatch::kDCALpatchJE8x8 : RawPatch::kEMCALpatchJE8x8;
+	case kLevel0: return isDCALPHOS ? RawPatch::kDCALpatchL0 : RawPatch::kEMCALpatchL0;
+	default: break;
+	};
+	return RawPatch::kUndefPatch;
+}
+
+std::vector<RawPatch> ToRawPatches(const std::vector<PackedRawPatch> &patches) {
+	std::vector<RawPatch> result;
+	for(std::vector<PackedRawPatch>::const_iterator patchiter = patches.begin(); patchiter != patches.end(); ++patchiter)
+		result.push_back(patchiter->ToRawPatch());
+	return result;
+}
+
+/**
+ * Compare the patch list of an optimized engine with the reference patch list. Max. and
+ * median amplitude are compared in case the lists contain the same patches.
+ * @return True if the lists agree (within tolerances)
+ */
+bool ComparePatches(const std::vector<RawPatch> &reference, const std::vector<RawPatch> &optimized, int patchsize,
+		const std::vector<double> &thresholds, const std::string &context, Statistics &stats) {
+	stats.fNComparisons++;
+	stats.fNPatches += reference.size();
+	// lookup of the optimized patches by start position, entries are removed when matched
+	static std::vector<const RawPatch *> optimizedpatches(kNPositions, NULL);
+	for(std::vector<RawPatch>::const_iterator patchiter = optimized.begin(); patchiter != optimized.end(); ++patchiter)
+		optimizedpatches[GetPositionKey(*patchiter)] = &(*patchiter);
+
+	std::stringstream errors;
+	bool sameset(true);
+	for(std::vector<RawPatch>::const_iterator refiter = reference.begin(); refiter != reference.end(); ++refiter){
+		const RawPatch *found = optimizedpatches[GetPositionKey(*refiter)];
+		if(!found){
+			sameset = false;
+			if(IsNearThreshold(refiter->GetADC(), thresholds)) stats.fNTolerated++;
+			else errors << "  missing patch col " << int(refiter->GetColStart()) << " row " << int(refiter->GetRowStart()) << " adc " << refiter->GetADC() << std::endl;
+			continue;
+		}
+		const RawPatch &opt = *found;
+		if(!IsClose(refiter->GetADC(), opt.GetADC(), kADCTolerance))
+			errors << "  amplitude col " << int(refiter->GetColStart()) << " row " << int(refiter->GetRowStart()) << ": " << refiter->GetADC() << " vs " << opt.GetADC() << std::endl;
+		if(opt.GetPatchSize() != patchsize)
+			errors << "  patch size col " << int(refiter->GetColStart()) << " row " << int(refiter->GetRowStart()) << ": " << int(opt.GetPatchSize()) << std::endl;
+		if(refiter->GetTriggerBits() != opt.GetTriggerBits()){
+			if(IsNearThreshold(refiter->GetADC(), thresholds)) stats.fNTolerated++;
+			else errors << "  trigger bits col " << int(refiter->GetColStart()) << " row " << int(refiter->GetRowStart()) << ": " << refiter->GetTriggerBits() << " vs " << opt.GetTriggerBits() << std::endl;
+		}
+		optimizedpatches[GetPositionKey(*refiter)] = NULL;
+	}
+	for(std::vector<RawPatch>::const_iterator optiter = optimized.begin(); optiter != optimized.end(); ++optiter){
+		if(!optimizedpatches[GetPositionKey(*optiter)]) continue;
+		optimizedpatches[GetPositionKey(*optiter)] = NULL;
+		sameset = false;
+		if(IsNearThreshold(optiter->GetADC(), thresholds)) stats.fNTolerated++;
+		else errors << "  extra patch col " << int(optiter->GetColStart()) << " row " << int(optiter->GetRowStart()) << " adc " << optiter->GetADC() << std::endl;
+	}
+
+	if(sameset && !reference.empty()){
+		if(!IsClose(reference.back().GetADC(), optimized.back().GetADC(), kADCTolerance))
+			errors << "  max amplitude " << reference.back().GetADC() << " vs " << optimized.back().GetADC() << std::endl;
+		if(!IsClose(GetMedian(reference), GetMedian(optimized), kADCTolerance))
+			errors << "  median amplitude " << GetMedian(reference) << " vs " << GetMedian(optimized) << std::endl;
+	}
+
+	std::string errorstring = errors.str();
+	if(errorstring.empty()) return true;
+	stats.fNMismatches++;
+	if(stats.fNMismatches <= 10) std::cout << "[e] Mismatch in " << context << std::endl << errorstring;
+	return false;
+}
+
+/**
+ * Fill a channel map with one of the random or adversarial patterns
+ */
+void FillChannelMap(TriggerChannelMap &channels, const TriggerRandom &random, int pattern, const TriggerSetup &setup) {
+	const int ncols = channels.GetNumberOfCols(), nrows = channels.GetNumberOfRows();
+	uint64_t counter(100);
+	channels.Reset();
+	switch(pattern){
+	case 0: {
+		// sparse random hits
+		int nhits = random.Integer(1) % 200;
+		for(int ihit = 0; ihit < nhits; ihit++, counter += 3)
+			channels.AddADC(random.Integer(counter) % ncols, random.Integer(counter + 1) % nrows, 20. * random.Uniform(counter + 2));
+		break;
+	}
+	case 1:
+		// dense random amplitudes
+		for(int row = 0; row < nrows; row++)
+			for(int col = 0; col < ncols; col++)
+				channels.SetADC(col, row, 2. * random.Uniform(counter++));
+		break;
+	case 2:
+		// empty map
+		break;
+	case 3: {
+		// constant amplitude, 2x2 sums exactly at the gamma threshold
+		double amplitude = setup.GetThresholdGammaHigh() / 4.;
+		for(int row = 0; row < nrows; row++)
+			for(int col = 0; col < ncols; col++)
+				channels.SetADC(col, row, amplitude);
+		break;
+	}
+	case 4:
+		// single hot channel, mostly at the borders of the map
+		if(random.Integer(1) % 2)
+			channels.SetADC(random.Integer(2) % 2 ? ncols - 1 : 0, random.Integer(3) % nrows, 1000.);
+		else
+			channels.SetADC(random.Integer(2) % ncols, random.Integer(3) % 2 ? nrows - 1 : 0, 1000.);
+		break;
+	case 5:
+		// pedestal subtracted noise, including negative amplitudes
+		for(int row = 0; row < nrows; row++)
+			for(int col = 0; col < ncols; col++)
+				channels.SetADC(col, row, random.Gaus(counter++));
+		break;
+	case 6:
+		// hot last rows and columns, only covered by some of the finders
+		for(int row = 0; row < nrows; row++)
+			for(int col = ncols - 9; col < ncols; col++)
+				channels.SetADC(col, row, 10. * random.Uniform(counter++));
+		for(int row = nrows - 9; row < nrows; row++)
+			for(int col = 0; col < ncols; col++)
+				channels.SetADC(col, row, 10. * random.Uniform(counter++));
+		break;
+	default:
+		break;
+	};
+}
+
+/**
+ * Patch masks and bad channels applied to the trigger makers in the event test
+ */
+struct MakerConfig {
+	std::vector<TriggerRegionMap::Region> fExclusions[2];	// exclusion regions of EMCAL and DCAL-PHOS
+	std::vector<TriggerBadChannelContainer::TriggerChannelPosition> fBadChannels[2];	// bad channels of EMCAL and DCAL-PHOS
+	bool fAcceptPHOS;										// accept DCAL-PHOS patches in the PHOS region
+};
+
+/**
+ * Generate random exclusion regions (up to 2 per detector, up to 8x8 channels), bad
+ * channels (up to 40 per detector) and the PHOS acceptance
+ */
+MakerConfig MakeMakerConfig(const TriggerRandom &random) {
+	MakerConfig config;
+	uint64_t counter(0);
+	config.fAcceptPHOS = random.Integer(counter++) % 2;
+	for(int idet = 0; idet < 2; idet++){
+		const int ncols = 48, nrows = idet ? 40 : 64;
+		int nregions = random.Integer(counter++) % 3;
+		for(int iregion = 0; iregion < nregions; iregion++, counter += 4){
+			int colmin = random.Integer(counter) % ncols, rowmin = random.Integer(counter + 1) % nrows;
+			config.fExclusions[idet].push_back(TriggerRegionMap::Region(colmin, std::min(colmin + static_cast<int>(random.Integer(counter + 2) % 8), ncols - 1),
+					rowmin, std::min(rowmin + static_cast<int>(random.Integer(counter + 3) % 8), nrows - 1)));
+		}
+		int nbad = random.Integer(counter++) % 41;
+		for(int ibad = 0; ibad < nbad; ibad++, counter += 2)
+			config.fBadChannels[idet].push_back(TriggerBadChannelContainer::TriggerChannelPosition(random.Integer(counter) % ncols, random.Integer(counter + 1) % nrows));
+	}
+	return config;
+}
+
+void ConfigureMaker(TriggerMaker &maker, const MakerConfig &config) {
+	maker.SetAcceptPHOSPatches(config.fAcceptPHOS);
+	for(int idet = 0; idet < 2; idet++){
+		for(std::vector<TriggerRegionMap::Region>::const_iterator regioniter = config.fExclusions[idet].begin(); regioniter != config.fExclusions[idet].end(); ++regioniter){
+			if(idet) maker.AddExclusionRegionDCALPHOS(*regioniter);
+			else maker.AddExclusionRegionEMCAL(*regioniter);
+		}
+		for(std::vector<TriggerBadChannelContainer::TriggerChannelPosition>::const_iterator channeliter = config.fBadChannels[idet].begin(); channeliter != config.fBadChannels[idet].end(); ++channeliter){
+			if(idet) maker.AddBadChannelDCALPHOS(channeliter->GetCol(), channeliter->GetRow());
+			else maker.AddBadChannelEMCAL(channeliter->GetCol(), channeliter->GetRow());
+		}
+	}
+}
+
+/**
+ * Remove the reference patches rejected by the patch mask of the maker: windows
+ * overlapping an exclusion region, and DCAL-PHOS windows inside the PHOS region
+ * if PHOS patches are not accepted (see TriggerMaker::IsPHOSPatch)
+ */
+std::vector<RawPatch> FilterPatches(const std::vector<RawPatch> &patches, int patchsize, const MakerConfig &config, bool isDCALPHOS) {
+	std::vector<RawPatch> result;
+	const std::vector<TriggerRegionMap::Region> &exclusions = config.fExclusions[isDCALPHOS ? 1 : 0];
+	for(std::vector<RawPatch>::const_iterator patchiter = patches.begin(); patchiter != patches.end(); ++patchiter){
+		int col = patchiter->GetColStart(), row = patchiter->GetRowStart();
+		bool accepted = !(isDCALPHOS && !config.fAcceptPHOS && col >= TriggerMaker::kMinEtaPHOS && col + patchsize < TriggerMaker::kMaxEtaPHOS
+				&& row >= TriggerMaker::kMinRowPHOS && row + patchsize < TriggerMaker::kMaxRowPHOS);
+		for(std::vector<TriggerRegionMap::Region>::const_iterator regioniter = exclusions.begin(); accepted && regioniter != exclusions.end(); ++regioniter)
+			if(col <= regioniter->fColMax && col + patchsize - 1 >= regioniter->fColMin && row <= regioniter->fRowMax && row + patchsize - 1 >= regioniter->fRowMin)
+				accepted = false;
+		if(accepted) result.push_back(*patchiter);
+	}
+	return result;
+}
+
+/**
+ * Reference results of an event in the batch engine, per category (index category - RawPatch::kEMCALpatchGA)
+ */
+struct BatchReference {
+	int fEvent;												// event number
+	double fMaxADC[TriggerMaker::kNPatchCategories];		// max. amplitude of the filtered reference patches (-DBL_MAX if none)
+	int fTriggerBits[TriggerMaker::kNPatchCategories];		// trigger bits of the max. reference patch (0 if none)
+	double fScanMaxADC[TriggerMaker::kNPatchCategories];	// max. window amplitude of the threshold scan
+	std::vector<double> fThresholds[TriggerMaker::kNPatchCategories];	// thresholds of the category
+};
+
+/**
+ * Compare the batch engine results of all events in the batch with the reference finders and
+ * the threshold scan. Counts the events firing the thresholds of the scan from the batch results.
+ */
+void CompareBatch(const TriggerBatchEngine &engine, const std::vector<BatchReference> &references, int isetup, const std::vector<double> &scanthresholds,
+		std::vector<unsigned long> *firecounts, std::vector<bool> *nearthreshold, Statistics &stats) {
+	if(engine.GetNumberOfEvents() != static_cast<int>(references.size())){
+		stats.fNMismatches++;
+		std::cout << "[e] Batch of " << engine.GetNumberOfEvents() << " events, expected " << references.size() << std::endl;
+		return;
+	}
+	for(int ievent = 0; ievent < engine.GetNumberOfEvents(); ievent++){
+		const BatchReference &reference = references[ievent];
+		for(int icat = 0; icat < TriggerMaker::kNPatchCategories; icat++){
+			int category = icat + RawPatch::kEMCALpatchGA;
+			double maxadc = engine.GetMaxADC(ievent, category);
+			int triggerbits = engine.GetTriggerBits(ievent, category);
+			stats.fNComparisons++;
+			std::stringstream errors;
+			if(reference.fMaxADC[icat] > -DBL_MAX && !IsClose(maxadc, reference.fMaxADC[icat], kADCTolerance))
+				errors << "  max amplitude " << maxadc << " vs reference " << reference.fMaxADC[icat] << std::endl;
+			if(!IsClose(maxadc, reference.fScanMaxADC[icat], kADCTolerance))
+				errors << "  max amplitude " << maxadc << " vs threshold scan " << reference.fScanMaxADC[icat] << std::endl;
+			if(triggerbits != reference.fTriggerBits[icat]){
+				if(IsNearThreshold(maxadc, reference.fThresholds[icat])) stats.fNTolerated++;
+				else errors << "  trigger bits " << triggerbits << " vs reference " << reference.fTriggerBits[icat] << std::endl;
+			}
+			std::string errorstring = errors.str();
+			if(!errorstring.empty()){
+				stats.fNMismatches++;
+				if(stats.fNMismatches <= 10)
+					std::cout << "[e] Mismatch in event " << reference.fEvent << " (setup " << isetup << "), batch engine category " << category << std::endl << errorstring;
+			}
+			for(size_t ithreshold = 0; ithreshold < scanthresholds.size(); ithreshold++){
+				if(maxadc > scanthresholds[ithreshold]) firecounts[icat][ithreshold]++;
+				if(IsClose(maxadc, scanthresholds[ithreshold], kADCTolerance)) nearthreshold[icat][ithreshold] = true;
+			}
+		}
+	}
+}
+
+/**
+ * Compare the summary of a category with its patch list. The max. patch of the list is
+ * checked against the lowest start row and column among the patches with max. amplitude.
+ * @return True if summary and patch list agree
+ */
+bool CompareSummary(const TriggerSummary::CategorySummary &summary, const std::vector<PackedRawPatch> &patches, const std::string &context, Statistics &stats) {
+	stats.fNComparisons++;
+	std::stringstream errors;
+	if(summary.fNPatches != patches.size())
+		errors << "  number of patches " << summary.fNPatches << " vs " << patches.size() << std::endl;
+	if(!patches.empty()){
+		int maxcol(-1), maxrow(-1);
+		float maxadc = patches.back().GetADC();
+		for(std::vector<PackedRawPatch>::const_iterator patchiter = patches.begin(); patchiter != patches.end(); ++patchiter){
+			if(patchiter->GetADC() != maxadc) continue;
+			if(maxrow < 0 || patchiter->GetRowStart() < maxrow || (patchiter->GetRowStart() == maxrow && patchiter->GetColStart() < maxcol)){
+				maxcol = patchiter->GetColStart();
+				maxrow = patchiter->GetRowStart();
+			}
+		}
+		const PackedRawPatch &maxpatch = PackedRawPatch::GetMaxPatch(patches);
+		if(maxpatch.GetColStart() != maxcol || maxpatch.GetRowStart() != maxrow)
+			errors << "  max. patch of the list at col " << int(maxpatch.GetColStart()) << " row " << int(maxpatch.GetRowStart())
+					<< ", expected col " << maxcol << " row " << maxrow << std::endl;
+		if(summary.fMaxADC != maxadc || summary.fMaxCol != maxcol || summary.fMaxRow != maxrow || summary.fMaxTriggerBits != maxpatch.GetTriggerBits())
+			errors << "  max. patch of the summary " << summary.fMaxADC << " at col " << int(summary.fMaxCol) << " row " << int(summary.fMaxRow)
+					<< ", expected " << maxadc << " at col " << maxcol << " row " << maxrow << std::endl;
+	}
+	std::string errorstring = errors.str();
+	if(errorstring.empty()) return true;
+	stats.fNMismatches++;
+	if(stats.fNMismatches <= 10) std::cout << "[e] Mismatch in " << context << std::endl << errorstring;
+	return false;
+}
+
+TriggerSetup MakeSetup(int variant) {
+	TriggerSetup setup;
+	switch(variant){
+	case 0: setup.SetThresholds(40., 8., 20., 4.); setup.SetThresholdL0(3.); break;
+	case 1: setup.SetThresholds(0., 0., 0., 0.); setup.SetThresholdL0(0.); break;
+	case 2: setup.SetThresholds(1., 0.5, -10., -1.); setup.SetThresholdL0(-0.5); break;
+	default: setup.SetThresholds(400., 100., 200., 50.); setup.SetThresholdL0(60.); break;
+	};
+	setup.SetTriggerBitConfig(TriggerBitConfigNew());
+	return setup;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int nmaps = argc > 1 ? atoi(argv[1]) : 4000;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+	int nevents = argc > 3 ? atoi(argv[3]) : 100;
+	const int kNPatterns = 7, kNSetups = 4;
+
+	std::cout << "[i] Vector kernels: " << TriggerKernels::GetISAName(TriggerKernels::SelectISA()) << std::endl;
+	Statistics stats;
+	std::vector<PackedRawPatch> packed;
+	std::vector<PackedRawPatch> fused[kNFinderTypes];
+	TriggerSummary::CategorySummary fusedsummaries[kNFinderTypes];
+
+	// random and adversarial channel maps
+	for(int isetup = 0; isetup < kNSetups; isetup++){
+		TriggerSetup setup = MakeSetup(isetup);
+		GammaTriggerAlgorithm gamma;
+		JetTriggerAlgorithm jet;
+		Level0TriggerAlgorithm level0;
+		TriggerFusedScan fusedscan;
+		gamma.SetTriggerSetup(&setup);
+		jet.SetTriggerSetup(&setup);
+		level0.SetTriggerSetup(&setup);
+		fusedscan.SetTriggerSetup(&setup);
+		fusedscan.SetOutput(TriggerFusedScan::kGamma, &fused[kGamma]);
+		fusedscan.SetOutput(TriggerFusedScan::kJet, &fused[kJet]);
+		fusedscan.SetOutput(TriggerFusedScan::kJet8x8, &fused[kJet8x8]);
+		fusedscan.SetOutput(TriggerFusedScan::kLevel0, &fused[kLevel0]);
+		TriggerFusedScan summaryscan;
+		summaryscan.SetTriggerSetup(&setup);
+		summaryscan.SetSummaryOutput(TriggerFusedScan::kGamma, &fusedsummaries[kGamma]);
+		summaryscan.SetSummaryOutput(TriggerFusedScan::kJet, &fusedsummaries[kJet]);
+		summaryscan.SetSummaryOutput(TriggerFusedScan::kJet8x8, &fusedsummaries[kJet8x8]);
+		summaryscan.SetSummaryOutput(TriggerFusedScan::kLevel0, &fusedsummaries[kLevel0]);
+
+		for(int idet = 0; idet < 2; idet++){
+			bool isDCALPHOS = idet == 1;
+			RawPatch::Patchtype ptype = isDCALPHOS ? RawPatch::kDCALPHOSpatch : RawPatch::kEMCALpatch;
+			TriggerChannelMap channels(48, isDCALPHOS ? 40 : 64), tiledchannels(48, isDCALPHOS ? 40 : 64, TriggerChannelMap::kTiled);
+			TriggerSubregionMap subregions(48, isDCALPHOS ? 40 : 64), fusedsubregions(48, isDCALPHOS ? 40 : 64);
+			level0.SetDetector(ptype);
+
+			for(int imap = 0; imap < nmaps / (2 * kNSetups); imap++){
+				int pattern = imap % kNPatterns;
+				TriggerRandom random(seed, (static_cast<uint64_t>(isetup * 2 + idet) << 32) + imap);
+				FillChannelMap(channels, random, pattern, setup);
+				std::stringstream context;
+				context << "map " << imap << " (pattern " << pattern << ", setup " << isetup << ", " << (isDCALPHOS ? "DCAL-PHOS" : "EMCAL") << ")";
+
+				std::vector<RawPatch> reference[kNFinderTypes];
+				reference[kGamma] = gamma.FindPatches(&channels);
+				reference[kJet] = jet.FindPatches(&channels);
+				reference[kJet8x8] = jet.FindPatches8x8(&channels);
+				reference[kLevel0] = level0.FindPatches(&channels);
+				const int patchsizes[kNFinderTypes] = {2, 16, 8, 2};
+
+				// single packed finders
+				subregions.Fill(channels);
+				for(int itype = 0; itype < kNFinderTypes; itype++){
+					switch(itype){
+					case kGamma: gamma.FindPatches(&channels, packed, ptype); break;
+					case kJet: jet.FindPatches(&subregions, packed, ptype); break;
+					case kJet8x8: jet.FindPatches8x8(&subregions, packed, ptype); break;
+					case kLevel0: level0.FindPatches(&channels, NULL, packed, NULL); break;
+					};
+					ComparePatches(reference[itype], ToRawPatches(packed), patchsizes[itype], GetThresholds(setup, static_cast<FinderType>(itype)),
+							context.str() + ", packed " + kFinderNames[itype], stats);
+				}
+
+				// fused scan
+				fusedscan.Scan(channels, fusedsubregions, ptype);
+				for(int itype = 0; itype < kNFinderTypes; itype++)
+					ComparePatches(reference[itype], ToRawPatches(fused[itype]), patchsizes[itype], GetThresholds(setup, static_cast<FinderType>(itype)),
+							context.str() + ", fused " + kFinderNames[itype], stats);
+
+				// fused scan with summary output
+				summaryscan.Scan(channels, fusedsubregions, ptype);
+				for(int itype = 0; itype < kNFinderTypes; itype++)
+					CompareSummary(fusedsummaries[itype], fused[itype], context.str() + ", fused summary " + kFinderNames[itype], stats);
+
+				// fused scan on the tiled layout of the same map
+				FillChannelMap(tiledchannels, random, pattern, setup);
+				fusedscan.Scan(tiledchannels, fusedsubregions, ptype);
+				for(int itype = 0; itype < kNFinderTypes; itype++)
+					ComparePatches(reference[itype], ToRawPatches(fused[itype]), patchsizes[itype], GetThresholds(setup, static_cast<FinderType>(itype)),
+							context.str() + ", fused tiled " + kFinderNames[itype], stats);
+			}
+		}
+	}
+
+	// full events in the trigger maker, the batch engine and the threshold scan
+	std::vector<double> scanthresholds;
+	scanthresholds.push_back(-1.);
+	scanthresholds.push_back(0.);
+	scanthresholds.push_back(2.5);
+	scanthresholds.push_back(10.);
+	scanthresholds.push_back(40.);
+	scanthresholds.push_back(150.);
+	TriggerEventGenerator generator(seed);
+	generator.SetMultiplicity(0, 1500);
+	generator.SetEnergyRange(0., 20.);
+	for(int isetup = 0; isetup < kNSetups; isetup++){
+		TriggerSetup setup = MakeSetup(isetup);
+		GammaTriggerAlgorithm gamma;
+		JetTriggerAlgorithm jet;
+		Level0TriggerAlgorithm level0;
+		gamma.SetTriggerSetup(&setup);
+		jet.SetTriggerSetup(&setup);
+		level0.SetTriggerSetup(&setup);
+		TriggerMaker scanned, lazy, summarized;
+		scanned.SetTriggerSetup(setup);
+		lazy.SetTriggerSetup(setup);
+		summarized.SetTriggerSetup(setup);
+		scanned.SetLevel0Enabled(true);
+		summarized.SetLevel0Enabled(true);
+		MakerConfig config = MakeMakerConfig(TriggerRandom(seed, static_cast<uint64_t>(2 * kNSetups + isetup) << 32));
+		ConfigureMaker(scanned, config);
+		ConfigureMaker(lazy, config);
+		ConfigureMaker(summarized, config);
+		TriggerSummary summary;
+		TriggerBatchEngine engine;
+		engine.SetTriggerSetup(setup);
+		engine.SetLevel0Enabled(true);
+		engine.SetPatchMasks(scanned);
+		std::vector<BatchReference> batchreferences;
+		TriggerThresholdScan scan(scanthresholds);
+		std::vector<unsigned long> firecounts[TriggerMaker::kNPatchCategories];
+		std::vector<bool> nearthreshold[TriggerMaker::kNPatchCategories];
+		for(int icat = 0; icat < TriggerMaker::kNPatchCategories; icat++){
+			firecounts[icat].assign(scanthresholds.size(), 0);
+			nearthreshold[icat].assign(scanthresholds.size(), false);
+		}
+
+		for(int iev = 0; iev < nevents; iev++){
+			generator.FillEvent(iev, scanned);
+			generator.FillEvent(iev, lazy);
+			generator.FillEvent(iev, summarized);
+			scanned.FindPatches();
+			summarized.FindSummary(summary);
+			engine.AddEvent(scanned);
+			scan.ProcessEvent(scanned);
+			BatchReference batchreference;
+			batchreference.fEvent = iev;
+			for(int idet = 0; idet < 2; idet++){
+				bool isDCALPHOS = idet == 1;
+				const TriggerChannelMap &channels = isDCALPHOS ? scanned.GetDCALPHOSChannels() : scanned.GetEMCALChannels();
+
+				// energy deposited in bad channels is ignored
+				for(std::vector<TriggerBadChannelContainer::TriggerChannelPosition>::const_iterator channeliter = config.fBadChannels[idet].begin(); channeliter != config.fBadChannels[idet].end(); ++channeliter){
+					stats.fNComparisons++;
+					if(channels.GetADC(channeliter->GetCol(), channeliter->GetRow()) != 0.){
+						stats.fNMismatches++;
+						std::cout << "[e] Amplitude in bad channel col " << channeliter->GetCol() << " row " << channeliter->GetRow() << " in event " << iev
+								<< " (setup " << isetup << ", " << (isDCALPHOS ? "DCAL-PHOS" : "EMCAL") << ")" << std::endl;
+					}
+				}
+
+				std::vector<RawPatch> reference[kNFinderTypes];
+				reference[kGamma] = gamma.FindPatches(&channels);
+				reference[kJet] = jet.FindPatches(&channels);
+				reference[kJet8x8] = jet.FindPatches8x8(&channels);
+				reference[kLevel0] = level0.FindPatches(&channels);
+				const int patchsizes[kNFinderTypes] = {2, 16, 8, 2};
+
+				for(int itype = 0; itype < kNFinderTypes; itype++){
+					int category = GetCategory(static_cast<FinderType>(itype), isDCALPHOS), icat = category - RawPatch::kEMCALpatchGA;
+					std::vector<double> thresholds = GetThresholds(setup, static_cast<FinderType>(itype));
+
+					// the batch engine and the threshold scan apply the patch masks of the maker
+					reference[itype] = FilterPatches(reference[itype], patchsizes[itype], config, isDCALPHOS);
+					batchreference.fMaxADC[icat] = reference[itype].empty() ? -DBL_MAX : reference[itype].back().GetADC();
+					batchreference.fTriggerBits[icat] = reference[itype].empty() ? 0 : reference[itype].back().GetTriggerBits();
+					batchreference.fScanMaxADC[icat] = scan.GetMaxADC(category);
+					batchreference.fThresholds[icat] = thresholds;
+
+					std::stringstream context;
+					context << "event " << iev << " (setup " << isetup << ", " << (isDCALPHOS ? "DCAL-PHOS" : "EMCAL") << "), maker " << kFinderNames[itype];
+					ComparePatches(reference[itype], scanned.GetPatches(category), patchsizes[itype], thresholds, context.str() + " scan", stats);
+					ComparePatches(reference[itype], lazy.GetPatches(category), patchsizes[itype], thresholds, context.str() + " lazy", stats);
+
+					// event summary, built from the same single precision amplitudes as the patch lists
+					std::vector<RawPatch> optimized = scanned.GetPatches(category);
+					stats.fNComparisons++;
+					RawPatch maxpatch = scanned.GetMaxPatch(category), summarymaxpatch = summary.GetMaxPatch(category);
+					if(summary.GetNumberOfPatches(category) != optimized.size()
+							|| summary.GetMaxADC(category) != maxpatch.GetADC()
+							|| summarymaxpatch.GetColStart() != maxpatch.GetColStart() || summarymaxpatch.GetRowStart() != maxpatch.GetRowStart()
+							|| summary.GetMedianADC(category) != scanned.GetMedianADC(category)){
+						stats.fNMismatches++;
+						std::cout << "[e] Mismatch in summary of " << context.str() << std::endl;
+					}
+
+					// max. and median getters of the maker
+					if(optimized.size() != reference[itype].size() || reference[itype].empty()) continue;
+					stats.fNComparisons++;
+					if(!IsClose(scanned.GetMaxPatch(category).GetADC(), reference[itype].back().GetADC(), kADCTolerance)
+							|| !IsClose(scanned.GetMedianADC(category), GetMedian(reference[itype]), kADCTolerance)){
+						stats.fNMismatches++;
+						std::cout << "[e] Mismatch in max/median of " << context.str() << std::endl;
+					}
+				}
+			}
+
+			// batches of TriggerBatchEngine::kNLanes events, the last batch may be partially filled
+			batchreferences.push_back(batchreference);
+			if(engine.IsFull() || iev == nevents - 1){
+				engine.Process();
+				CompareBatch(engine, batchreferences, isetup, scanthresholds, firecounts, nearthreshold, stats);
+				engine.Reset();
+				batchreferences.clear();
+			}
+		}
+
+		// events of a maker with other patch masks than the batch engine
+		TriggerMaker unmasked;
+		bool hasrejections = !config.fAcceptPHOS || !config.fExclusions[0].empty() || !config.fExclusions[1].empty();
+		stats.fNComparisons++;
+		try {
+			engine.AddEvent(unmasked);
+			if(hasrejections){
+				stats.fNMismatches++;
+				std::cout << "[e] Batch engine accepted an event of a maker without patch masks (setup " << isetup << ")" << std::endl;
+			}
+		} catch(TriggerBatchEngine::PatchMaskMismatchException &) {
+			if(!hasrejections){
+				stats.fNMismatches++;
+				std::cout << "[e] Batch engine rejected an event of a maker with the same patch masks (setup " << isetup << ")" << std::endl;
+			}
+		}
+		engine.Reset();
+
+		// fire counts of the threshold scan
+		for(int icat = 0; icat < TriggerMaker::kNPatchCategories; icat++){
+			int category = icat + RawPatch::kEMCALpatchGA;
+			std::vector<unsigned long> scancounts = scan.GetFireCounts(category);
+			for(size_t ithreshold = 0; ithreshold < scanthresholds.size(); ithreshold++){
+				stats.fNComparisons++;
+				if(scancounts[ithreshold] != scan.GetFireCount(category, ithreshold)
+						|| !IsClose(scan.GetEfficiency(category, ithreshold), nevents ? static_cast<double>(scancounts[ithreshold]) / nevents : 0., kThresholdTolerance)){
+					stats.fNMismatches++;
+					std::cout << "[e] Inconsistent fire counts of the threshold scan, category " << category << ", threshold " << scanthresholds[ithreshold] << std::endl;
+				}
+				if(scancounts[ithreshold] == firecounts[icat][ithreshold]) continue;
+				if(nearthreshold[icat][ithreshold]) stats.fNTolerated++;
+				else {
+					stats.fNMismatches++;
+					std::cout << "[e] Mismatch in fire count of the threshold scan (setup " << isetup << "), category " << category << ", threshold "
+							<< scanthresholds[ithreshold] << ": " << scancounts[ithreshold] << " vs batch engine " << firecounts[icat][ithreshold] << std::endl;
+				}
+			}
+		}
+	}
+
+	std::cout << "[i] Comparisons: " << stats.fNComparisons << ", reference patches: " << stats.fNPatches
+			<< ", tolerated near threshold: " << stats.fNTolerated << ", mismatches: " << stats.fNMismatches << std::endl;
+	return stats.fNMismatches ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+#include "TriggerBadChannelContainer.h"
+#include "TriggerChannelMap.h"
+#include "TriggerRandom.h"
+#include "TriggerShowerModel.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdint.h>
+
+// Test of the shower model (TriggerShowerModel): the kernel weights sum to 1 for all impact
+// position bins, particle types and shower widths, a particle deposited away from the edges
+// keeps its energy, and energy is lost only to kernel positions outside of the channel map
+// or on bad channels, which stay empty. Even kernel sizes are rejected.
+//
+// Usage: showerModelETF [nparticles] [seed]
+
+namespace {
+
+const double kTolerance = 1e-12;				// relative, sums of weights in different order
+
+bool IsClose(double value, double reference) {
+	return std::fabs(value - reference) <= kTolerance * (std::fabs(reference) > 1. ? std::fabs(reference) : 1.);
+}
+
+/**
+ * Check that the weights of all kernels sum to 1
+ * @return Number of errors
+ */
+int CheckNormalization(const TriggerShowerModel &model) {
+	int nerrors(0), ksize = model.GetKernelSize(), nbins = model.GetNumberOfBins();
+	for(int itype = 0; itype < TriggerShowerModel::kNParticleTypes; itype++){
+		TriggerShowerModel::ParticleType type = static_cast<TriggerShowerModel::ParticleType>(itype);
+		for(int rowbin = 0; rowbin < nbins; rowbin++){
+			for(int colbin = 0; colbin < nbins; colbin++){
+				const double *kernel = model.GetKernel(type, (colbin + 0.5) / nbins, (rowbin + 0.5) / nbins);
+				double sum(0);
+				bool negative(false);
+				for(int ik = 0; ik < ksize * ksize; ik++){
+					sum += kernel[ik];
+					if(kernel[ik] < 0.) negative = true;
+				}
+				if(!IsClose(sum, 1.) || negative){
+					if(++nerrors <= 5)
+						std::cout << "[e] Kernel of size " << ksize << ", type " << itype << ", width " << model.GetShowerWidth(type)
+								<< ", bins " << colbin << "/" << rowbin << ": sum of weights " << sum << (negative ? ", negative weights" : "") << std::endl;
+				}
+			}
+		}
+	}
+	return nerrors;
+}
+
+/**
+ * Deposit a particle in an empty channel map and compare the deposited energy with the weights
+ * of the kernel positions inside the map and not on bad channels
+ * @return Number of errors
+ */
+int CheckDeposit(const TriggerShowerModel &model, TriggerChannelMap &channels, const TriggerBadChannelContainer &badchannels,
+		int col, int row, double colfraction, double rowfraction, double energy, TriggerShowerModel::ParticleType type) {
+	int nerrors(0), ksize = model.GetKernelSize(), half = ksize / 2;
+	channels.Reset();
+	model.Deposit(channels, col, row, colfraction, rowfraction, energy, type, &badchannels);
+
+	const double *kernel = model.GetKernel(type, colfraction, rowfraction);
+	double expected(0);
+	bool lossless(true);
+	for(int krow = 0; krow < ksize; krow++){
+		for(int kcol = 0; kcol < ksize; kcol++){
+			int channelcol = col + kcol - half, channelrow = row + krow - half;
+			if(channelcol < 0 || channelrow < 0 || channelcol >= channels.GetNumberOfCols() || channelrow >= channels.GetNumberOfRows()){
+				lossless = false;
+				continue;
+			}
+			if(badchannels.HasChannel(channelcol, channelrow)){
+				lossless = false;
+				continue;
+			}
+			expected += energy * kernel[krow * ksize + kcol];
+		}
+	}
+
+	double deposited(0);
+	for(int crow = 0; crow < channels.GetNumberOfRows(); crow++){
+		for(int ccol = 0; ccol < channels.GetNumberOfCols(); ccol++){
+			double adc = channels.GetADC(ccol, crow);
+			deposited += adc;
+			if(adc == 0.) continue;
+			if(badchannels.HasChannel(ccol, crow) || std::abs(ccol - col) > half || std::abs(crow - row) > half){
+				if(++nerrors <= 5)
+					std::cout << "[e] Particle at col " << col << " row " << row << ": amplitude " << adc << " at col " << ccol << " row " << crow
+							<< (badchannels.HasChannel(ccol, crow) ? " (bad channel)" : " (outside of the kernel)") << std::endl;
+			}
+		}
+	}
+	// without losses the full energy is kept
+	if(!IsClose(deposited, expected) || (lossless && !IsClose(deposited, energy))){
+		if(++nerrors <= 5)
+			std::cout << "[e] Particle at col " << col << " row " << row << ", type " << type << ": deposited " << deposited
+					<< ", expected " << expected << " of " << energy << std::endl;
+	}
+	return nerrors;
+}
+
+}
+
+int main(int argc, char **argv) {
+	int nparticles = argc > 1 ? atoi(argv[1]) : 2000;
+	uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+	int nerrors(0);
+
+	const int ksizes[2] = {3, 5}, nbins[2] = {8, 5};
+	const double widths[4] = {0., 0.25, 0.6, 1.5};
+	TriggerChannelMap channels(48, 64);
+	TriggerBadChannelContainer nobadchannels, badchannels;
+	badchannels.AddChannel(0, 0);
+	badchannels.AddChannel(20, 30);
+	badchannels.AddChannel(21, 31);
+	badchannels.AddChannel(47, 10);
+	TriggerRandom random(seed, 4);
+	uint64_t counter(0);
+
+	for(int imodel = 0; imodel < 2; imodel++){
+		TriggerShowerModel model(ksizes[imodel], nbins[imodel]);
+		nerrors += CheckNormalization(model);
+		for(int iwidth = 0; iwidth < 4; iwidth++){
+			for(int itype = 0; itype < TriggerShowerModel::kNParticleTypes; itype++)
+				model.SetShowerWidth(static_cast<TriggerShowerModel::ParticleType>(itype), widths[(iwidth + itype) % 4]);
+			nerrors += CheckNormalization(model);
+
+			// particles at all positions of the map, including the edges and the bad channels
+			for(int ipart = 0; ipart < nparticles; ipart++, counter += 5){
+				int col = random.Integer(counter) % channels.GetNumberOfCols(), row = random.Integer(counter + 1) % channels.GetNumberOfRows();
+				TriggerShowerModel::ParticleType type = static_cast<TriggerShowerModel::ParticleType>(random.Integer(counter + 2) % TriggerShowerModel::kNParticleTypes);
+				double colfraction = random.Uniform(counter + 3), rowfraction = random.Uniform(counter + 4);
+				nerrors += CheckDeposit(model, channels, ipart % 2 ? badchannels : nobadchannels, col, row, colfraction, rowfraction, 10., type);
+			}
+			// away from the edges and bad channels no energy is lost
+			nerrors += CheckDeposit(model, channels, badchannels, 10, 40, 0.3, 0.8, 7., TriggerShowerModel::kElectromagnetic);
+			nerrors += CheckDeposit(model, channels, badchannels, 30, 12, 0.9, 0.1, 7., TriggerShowerModel::kHadronic);
+		}
+	}
+
+	// kernel sizes which are not positive odd numbers
+	const int invalidsizes[3] = {4, 0, -3};
+	for(int isize = 0; isize < 3; isize++){
+		try {
+			TriggerShowerModel model(invalidsizes[isize]);
+			std::cout << "[e] Kernel size " << invalidsizes[isize] << " accepted as " << model.GetKernelSize() << std::endl;
+			nerrors++;
+		} catch(TriggerShowerModel::InvalidKernelSizeException &e) {
+			std::cout << "[i] Rejected: " << e.what() << std::endl;
+		}
+	}
+
+	std::cout << "[i] Errors: " << nerrors << std::endl;
+	return nerrors ? 1 : 0;
+}
@@ -0,0 +1,376 @@
+#include "TriggerBadChannelFile.h"
+#include "TriggerBitConfig.h"
+#include "TriggerEventFile.h"
+#include "TriggerEventGenerator.h"
+#include "TriggerMaker.h"
+#include "TriggerMappingEmcalGeometry.h"
+#include "TriggerMappingGrid.h"
+#include "TriggerRandom.h"
+#include "TriggerSetup.h"
+#include "TriggerSummary.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Multi-process runner of the trigger maker on an event file, without batch system.
+//
+// Usage:
+//   runShardedETF generate <eventfile> <nevents> [runseed]
+//       write events of the event generator to an event file (TriggerEventFile)
+//   runShardedETF run [-j nworkers] [-m mappingtable] [-b badchannels [-r run]] [-t jetHigh,gammaHigh,jetLow,gammaLow] [-l] <eventfile> <outputfile>
+//       process the event file with nworkers processes, each on a contiguous event range
+//   runShardedETF badchannels <badchannelfile> <firstrun> <lastrun> <badchannellist> [<firstrun> <lastrun> <badchannellist> ...]
+//       convert bad channel lists into a binary bad channel file (TriggerBadChannelFile)
+//   runShardedETF dump <outputfile>
+//       print the trigger summaries of an output file
+//   runShardedETF mapping <mappingtable> [netacells nphicells]
+//       precompute the mapping including the eta gaps (TriggerMappingEmcalGeometry) into a
+//       mapping table (TriggerMappingGrid) covering the acceptance of the event generator
+//
+// The trigger maker, including thresholds, bad channels and mapping table, is configured
+// once before the workers are forked, and the event file is mapped read-only before the
+// fork: the read-only tables and the input are shared between the workers (copy-on-write
+// pages and the shared file mapping) and not loaded again per worker. The progress of the
+// workers is tracked in a shared memory segment. Each worker writes the trigger summary of
+// its events (event number and TriggerSummary record) to its own file, which are merged in
+// event order after all workers have finished. The output is identical for any number of
+// workers.
+//
+// Bad channel list: one channel per line, "EMCAL col row" or "DCALPHOS col row", lines
+// starting with # are ignored. With -r the bad channels of the run are taken from a binary
+// bad channel file instead.
+
+namespace {
+
+/**
+ * Progress of one worker, in shared memory
+ */
+struct WorkerStatus {
+	uint64_t		fFirstEvent;		///< First event of the range
+	uint64_t		fNEvents;			///< Number of events in the range
+	uint64_t		fNProcessed;		///< Number of events processed so far
+	int				fError;				///< Non-zero if the worker failed
+};
+
+/**
+ * Run configuration from the command line
+ */
+struct RunConfiguration {
+	RunConfiguration():
+		fNWorkers(1),
+		fMappingTable(""),
+		fBadChannels(""),
+		fRun(-1),
+		fJetHigh(100.),
+		fGammaHigh(100.),
+		fJetLow(0.),
+		fGammaLow(0.),
+		fLevel0(false)
+	{}
+	int				fNWorkers;			///< Number of worker processes
+	std::string		fMappingTable;		///< Mapping table (TriggerMappingGrid), empty for simple mapping
+	std::string		fBadChannels;		///< Bad channel list, empty for no bad channels
+	long			fRun;				///< Run in the binary bad channel file, -1 for a bad channel list
+	double			fJetHigh;			///< Jet high threshold
+	double			fGammaHigh;			///< Gamma high threshold
+	double			fJetLow;			///< Jet low threshold
+	double			fGammaLow;			///< Gamma low threshold
+	bool			fLevel0;			///< Evaluate also the Level0 trigger
+};
+
+void PrintUsage() {
+	std::cerr << "Usage:" << std::endl
+			<< "  runShardedETF generate <eventfile> <nevents> [runseed]" << std::endl
+			<< "  runShardedETF run [-j nworkers] [-m mappingtable] [-b badchannels [-r run]] [-t jetHigh,gammaHigh,jetLow,gammaLow] [-l] <eventfile> <outputfile>" << std::endl
+			<< "  runShardedETF badchannels <badchannelfile> <firstrun> <lastrun> <badchannellist> [<firstrun> <lastrun> <badchannellist> ...]" << std::endl
+			<< "  runShardedETF dump <outputfile>" << std::endl
+			<< "  runShardedETF mapping <mappingtable> [netacells nphicells]" << std::endl;
+}
+
+std::string GetWorkerFilename(const std::string &outputfile, int worker) {
+	std::stringstream filename;
+	filename << outputfile << ".worker" << worker;
+	return filename.str();
+}
+
+void ReadBadChannels(const std::string &filename, TriggerBadChannelContainer &emcal, TriggerBadChannelContainer &dcalphos) {
+	std::ifstream reader(filename.c_str());
+	if(!reader.good()) throw std::runtime_error("Cannot open bad channel list " + filename);
+	std::string line;
+	while(std::getline(reader, line)){
+		if(line.empty() || line[0] == '#') continue;
+		std::stringstream tokens(line);
+		std::string detector;
+		int col(-1), row(-1);
+		tokens >> detector >> col >> row;
+		if(tokens.fail()) throw std::runtime_error("Invalid line in bad channel list: " + line);
+		if(detector == "EMCAL") emcal.AddChannel(col, row);
+		else if(detector == "DCALPHOS") dcalphos.AddChannel(col, row);
+		else throw std::runtime_error("Unknown detector in bad channel list: " + detector);
+	}
+}
+
+int Generate(int argc, char **argv) {
+	if(argc < 4){
+		PrintUsage();
+		return 1;
+	}
+	uint64_t nevents = strtoull(argv[3], NULL, 10), runseed = argc > 4 ? strtoull(argv[4], NULL, 10) : 42;
+	TriggerEventGenerator generator(runseed);
+	TriggerEventFileWriter writer;
+	writer.Open(argv[2]);
+	std::vector<TriggerEventGenerator::Particle> particles;
+	for(uint64_t iev = 0; iev < nevents; iev++){
+		generator.GenerateEvent(iev, particles);
+		writer.AddEvent(particles);
+	}
+	writer.Close();
+	std::cout << "[i] Written " << nevents << " events to " << argv[2] << std::endl;
+	return 0;
+}
+
+int ConvertBadChannels(int argc, char **argv) {
+	if(argc < 6 || (argc - 3) % 3){
+		PrintUsage();
+		return 1;
+	}
+	TriggerBadChannelFileWriter writer;
+	for(int iarg = 3; iarg < argc; iarg += 3){
+		TriggerBadChannelContainer emcal, dcalphos;
+		ReadBadChannels(argv[iarg + 2], emcal, dcalphos);
+		writer.AddRunRange(strtoul(argv[iarg], NULL, 10), strtoul(argv[iarg + 1], NULL, 10), emcal, dcalphos);
+	}
+	writer.Write(argv[2]);
+	std::cout << "[i] Written " << writer.GetNumberOfRunRanges() << " run ranges (" << writer.GetNumberOfMasks() << " masks) to " << argv[2] << std::endl;
+	return 0;
+}
+
+int CreateMappingTable(int argc, char **argv) {
+	if(argc != 3 && argc != 5){
+		PrintUsage();
+		return 1;
+	}
+	int neta = argc > 3 ? atoi(argv[3]) : 700, nphi = argc > 3 ? atoi(argv[4]) : 2200;
+	// default eta and phi range of the event generator
+	TriggerMappingGrid grid(TriggerMappingEmcalGeometry(), -1., 1., neta, 0., TriggerRandom::kTwoPi, nphi);
+	grid.Save(argv[2]);
+	std::cout << "[i] Written mapping table with " << neta << "x" << nphi << " cells to " << argv[2] << std::endl;
+	return 0;
+}
+
+/**
+ * Process the event range of a worker, writing event number and summary per event
+ * @return 0 on success, 1 otherwise
+ */
+int RunWorker(const TriggerEventFileReader &events, TriggerMaker &maker, const std::string &filename, WorkerStatus &status) {
+	try {
+		std::ofstream writer(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if(!writer.good()) throw std::runtime_error("Cannot open " + filename);
+		TriggerSummary summary;
+		for(uint64_t iev = status.fFirstEvent; iev < status.fFirstEvent + status.fNEvents; iev++){
+			events.FillEvent(iev, maker);
+			maker.FindSummary(summary);
+			writer.write(reinterpret_cast<const char *>(&iev), sizeof(iev));
+			summary.Write(writer);
+			status.fNProcessed++;
+		}
+		writer.close();
+		if(writer.fail()) throw std::runtime_error("Write error in " + filename);
+	} catch(std::exception &e) {
+		std::cerr << "[e] Worker " << getpid() << ": " << e.what() << std::endl;
+		status.fError = 1;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * Append the worker outputs to the merged output, checking that events come in order
+ * @return Number of events merged, or -1 in case the outputs are not in event order
+ */
+long MergeOutputs(const std::string &outputfile, int nworkers) {
+	std::ofstream writer(outputfile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!writer.good()) throw std::runtime_error("Cannot open " + outputfile);
+	long nmerged(0);
+	uint64_t eventnumber(0);
+	TriggerSummary summary;
+	for(int iworker = 0; iworker < nworkers; iworker++){
+		std::string workerfile = GetWorkerFilename(outputfile, iworker);
+		std::ifstream reader(workerfile.c_str(), std::ios::in | std::ios::binary);
+		while(reader.read(reinterpret_cast<char *>(&eventnumber), sizeof(eventnumber)) && summary.Read(reader)){
+			if(eventnumber != static_cast<uint64_t>(nmerged)) return -1;
+			writer.write(reinterpret_cast<const char *>(&eventnumber), sizeof(eventnumber));
+			summary.Write(writer);
+			nmerged++;
+		}
+		reader.close();
+		unlink(workerfile.c_str());
+	}
+	writer.close();
+	if(writer.fail()) throw std::runtime_error("Write error in " + outputfile);
+	return nmerged;
+}
+
+int Run(int argc, char **argv) {
+	RunConfiguration config;
+	int option;
+	optind = 2;
+	while((option = getopt(argc, argv, "j:m:b:r:t:l")) != -1){
+		switch(option){
+		case 'j': config.fNWorkers = atoi(optarg); break;
+		case 'm': config.fMappingTable = optarg; break;
+		case 'b': config.fBadChannels = optarg; break;
+		case 'r': config.fRun = strtol(optarg, NULL, 10); break;
+		case 't':
+			if(sscanf(optarg, "%lf,%lf,%lf,%lf", &config.fJetHigh, &config.fGammaHigh, &config.fJetLow, &config.fGammaLow) != 4){
+				PrintUsage();
+				return 1;
+			}
+			break;
+		case 'l': config.fLevel0 = true; break;
+		default:
+			PrintUsage();
+			return 1;
+		};
+	}
+	if(argc - optind != 2 || config.fNWorkers < 1 || (config.fRun >= 0 && !config.fBadChannels.length())){
+		PrintUsage();
+		return 1;
+	}
+	std::string eventfile = argv[optind], outputfile = argv[optind + 1];
+
+	// read-only configuration and input, shared by all workers after the fork
+	TriggerEventFileReader events;
+	events.Open(eventfile);
+	TriggerSetup setup;
+	setup.SetThresholds(config.fJetHigh, config.fGammaHigh, config.fJetLow, config.fGammaLow);
+	setup.SetTriggerBitConfig(TriggerBitConfigNew());
+	TriggerMaker maker;
+	maker.SetTriggerSetup(setup);
+	maker.SetLevel0Enabled(config.fLevel0);
+	TriggerMappingGrid mapping;
+	if(config.fMappingTable.length()){
+		mapping.Load(config.fMappingTable);
+		maker.SetTriggerChannelMapping(&mapping);
+	}
+	if(config.fBadChannels.length() && config.fRun >= 0){
+		TriggerBadChannelFileReader badchannels;
+		badchannels.Open(config.fBadChannels);
+		badchannels.LoadRun(config.fRun, maker);
+	} else if(config.fBadChannels.length()){
+		TriggerBadChannelContainer emcal, dcalphos;
+		ReadBadChannels(config.fBadChannels, emcal, dcalphos);
+		maker.SetBadChannelMaskEMCAL(emcal.GetMask());
+		maker.SetBadChannelMaskDCALPHOS(dcalphos.GetMask());
+	}
+
+	// contiguous event ranges, worker outputs are concatenated in worker order
+	uint64_t nevents = events.GetNumberOfEvents();
+	int nworkers = config.fNWorkers;
+	void *shared = mmap(NULL, nworkers * sizeof(WorkerStatus), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(shared == MAP_FAILED) throw std::runtime_error(std::string("Cannot create shared memory segment: ") + strerror(errno));
+	WorkerStatus *status = static_cast<WorkerStatus *>(shared);
+	for(int iworker = 0; iworker < nworkers; iworker++){
+		status[iworker].fFirstEvent = nevents * iworker / nworkers;
+		status[iworker].fNEvents = nevents * (iworker + 1) / nworkers - status[iworker].fFirstEvent;
+		status[iworker].fNProcessed = 0;
+		status[iworker].fError = 0;
+	}
+
+	std::cout << "[i] Processing " << nevents << " events of " << eventfile << " with " << nworkers << " workers, vector kernels "
+			<< TriggerKernels::GetISAName(maker.GetKernelISA()) << std::endl;
+	std::cout.flush();
+	std::vector<pid_t> workers(nworkers, -1);
+	for(int iworker = 0; iworker < nworkers; iworker++){
+		pid_t pid = fork();
+		if(pid == 0) _exit(RunWorker(events, maker, GetWorkerFilename(outputfile, iworker), status[iworker]));
+		if(pid < 0){
+			std::cerr << "[e] Cannot start worker " << iworker << ": " << strerror(errno) << std::endl;
+			status[iworker].fError = 1;
+		}
+		workers[iworker] = pid;
+	}
+
+	bool success(true);
+	for(int iworker = 0; iworker < nworkers; iworker++){
+		if(workers[iworker] < 0){
+			success = false;
+			continue;
+		}
+		int exitstatus(0);
+		waitpid(workers[iworker], &exitstatus, 0);
+		const WorkerStatus &worker = status[iworker];
+		if(!WIFEXITED(exitstatus) || WEXITSTATUS(exitstatus) || worker.fError || worker.fNProcessed != worker.fNEvents){
+			std::cerr << "[e] Worker " << iworker << " failed after " << worker.fNProcessed << " of " << worker.fNEvents << " events" << std::endl;
+			success = false;
+		}
+	}
+	munmap(shared, nworkers * sizeof(WorkerStatus));
+
+	long nmerged = success ? MergeOutputs(outputfile, nworkers) : 0;
+	if(!success || nmerged != static_cast<long>(nevents)){
+		if(success) std::cerr << "[e] Worker outputs incomplete or not in event order" << std::endl;
+		for(int iworker = 0; iworker < nworkers; iworker++) unlink(GetWorkerFilename(outputfile, iworker).c_str());
+		return 1;
+	}
+	std::cout << "[i] Merged " << nmerged << " events into " << outputfile << std::endl;
+	return 0;
+}
+
+int Dump(int argc, char **argv) {
+	if(argc < 3){
+		PrintUsage();
+		return 1;
+	}
+	std::ifstream reader(argv[2], std::ios::in | std::ios::binary);
+	if(!reader.good()) throw std::runtime_error(std::string("Cannot open ") + argv[2]);
+	const char *categorynames[TriggerSummary::kNCategories] = {"EGA", "EJE", "EJE8x8", "DGA", "DJE", "DJE8x8", "EL0", "DL0"};
+	uint64_t eventnumber(0);
+	TriggerSummary summary;
+	std::cout.setf(std::ios_base::fixed, std::ios_base::floatfield);
+	std::cout.precision(2);
+	while(reader.read(reinterpret_cast<char *>(&eventnumber), sizeof(eventnumber)) && summary.Read(reader)){
+		std::cout << "[i] Event " << eventnumber << " trigger bits " << summary.GetTriggerBits() << std::endl;
+		for(int icat = 0; icat < TriggerSummary::kNCategories; icat++){
+			int category = RawPatch::kEMCALpatchGA + icat;
+			if(!summary.GetNumberOfPatches(category)) continue;
+			std::cout << "    " << categorynames[icat] << ": patches " << summary.GetNumberOfPatches(category)
+					<< ", max " << summary.GetMaxADC(category) << ", median " << summary.GetMedianADC(category) << std::endl;
+		}
+	}
+	return 0;
+}
+
+}
+
+int main(int argc, char **argv) {
+	if(argc < 2){
+		PrintUsage();
+		return 1;
+	}
+	std::string command = argv[1];
+	try {
+		if(command == "generate") return Generate(argc, argv);
+		if(command == "run") return Run(argc, argv);
+		if(command == "dump") return Dump(argc, argv);
+		if(command == "badchannels") return ConvertBadChannels(argc, argv);
+		if(command == "mapping") return CreateMappingTable(argc, argv);
+	} catch(std::exception &e) {
+		std::cerr << "[e] " << e.what() << std::endl;
+		return 1;
+	}
+	PrintUsage();
+	return 1;
+}
@@ -0,0 +1,76 @@
+# Fast simulation tool for the trigger response of the ALICE EMCAL-DCAL
+# Detector system
+# Copyright (C) 2015  Markus Fasel, ALICE Collaboration
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Smoke test of runShardedETF, run with cmake -DRUNNER=<runShardedETF> -DWORKDIR=<dir> -P
+# - generate an event file, process it with 1 and with 4 workers and require identical outputs
+# - bad channels from a list and from the binary bad channel file give identical outputs
+# - with a mapping table, outputs with 1 and 3 workers are identical and differ from the simple mapping
+# - dump the output, run with Level0 and custom thresholds
+# - a file which is not an event file or mapping table is rejected
+
+function(run_step)
+    execute_process(COMMAND ${RUNNER} ${ARGN} WORKING_DIRECTORY ${WORKDIR} RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "runShardedETF ${ARGN} failed (${result}):\n${output}")
+    endif()
+    set(STEP_OUTPUT "${output}" PARENT_SCOPE)
+endfunction()
+
+function(compare_outputs first second)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORKDIR}/${first} ${WORKDIR}/${second} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "outputs ${first} and ${second} differ")
+    endif()
+endfunction()
+
+file(MAKE_DIRECTORY ${WORKDIR})
+
+run_step(generate events.etf 200 7)
+run_step(run -j 1 events.etf output_j1.etr)
+run_step(run -j 4 events.etf output_j4.etr)
+compare_outputs(output_j1.etr output_j4.etr)
+
+file(WRITE ${WORKDIR}/badchannels.txt "# smoke test\nEMCAL 3 4\nEMCAL 20 33\nDCALPHOS 10 12\n")
+run_step(badchannels badchannels.bin 100 200 badchannels.txt)
+run_step(run -j 2 -b badchannels.txt events.etf output_badlist.etr)
+run_step(run -j 3 -b badchannels.bin -r 150 events.etf output_badfile.etr)
+compare_outputs(output_badlist.etr output_badfile.etr)
+
+run_step(mapping mapping.etm 350 1100)
+run_step(run -j 1 -m mapping.etm events.etf output_mapping_j1.etr)
+run_step(run -j 3 -m mapping.etm events.etf output_mapping_j3.etr)
+compare_outputs(output_mapping_j1.etr output_mapping_j3.etr)
+execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${WORKDIR}/output_j1.etr ${WORKDIR}/output_mapping_j1.etr RESULT_VARIABLE result)
+if(result EQUAL 0)
+    message(FATAL_ERROR "mapping table not used, output identical to the simple mapping")
+endif()
+
+run_step(dump output_j4.etr)
+if(NOT STEP_OUTPUT MATCHES "Event 199 ")
+    message(FATAL_ERROR "dump misses the last event:\n${STEP_OUTPUT}")
+endif()
+run_step(run -j 3 -l -t 50,5,20,2 events.etf output_level0.etr)
+
+file(WRITE ${WORKDIR}/invalid.etf "not an event file")
+execute_process(COMMAND ${RUNNER} run -m invalid.etf events.etf output_invalid.etr WORKING_DIRECTORY ${WORKDIR} RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+if(result EQUAL 0)
+    message(FATAL_ERROR "runShardedETF accepted an invalid mapping table")
+endif()
+execute_process(COMMAND ${RUNNER} run invalid.etf output_invalid.etr WORKING_DIRECTORY ${WORKDIR} RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+if(result EQUAL 0)
+    message(FATAL_ERROR "runShardedETF accepted an invalid event file")
+endif()